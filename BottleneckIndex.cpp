@@ -0,0 +1,161 @@
+#include "BottleneckIndex.h"
+#include "NetworkCalculator.h"
+#include <algorithm>
+#include <numeric>
+
+using namespace std;
+
+void BottleneckIndex::build(const Graph &graph, const PipelineNetwork &network)
+{
+    static const MemoryTracker::ScratchTag scratchTag("BottleneckIndex::build");
+    MemoryTracker::ScratchScope scratch(scratchTag);
+
+    flat.build(graph, network);
+    int n = flat.getNodeCount();
+
+    // Трубы по убыванию пропускной способности (трубы в ремонте не проводят газ)
+    ScratchVector<int> pipeArcs;
+    for (int a = 0; a < flat.getArcCount(); a++)
+    {
+        if (flat.arc(a).forward && flat.arc(a).capacity > NetworkCalculator::FLOW_EPSILON)
+            pipeArcs.push_back(a);
+    }
+    stable_sort(pipeArcs.begin(), pipeArcs.end(), [this](int a, int b)
+                { return flat.arc(a).capacity > flat.arc(b).capacity; });
+
+    // Краскал: система непересекающихся множеств со сжатием путей
+    ScratchVector<int> component(n);
+    iota(component.begin(), component.end(), 0);
+    auto find = [&component](int v)
+    {
+        while (component[v] != v)
+        {
+            component[v] = component[component[v]];
+            v = component[v];
+        }
+        return v;
+    };
+
+    // Ребра леса в виде списков смежности (CSR)
+    ScratchVector<int> treeArcs;
+    for (int a : pipeArcs)
+    {
+        int u = find(flat.arc(a).tail);
+        int v = find(flat.arc(a).head);
+        if (u != v)
+        {
+            component[u] = v;
+            treeArcs.push_back(a);
+        }
+    }
+
+    ScratchVector<int> start(n + 1, 0);
+    for (int a : treeArcs)
+    {
+        start[flat.arc(a).tail + 1]++;
+        start[flat.arc(a).head + 1]++;
+    }
+    for (int v = 0; v < n; v++)
+    {
+        start[v + 1] += start[v];
+    }
+    ScratchVector<int> adjacent(start[n]);
+    ScratchVector<int> position(start.begin(), start.end() - 1);
+    for (int a : treeArcs)
+    {
+        adjacent[position[flat.arc(a).tail]++] = a;
+        adjacent[position[flat.arc(a).head]++] = a;
+    }
+
+    // Подвешиваем каждое дерево леса обходом в ширину
+    parent.assign(n, -1);
+    parentArc.assign(n, -1);
+    parentCapacity.assign(n, 0.0);
+    ScratchVector<char> visited(n, 0);
+    ScratchVector<int> queue;
+    queue.reserve(n);
+    for (int rootNode = 0; rootNode < n; rootNode++)
+    {
+        if (visited[rootNode])
+            continue;
+        visited[rootNode] = 1;
+        queue.clear();
+        queue.push_back(rootNode);
+        for (size_t head = 0; head < queue.size(); head++)
+        {
+            int u = queue[head];
+            for (int i = start[u]; i < start[u + 1]; i++)
+            {
+                const FlatGraph::Arc &arc = flat.arc(adjacent[i]);
+                int v = arc.tail == u ? arc.head : arc.tail;
+                if (visited[v])
+                    continue;
+                visited[v] = 1;
+                parent[v] = u;
+                parentArc[v] = adjacent[i];
+                parentCapacity[v] = arc.capacity;
+                queue.push_back(v);
+            }
+        }
+    }
+
+    lookup.build(parent, parentCapacity);
+
+    graphVersion = graph.getVersion();
+    networkVersion = network.getVersion();
+    built = true;
+}
+
+bool BottleneckIndex::isBuiltFrom(const Graph &graph, const PipelineNetwork &network) const
+{
+    return built && graphVersion == graph.getVersion() && networkVersion == network.getVersion();
+}
+
+double BottleneckIndex::bottleneck(int stationA, int stationB) const
+{
+    int a = flat.nodeOf(stationA);
+    int b = flat.nodeOf(stationB);
+    if (!built || a < 0 || b < 0 || a == b)
+    {
+        return 0.0;
+    }
+    return lookup.pathMinimum(a, b);
+}
+
+bool BottleneckIndex::route(int stationA, int stationB, vector<int> &stations, vector<int> &pipeIds) const
+{
+    stations.clear();
+    pipeIds.clear();
+
+    int a = flat.nodeOf(stationA);
+    int b = flat.nodeOf(stationB);
+    if (!built || a < 0 || b < 0 || a == b)
+    {
+        return false;
+    }
+
+    int common = lookup.lowestCommonAncestor(a, b);
+    if (common < 0)
+    {
+        return false;
+    }
+
+    // От A вверх до общего предка, затем от общего предка вниз до B
+    for (int v = a; v != common; v = parent[v])
+    {
+        stations.push_back(flat.stationAt(v));
+        pipeIds.push_back(flat.arc(parentArc[v]).pipeId);
+    }
+    stations.push_back(flat.stationAt(common));
+
+    size_t middle = stations.size();
+    size_t middlePipes = pipeIds.size();
+    for (int v = b; v != common; v = parent[v])
+    {
+        stations.push_back(flat.stationAt(v));
+        pipeIds.push_back(flat.arc(parentArc[v]).pipeId);
+    }
+    reverse(stations.begin() + middle, stations.end());
+    reverse(pipeIds.begin() + middlePipes, pipeIds.end());
+    return true;
+}
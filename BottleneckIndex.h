@@ -0,0 +1,38 @@
+#ifndef BOTTLENECK_INDEX_H
+#define BOTTLENECK_INDEX_H
+
+#include "FlatGraph.h"
+#include "TreePathIndex.h"
+#include <cstdint>
+#include <vector>
+
+// Предрасчет "ширины" (наибольшей минимальной пропускной способности маршрута)
+// для всех пар станций при неизменной сети. Для неориентированной модели
+// (трубы проводят газ в обе стороны) самый широкий путь между любыми станциями
+// проходит по максимальному остовному лесу, поэтому запрос - минимум на пути в лесу.
+class BottleneckIndex
+{
+private:
+    FlatGraph flat;
+    IndexVector<int> parent;     // родитель в лесу (-1 для корней)
+    IndexVector<int> parentArc;  // дуга flat, ведущая к родителю
+    IndexVector<double> parentCapacity;
+    TreePathIndex lookup;
+
+    uint64_t graphVersion = 0;
+    uint64_t networkVersion = 0;
+    bool built = false;
+
+public:
+    // Краскал по убыванию пропускной способности, O(m log m)
+    void build(const Graph &graph, const PipelineNetwork &network);
+    bool isBuiltFrom(const Graph &graph, const PipelineNetwork &network) const;
+
+    // Ширина лучшего маршрута (0, если станции не связаны исправными трубами)
+    double bottleneck(int stationA, int stationB) const;
+
+    // Сам маршрут по лесу: станции от A до B и ID труб между ними
+    bool route(int stationA, int stationB, std::vector<int> &stations, std::vector<int> &pipeIds) const;
+};
+
+#endif
@@ -0,0 +1,101 @@
+#include "CalculationWorkspace.h"
+#include <algorithm>
+
+using namespace std;
+
+void CalculationWorkspace::prepare(const FlatGraph &graph)
+{
+    size_t nodes = static_cast<size_t>(graph.getNodeCount());
+    size_t arcs = static_cast<size_t>(graph.getArcCount());
+
+    // Буферы прошлых запросов, занятые этим графом, входят в пик временной памяти замера
+    using Scope = MemoryTracker::ScratchScope;
+    Scope::reuse(reusedScope,
+                 Scope::reusedBytes(stamp, nodes) + Scope::reusedBytes(distance, nodes) +
+                     Scope::reusedBytes(parentArc, nodes) + Scope::reusedBytes(potential, nodes) +
+                     Scope::reusedBytes(queue, nodes) + Scope::reusedBytes(heap, arcs + 1) +
+                     Scope::reusedBytes(arcStamp, arcs) + Scope::reusedBytes(flow, arcs) +
+                     Scope::reusedBytes(touchedArcs, arcs) + Scope::reusedBytes(overrideStamp, arcs) +
+                     Scope::reusedBytes(capacityOverride, arcs));
+
+    if (stamp.size() < nodes)
+    {
+        // Новые ячейки получают поколение 0, а текущее поколение всегда больше 0
+        stamp.resize(nodes, 0);
+        distance.resize(nodes);
+        parentArc.resize(nodes);
+        potential.resize(nodes);
+    }
+    if (queue.capacity() < nodes)
+    {
+        queue.reserve(nodes);
+    }
+    if (heap.capacity() < arcs + 1)
+    {
+        heap.reserve(arcs + 1);
+    }
+
+    if (arcStamp.size() < arcs)
+    {
+        arcStamp.resize(arcs, 0);
+        flow.resize(arcs, 0.0);
+        touchedArcs.reserve(arcs);
+        overrideStamp.resize(arcs, 0);
+        capacityOverride.resize(arcs, 0.0);
+    }
+
+    // Поток и изменения могли остаться от другого графа - начинаем заново
+    resetFlow();
+    clearCapacityOverrides();
+}
+
+void CalculationWorkspace::clearCapacityOverrides()
+{
+    overrideGeneration++;
+    if (overrideGeneration == 0)
+    {
+        fill(overrideStamp.begin(), overrideStamp.end(), 0);
+        overrideGeneration = 1;
+    }
+}
+
+void CalculationWorkspace::beginQuery()
+{
+    generation++;
+    if (generation == 0)
+    {
+        // Переполнение счетчика: единственный случай полной очистки
+        fill(stamp.begin(), stamp.end(), 0);
+        generation = 1;
+    }
+}
+
+void CalculationWorkspace::resetFlow()
+{
+    for (int arc : touchedArcs)
+    {
+        flow[arc] = 0.0;
+    }
+    keepFlow();
+}
+
+void CalculationWorkspace::restoreFlow(const ScratchVector<double> &baseline)
+{
+    for (int arc : touchedArcs)
+    {
+        flow[arc] = baseline[arc];
+    }
+    keepFlow();
+}
+
+void CalculationWorkspace::keepFlow()
+{
+    touchedArcs.clear();
+
+    flowGeneration++;
+    if (flowGeneration == 0)
+    {
+        fill(arcStamp.begin(), arcStamp.end(), 0);
+        flowGeneration = 1;
+    }
+}
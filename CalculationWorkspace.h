@@ -0,0 +1,103 @@
+#ifndef CALCULATION_WORKSPACE_H
+#define CALCULATION_WORKSPACE_H
+
+#include "FlatGraph.h"
+#include "FrontierBfs.h"
+#include "MemoryTracker.h"
+#include <cstdint>
+#include <utility>
+
+// Рабочая область алгоритмов NetworkCalculator: расстояния, родители, очередь,
+// куча и потоки по дугам, заранее выделенные под размер плоского графа.
+// Сброс между запросами - увеличением номера поколения (O(1)), а не очисткой массивов;
+// потоки по дугам сбрасываются только там, где менялись (O(touched)).
+// Одна рабочая область - на один поток.
+class CalculationWorkspace
+{
+private:
+    ScratchVector<uint32_t> stamp; // поколение, в котором узел был затронут
+    uint32_t generation = 0;
+
+    ScratchVector<uint32_t> arcStamp; // поколение, в котором менялся поток по дуге
+    uint32_t flowGeneration = 1;
+
+    // Временные изменения пропускной способности дуг (отключение трубы, сценарии)
+    ScratchVector<double> capacityOverride;
+    ScratchVector<uint32_t> overrideStamp;
+    uint32_t overrideGeneration = 1;
+
+    uint64_t reusedScope = 0; // замер временной памяти, в котором буферы уже учтены
+
+public:
+    ScratchVector<double> distance;
+    ScratchVector<int> parentArc;
+    ScratchVector<int> queue;
+    ScratchVector<std::pair<double, int>> heap;
+    ScratchVector<double> flow;
+    ScratchVector<int> touchedArcs;
+    ScratchVector<double> potential; // потенциалы узлов (поток минимальной стоимости)
+    FrontierBfs bfs;                 // обход в ширину с битовыми фронтами
+
+    // Подогнать буферы под граф (выделение памяти только при росте графа)
+    void prepare(const FlatGraph &graph);
+
+    // Начать новый запрос по узлам: все узлы становятся "незатронутыми"
+    void beginQuery();
+    bool isTouched(int node) const { return stamp[node] == generation; }
+    void touch(int node, double initialDistance, int parent)
+    {
+        stamp[node] = generation;
+        distance[node] = initialDistance;
+        parentArc[node] = parent;
+    }
+
+    // Потоки по дугам: обнулить только измененные дуги
+    void resetFlow();
+    // Считать текущий поток исходным: touchedArcs копит только последующие изменения.
+    // Перед resetFlow такие потоки нужно обнулить самому (resetFlow их не видит).
+    void keepFlow();
+    // Вернуть измененным после keepFlow дугам потоки baseline (по всем дугам)
+    void restoreFlow(const ScratchVector<double> &baseline);
+    void setFlow(const FlatGraph &graph, int arc, double value)
+    {
+        markArc(arc);
+        markArc(graph.arc(arc).reverse);
+        flow[arc] = value;
+        flow[graph.arc(arc).reverse] = -value;
+    }
+    void addFlow(const FlatGraph &graph, int arc, double amount)
+    {
+        markArc(arc);
+        markArc(graph.arc(arc).reverse);
+        flow[arc] += amount;
+        flow[graph.arc(arc).reverse] -= amount;
+    }
+
+    // Пропускная способность дуги с учетом временных изменений
+    void setCapacity(int arc, double value)
+    {
+        overrideStamp[arc] = overrideGeneration;
+        capacityOverride[arc] = value;
+    }
+    void clearCapacityOverrides();
+    double capacity(const FlatGraph &graph, int arc) const
+    {
+        return overrideStamp[arc] == overrideGeneration ? capacityOverride[arc] : graph.arc(arc).capacity;
+    }
+    double residual(const FlatGraph &graph, int arc) const
+    {
+        return capacity(graph, arc) - flow[arc];
+    }
+
+private:
+    void markArc(int arc)
+    {
+        if (arcStamp[arc] != flowGeneration)
+        {
+            arcStamp[arc] = flowGeneration;
+            touchedArcs.push_back(arc);
+        }
+    }
+};
+
+#endif
@@ -3,11 +3,26 @@
 #include <fstream>
 #include <cctype>
 
-int CompressorStation::nextId = 1;
+std::atomic<int> CompressorStation::nextId{1};
 
 CompressorStation::CompressorStation()
     : id(0), name(""), totalShops(0), workingShops(0), stationClass(0) {}
 
+CompressorStation::CompressorStation(int id, const std::string &name, int totalShops, int workingShops, int stationClass)
+    : id(id), name(name), totalShops(totalShops), workingShops(workingShops), stationClass(stationClass)
+{
+    reserveId(id);
+}
+
+void CompressorStation::reserveId(int usedId)
+{
+    // Атомарно поднимаем счетчик до usedId + 1
+    int current = nextId.load();
+    while (usedId >= current && !nextId.compare_exchange_weak(current, usedId + 1))
+    {
+    }
+}
+
 int CompressorStation::getId() const { return id; }
 std::string CompressorStation::getName() const { return name; }
 int CompressorStation::getTotalShops() const { return totalShops; }
@@ -28,8 +43,7 @@ void CompressorStation::setStationClass(int stationClass) { this->stationClass =
 
 void CompressorStation::input()
 {
-    id = getNextId(); // Устанавливаем ID перед вводом данных
-    incrementId();    // Увеличиваем счетчик
+    id = acquireId(); // Атомарно получаем ID перед вводом данных
 
     std::cout << "Enter station name: ";
     std::getline(std::cin, name);
@@ -271,10 +285,7 @@ void CompressorStation::loadFromFile(std::ifstream &file)
     file.ignore();
 
     // Обновляем nextId чтобы избежать конфликтов
-    if (id >= nextId)
-    {
-        nextId = id + 1;
-    }
+    reserveId(id);
 }
 
 bool CompressorStation::matchesName(const std::string &searchName) const
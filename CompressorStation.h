@@ -2,11 +2,12 @@
 #define COMPRESSOR_STATION_H
 
 #include <string>
+#include <atomic>
 
 class CompressorStation
 {
 private:
-    static int nextId;
+    static std::atomic<int> nextId;
     int id;
     std::string name;
     int totalShops;
@@ -15,11 +16,14 @@ private:
 
 public:
     CompressorStation();
+    CompressorStation(int id, const std::string &name, int totalShops, int workingShops, int stationClass);
 
     // Статические методы для управления ID
-    static int getNextId() { return nextId; }
+    static int getNextId() { return nextId.load(); }
     static void incrementId() { nextId++; }
     static void resetId() { nextId = 1; }
+    static int acquireId() { return nextId.fetch_add(1); }
+    static void reserveId(int usedId);
 
     int getId() const;
     std::string getName() const;
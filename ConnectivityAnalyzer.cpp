@@ -0,0 +1,141 @@
+#include "ConnectivityAnalyzer.h"
+#include "MemoryTracker.h"
+#include <algorithm>
+#include <unordered_map>
+
+using namespace std;
+
+const ConnectivityAnalyzer::Report &ConnectivityAnalyzer::analyze(const Graph &graph)
+{
+    if (!valid || cachedVersion != graph.getVersion())
+    {
+        cached = compute(graph);
+        cachedVersion = graph.getVersion();
+        valid = true;
+    }
+    return cached;
+}
+
+ConnectivityAnalyzer::Report ConnectivityAnalyzer::compute(const Graph &graph)
+{
+    static const MemoryTracker::ScratchTag scratchTag("ConnectivityAnalyzer::compute");
+    MemoryTracker::ScratchScope scratch(scratchTag);
+
+    Report report;
+
+    // Неориентированный граф в CSR: у каждой трубы два вхождения с общим номером ребра,
+    // чтобы параллельные трубы между одними станциями не считались одним ребром
+    vector<int> stations = graph.getVertices();
+    sort(stations.begin(), stations.end());
+    int n = static_cast<int>(stations.size());
+
+    unordered_map<int, int> nodeOf;
+    nodeOf.reserve(n);
+    for (int i = 0; i < n; i++)
+    {
+        nodeOf[stations[i]] = i;
+    }
+
+    auto connections = graph.getConnectionsWithPipe();
+    int m = static_cast<int>(connections.size());
+    ScratchVector<int> edgeFrom(m), edgeTo(m);
+    ScratchVector<int> start(n + 1, 0);
+    for (int e = 0; e < m; e++)
+    {
+        edgeFrom[e] = nodeOf[connections[e].first];
+        edgeTo[e] = nodeOf[connections[e].second.first];
+        start[edgeFrom[e] + 1]++;
+        start[edgeTo[e] + 1]++;
+    }
+    for (int v = 0; v < n; v++)
+    {
+        start[v + 1] += start[v];
+    }
+    ScratchVector<int> incident(start[n]);
+    ScratchVector<int> position(start.begin(), start.end() - 1);
+    for (int e = 0; e < m; e++)
+    {
+        incident[position[edgeFrom[e]]++] = e;
+        incident[position[edgeTo[e]]++] = e;
+    }
+
+    // Итеративный DFS: явный стек (узел, ребро входа, следующий инцидентный индекс)
+    ScratchVector<int> discovery(n, -1), low(n, 0), parentEdge(n, -1), nextIncident(n, 0);
+    ScratchVector<int> stack;
+    ScratchVector<char> isArticulation(n, 0);
+    stack.reserve(n);
+    int timer = 0;
+
+    for (int rootNode = 0; rootNode < n; rootNode++)
+    {
+        // Станция без труб (например, после disconnectStations) компонентой не считается
+        if (discovery[rootNode] >= 0 || start[rootNode] == start[rootNode + 1])
+            continue;
+
+        report.components++;
+        int rootChildren = 0;
+        discovery[rootNode] = low[rootNode] = timer++;
+        nextIncident[rootNode] = start[rootNode];
+        stack.push_back(rootNode);
+
+        while (!stack.empty())
+        {
+            int u = stack.back();
+            if (nextIncident[u] < start[u + 1])
+            {
+                int e = incident[nextIncident[u]++];
+                if (e == parentEdge[u])
+                    continue;
+
+                int v = edgeFrom[e] == u ? edgeTo[e] : edgeFrom[e];
+                if (discovery[v] < 0)
+                {
+                    discovery[v] = low[v] = timer++;
+                    parentEdge[v] = e;
+                    nextIncident[v] = start[v];
+                    stack.push_back(v);
+                    if (u == rootNode)
+                        rootChildren++;
+                }
+                else
+                {
+                    low[u] = min(low[u], discovery[v]);
+                }
+                continue;
+            }
+
+            // Все ребра u просмотрены - возвращаемся к родителю
+            stack.pop_back();
+            if (stack.empty())
+                break;
+
+            int parent = stack.back();
+            low[parent] = min(low[parent], low[u]);
+
+            if (low[u] > discovery[parent])
+            {
+                int e = parentEdge[u];
+                report.bridges.push_back({connections[e].second.second, connections[e].first, connections[e].second.first});
+            }
+            if (parent != rootNode && low[u] >= discovery[parent])
+            {
+                isArticulation[parent] = 1;
+            }
+        }
+
+        if (rootChildren > 1)
+        {
+            isArticulation[rootNode] = 1;
+        }
+    }
+
+    for (int v = 0; v < n; v++)
+    {
+        if (isArticulation[v])
+            report.articulationStations.push_back(stations[v]);
+    }
+    sort(report.bridges.begin(), report.bridges.end(), [](const Bridge &a, const Bridge &b)
+         { return a.pipeId < b.pipeId; });
+
+    return report;
+}
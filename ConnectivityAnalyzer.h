@@ -0,0 +1,41 @@
+#ifndef CONNECTIVITY_ANALYZER_H
+#define CONNECTIVITY_ANALYZER_H
+
+#include "Graph.h"
+#include <vector>
+#include <cstdint>
+
+// Критические элементы топологии: трубы-мосты и станции-точки сочленения,
+// потеря которых разделяет сеть на части. Трубы считаются неориентированными
+// (связность, а не направление потока). Итеративный обход Тарьяна, O(V + E);
+// результат кэшируется до изменения версии графа.
+class ConnectivityAnalyzer
+{
+public:
+    struct Bridge
+    {
+        int pipeId;
+        int fromStation;
+        int toStation;
+    };
+
+    struct Report
+    {
+        std::vector<Bridge> bridges;            // по возрастанию ID трубы
+        std::vector<int> articulationStations;  // по возрастанию ID
+        size_t components = 0;                  // компонент связности среди соединенных станций
+    };
+
+private:
+    Report cached;
+    uint64_t cachedVersion = 0;
+    bool valid = false;
+
+public:
+    // Отчет для текущей версии графа (пересчет только после изменений)
+    const Report &analyze(const Graph &graph);
+
+    static Report compute(const Graph &graph);
+};
+
+#endif
@@ -0,0 +1,132 @@
+#include "ContingencyAnalyzer.h"
+#include "NetworkCalculator.h"
+#include "TaskScheduler.h"
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+using namespace std;
+
+ContingencyAnalyzer::Report ContingencyAnalyzer::analyze(
+    const FlatGraph &graph,
+    int sourceStation,
+    int targetStation,
+    int depth)
+{
+    const double unlimited = numeric_limits<double>::max();
+    const double eps = NetworkCalculator::FLOW_EPSILON;
+
+    Report report;
+    report.depth = depth >= 2 ? 2 : 1;
+
+    int source = graph.nodeOf(sourceStation);
+    int target = graph.nodeOf(targetStation);
+    if (source < 0 || target < 0 || source == target)
+    {
+        return report;
+    }
+
+    // Базовое решение без отказов
+    CalculationWorkspace &baseWorkspace = NetworkCalculator::threadWorkspace();
+    baseWorkspace.prepare(graph);
+    report.baseFlow = NetworkCalculator::calculateMaxFlow(graph, baseWorkspace, sourceStation, targetStation);
+
+    // Копия базового потока (только ненулевые прямые дуги) - отсюда стартует каждый сценарий
+    vector<pair<int, double>> baseFlow;
+    for (int arc : baseWorkspace.touchedArcs)
+    {
+        if (graph.arc(arc).forward && fabs(baseWorkspace.flow[arc]) > eps)
+        {
+            baseFlow.push_back({arc, baseWorkspace.flow[arc]});
+        }
+    }
+
+    vector<int> pipeArcs;
+    vector<char> carriesFlow(graph.getArcCount(), 0);
+    for (int arc = 0; arc < graph.getArcCount(); arc++)
+    {
+        if (graph.arc(arc).forward && graph.arc(arc).pipeId >= 0)
+        {
+            pipeArcs.push_back(arc);
+        }
+    }
+    for (const auto &entry : baseFlow)
+    {
+        if (entry.second > eps && graph.arc(entry.first).pipeId >= 0)
+        {
+            carriesFlow[entry.first] = 1;
+        }
+    }
+
+    // Сценарии: хотя бы одна из отключаемых труб должна нести поток,
+    // иначе максимальный поток не меняется и расчет не нужен
+    vector<vector<int>> scenarios;
+    size_t totalScenarios = 0;
+    if (report.depth == 1)
+    {
+        totalScenarios = pipeArcs.size();
+        for (int arc : pipeArcs)
+        {
+            if (carriesFlow[arc])
+                scenarios.push_back({arc});
+        }
+    }
+    else
+    {
+        totalScenarios = pipeArcs.size() * (pipeArcs.size() - (pipeArcs.empty() ? 0 : 1)) / 2;
+        for (size_t i = 0; i < pipeArcs.size(); i++)
+        {
+            for (size_t j = i + 1; j < pipeArcs.size(); j++)
+            {
+                if (carriesFlow[pipeArcs[i]] || carriesFlow[pipeArcs[j]])
+                    scenarios.push_back({pipeArcs[i], pipeArcs[j]});
+            }
+        }
+    }
+    report.evaluatedScenarios = scenarios.size();
+    report.skippedScenarios = totalScenarios - scenarios.size();
+
+    vector<Outage> outages(scenarios.size());
+    TaskScheduler::instance().parallelFor(0, scenarios.size(), 1, [&](size_t index)
+                                          {
+        // Своя рабочая область потока; плоский граф общий и только читается
+        CalculationWorkspace &workspace = NetworkCalculator::threadWorkspace();
+        workspace.prepare(graph);
+        for (const auto &entry : baseFlow)
+        {
+            workspace.setFlow(graph, entry.first, entry.second);
+        }
+
+        // Теплый старт: снимаем поток с отключенных труб и доращиваем остальное
+        double value = report.baseFlow;
+        for (int arc : scenarios[index])
+        {
+            value -= NetworkCalculator::reduceArcFlow(graph, workspace, arc, 0.0, source, target);
+        }
+        value += NetworkCalculator::augmentFlow(graph, workspace, source, target, unlimited);
+
+        Outage &outage = outages[index];
+        for (int arc : scenarios[index])
+        {
+            outage.pipeIds.push_back(graph.arc(arc).pipeId);
+            outage.fromStations.push_back(graph.stationAt(graph.splitInNode(graph.arc(arc).tail)));
+            outage.toStations.push_back(graph.stationAt(graph.arc(arc).head));
+        }
+        outage.remainingFlow = max(0.0, value);
+        outage.lostFlow = report.baseFlow - outage.remainingFlow;
+        if (outage.lostFlow < eps * max(1.0, report.baseFlow))
+        {
+            outage.lostFlow = 0.0; // шум округления при перенаправлении
+        }
+        outage.lostPercent = report.baseFlow > 0.0 ? outage.lostFlow * 100.0 / report.baseFlow : 0.0; });
+
+    // Рейтинг критичности: по убыванию потерь, при равенстве - по ID труб
+    stable_sort(outages.begin(), outages.end(), [](const Outage &a, const Outage &b)
+                {
+        if (a.lostFlow != b.lostFlow)
+            return a.lostFlow > b.lostFlow;
+        return a.pipeIds < b.pipeIds; });
+
+    report.ranking = move(outages);
+    return report;
+}
@@ -0,0 +1,40 @@
+#ifndef CONTINGENCY_ANALYZER_H
+#define CONTINGENCY_ANALYZER_H
+
+#include "FlatGraph.h"
+#include <vector>
+#include <cstddef>
+
+// Анализ отказов N-1 (и N-2): максимальный поток источник -> сток
+// при отключении каждой трубы (пары труб). Граф может быть с расщепленными
+// станциями (cachedStationGraph): отключаются только дуги труб, ограничения станций
+// остаются, и базовый поток совпадает с calculateMaxFlow.
+class ContingencyAnalyzer
+{
+public:
+    struct Outage
+    {
+        std::vector<int> pipeIds;      // отключенные трубы
+        std::vector<int> fromStations; // начала труб (по порядку pipeIds)
+        std::vector<int> toStations;   // концы труб
+        double remainingFlow = 0.0;
+        double lostFlow = 0.0;
+        double lostPercent = 0.0;
+    };
+
+    struct Report
+    {
+        double baseFlow = 0.0;
+        int depth = 1;
+        size_t evaluatedScenarios = 0;
+        size_t skippedScenarios = 0; // отказы без влияния: трубы без потока в базовом решении
+        std::vector<Outage> ranking; // по убыванию потерь
+    };
+
+    // depth = 1 (N-1) или 2 (N-2). Отказы считаются параллельно на общем плоском графе,
+    // каждый - с теплого старта от базового потока. В рейтинг попадают только отказы,
+    // которые могут снизить поток: отключение трубы без потока его не меняет.
+    static Report analyze(const FlatGraph &graph, int sourceStation, int targetStation, int depth = 1);
+};
+
+#endif
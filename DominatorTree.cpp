@@ -0,0 +1,219 @@
+#include "DominatorTree.h"
+#include <algorithm>
+#include <limits>
+
+using namespace std;
+
+void DominatorTree::build(const Graph &graph, const PipelineNetwork &network, int source)
+{
+    static const MemoryTracker::ScratchTag scratchTag("DominatorTree::build");
+    MemoryTracker::ScratchScope scratch(scratchTag);
+
+    flat.build(graph, network);
+    int n = flat.getNodeCount();
+    sourceNode = flat.nodeOf(source);
+    sourceStation = source;
+
+    idom.assign(n, -1);
+    enter.assign(n, -1);
+    leave.assign(n, -1);
+    preorder.clear();
+
+    graphVersion = graph.getVersion();
+    networkVersion = network.getVersion();
+    built = true;
+
+    if (sourceNode < 0)
+    {
+        return;
+    }
+
+    const double infinity = numeric_limits<double>::max();
+    auto passable = [&](const FlatGraph::Arc &arc)
+    { return arc.forward && arc.length < infinity; };
+
+    // Обратный постпорядок итеративным DFS от источника
+    ScratchVector<int> postorder;
+    ScratchVector<int> rpoNumber(n, -1);
+    ScratchVector<int> nextArc(n, 0);
+    ScratchVector<char> visited(n, 0);
+    ScratchVector<int> stack;
+    postorder.reserve(n);
+    stack.push_back(sourceNode);
+    visited[sourceNode] = 1;
+    nextArc[sourceNode] = flat.arcBegin(sourceNode);
+    while (!stack.empty())
+    {
+        int u = stack.back();
+        if (nextArc[u] < flat.arcEnd(u))
+        {
+            const FlatGraph::Arc &arc = flat.arc(nextArc[u]++);
+            if (passable(arc) && !visited[arc.head])
+            {
+                visited[arc.head] = 1;
+                nextArc[arc.head] = flat.arcBegin(arc.head);
+                stack.push_back(arc.head);
+            }
+            continue;
+        }
+        postorder.push_back(u);
+        stack.pop_back();
+    }
+    reverse(postorder.begin(), postorder.end());
+    for (size_t i = 0; i < postorder.size(); i++)
+    {
+        rpoNumber[postorder[i]] = static_cast<int>(i);
+    }
+
+    // Итерации до неподвижной точки; предшественники - через обратные дуги CSR
+    auto intersect = [&](int a, int b)
+    {
+        while (a != b)
+        {
+            while (rpoNumber[a] > rpoNumber[b])
+                a = idom[a];
+            while (rpoNumber[b] > rpoNumber[a])
+                b = idom[b];
+        }
+        return a;
+    };
+
+    idom[sourceNode] = sourceNode;
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (size_t i = 1; i < postorder.size(); i++)
+        {
+            int v = postorder[i];
+            int newIdom = -1;
+            for (int a = flat.arcBegin(v); a < flat.arcEnd(v); a++)
+            {
+                const FlatGraph::Arc &reverseArc = flat.arc(a);
+                if (reverseArc.forward || !passable(flat.arc(reverseArc.reverse)))
+                    continue;
+                int predecessor = reverseArc.head;
+                if (idom[predecessor] < 0)
+                    continue;
+                newIdom = newIdom < 0 ? predecessor : intersect(predecessor, newIdom);
+            }
+            if (newIdom != idom[v])
+            {
+                idom[v] = newIdom;
+                changed = true;
+            }
+        }
+    }
+
+    // Интервалы прямого обхода дерева доминаторов (дети - в CSR по idom)
+    ScratchVector<int> childStart(n + 1, 0);
+    for (int v : postorder)
+    {
+        if (v != sourceNode)
+            childStart[idom[v] + 1]++;
+    }
+    for (int v = 0; v < n; v++)
+    {
+        childStart[v + 1] += childStart[v];
+    }
+    ScratchVector<int> children(childStart[n]);
+    ScratchVector<int> position(childStart.begin(), childStart.end() - 1);
+    for (int v : postorder)
+    {
+        if (v != sourceNode)
+            children[position[idom[v]]++] = v;
+    }
+
+    int timer = 0;
+    stack.clear();
+    stack.push_back(sourceNode);
+    for (int v = 0; v < n; v++)
+    {
+        nextArc[v] = childStart[v];
+    }
+    enter[sourceNode] = timer++;
+    preorder.push_back(sourceNode);
+    while (!stack.empty())
+    {
+        int u = stack.back();
+        if (nextArc[u] < childStart[u + 1])
+        {
+            int child = children[nextArc[u]++];
+            enter[child] = timer++;
+            preorder.push_back(child);
+            stack.push_back(child);
+            continue;
+        }
+        leave[u] = timer;
+        stack.pop_back();
+    }
+}
+
+bool DominatorTree::isBuiltFrom(const Graph &graph, const PipelineNetwork &network, int source) const
+{
+    return built && sourceStation == source &&
+           graphVersion == graph.getVersion() && networkVersion == network.getVersion();
+}
+
+bool DominatorTree::isReachable(int station) const
+{
+    int node = flat.nodeOf(station);
+    return built && node >= 0 && idom[node] >= 0;
+}
+
+int DominatorTree::immediateDominator(int station) const
+{
+    int node = flat.nodeOf(station);
+    if (!isReachable(station) || node == sourceNode)
+    {
+        return -1;
+    }
+    return flat.stationAt(idom[node]);
+}
+
+vector<int> DominatorTree::dominatorsOf(int station) const
+{
+    vector<int> result;
+    int node = flat.nodeOf(station);
+    if (!isReachable(station))
+    {
+        return result;
+    }
+
+    for (int v = node; v != sourceNode;)
+    {
+        v = idom[v];
+        result.push_back(flat.stationAt(v));
+    }
+    reverse(result.begin(), result.end());
+    return result;
+}
+
+bool DominatorTree::dominates(int dominator, int station) const
+{
+    if (!isReachable(dominator) || !isReachable(station))
+    {
+        return false;
+    }
+    int a = flat.nodeOf(dominator);
+    int b = flat.nodeOf(station);
+    return enter[a] <= enter[b] && enter[b] < leave[a];
+}
+
+vector<int> DominatorTree::cutOffBy(int station) const
+{
+    vector<int> result;
+    if (!isReachable(station))
+    {
+        return result;
+    }
+
+    // Поддерево в прямом обходе - непрерывный отрезок
+    int node = flat.nodeOf(station);
+    for (int i = enter[node] + 1; i < leave[node]; i++)
+    {
+        result.push_back(flat.stationAt(preorder[i]));
+    }
+    sort(result.begin(), result.end());
+    return result;
+}
@@ -0,0 +1,43 @@
+#ifndef DOMINATOR_TREE_H
+#define DOMINATOR_TREE_H
+
+#include "FlatGraph.h"
+#include "MemoryTracker.h"
+#include <cstdint>
+#include <vector>
+
+// Дерево доминаторов от станции-источника (Купер - Харви - Кеннеди) по исправным
+// трубам ориентированной сети. Станция A доминирует над X, если любой путь газа
+// от источника к X проходит через A; при отказе A отрезаны ровно станции ее поддерева.
+// Запросы: доминаторы X - O(глубина), "доминирует ли" - O(1) по интервалам обхода.
+class DominatorTree
+{
+private:
+    FlatGraph flat;
+    int sourceNode = -1;
+    IndexVector<int> idom;  // непосредственный доминатор узла (-1 - недостижим)
+    IndexVector<int> enter; // интервалы прямого обхода дерева доминаторов
+    IndexVector<int> leave;
+    IndexVector<int> preorder;
+
+    uint64_t graphVersion = 0;
+    uint64_t networkVersion = 0;
+    int sourceStation = -1;
+    bool built = false;
+
+public:
+    void build(const Graph &graph, const PipelineNetwork &network, int source);
+    bool isBuiltFrom(const Graph &graph, const PipelineNetwork &network, int source) const;
+
+    bool isReachable(int station) const;
+    // Непосредственный доминатор или -1 (источник, недостижимая или неизвестная станция)
+    int immediateDominator(int station) const;
+    // Станции, через которые проходит любой путь к station: от источника вниз, без самой station
+    std::vector<int> dominatorsOf(int station) const;
+    bool dominates(int dominator, int station) const;
+    // Станции, теряющие снабжение при отказе station (без нее самой), по возрастанию ID
+    std::vector<int> cutOffBy(int station) const;
+    int getSourceStation() const { return sourceStation; }
+};
+
+#endif
@@ -0,0 +1,255 @@
+#include "FlatGraph.h"
+#include "NetworkCalculator.h"
+
+using namespace std;
+
+void FlatGraph::clear()
+{
+    stationIds.clear();
+    firstArc.assign(1, 0);
+    arcs.clear();
+    pending.clear();
+    nodeByStation.clear();
+    arcByPipe.clear();
+    topologicalOrder.clear();
+    topologicalPosition.clear();
+    acyclic = false;
+    sourceGraph = nullptr;
+    sourceNetwork = nullptr;
+    graphVersion = 0;
+    networkVersion = 0;
+    splitOut.clear();
+    splitIn.clear();
+}
+
+int FlatGraph::addNode(int stationId)
+{
+    int node = static_cast<int>(stationIds.size());
+    stationIds.push_back(stationId);
+    if (!splitIn.empty())
+    {
+        splitIn.push_back(node); // служебный узел, добавленный к расщепленному графу
+    }
+    if (stationId >= 0)
+    {
+        nodeByStation[stationId] = node;
+    }
+    return node;
+}
+
+void FlatGraph::addArcPair(int fromNode, int toNode, int pipeId, double capacity, double length)
+{
+    pending.push_back({fromNode, toNode, pipeId, capacity, length});
+}
+
+void FlatGraph::finalize()
+{
+    // Уже уложенные дуги возвращаем в список, чтобы пересобрать CSR целиком
+    for (const Arc &existing : arcs)
+    {
+        if (existing.forward)
+        {
+            pending.push_back({existing.tail, existing.head, existing.pipeId, existing.capacity, existing.length});
+        }
+    }
+
+    int n = getNodeCount();
+
+    // Сортировка подсчетом по узлу-началу: сначала степени, затем позиции
+    firstArc.assign(n + 1, 0);
+    for (const PendingArc &p : pending)
+    {
+        firstArc[p.tail + 1]++;
+        firstArc[p.head + 1]++;
+    }
+    for (int v = 0; v < n; v++)
+    {
+        firstArc[v + 1] += firstArc[v];
+    }
+
+    IndexVector<int> position(firstArc.begin(), firstArc.end() - 1);
+    arcs.assign(pending.size() * 2, Arc{});
+    arcByPipe.clear();
+
+    for (const PendingArc &p : pending)
+    {
+        int forwardIndex = position[p.tail]++;
+        int reverseIndex = position[p.head]++;
+
+        arcs[forwardIndex] = {p.tail, p.head, reverseIndex, p.pipeId, p.capacity, p.length, true};
+        arcs[reverseIndex] = {p.head, p.tail, forwardIndex, p.pipeId, 0.0, -p.length, false};
+
+        if (p.pipeId >= 0)
+        {
+            arcByPipe[p.pipeId] = forwardIndex;
+        }
+    }
+
+    pending.clear();
+
+    computeTopologicalOrder();
+}
+
+void FlatGraph::computeTopologicalOrder()
+{
+    // Кан: O(n + m), заодно проверка ацикличности
+    int n = getNodeCount();
+    IndexVector<int> inDegree(n, 0);
+    for (const Arc &arc : arcs)
+    {
+        if (arc.forward)
+            inDegree[arc.head]++;
+    }
+
+    topologicalOrder.clear();
+    topologicalOrder.reserve(n);
+    for (int v = 0; v < n; v++)
+    {
+        if (inDegree[v] == 0)
+            topologicalOrder.push_back(v);
+    }
+    for (size_t head = 0; head < topologicalOrder.size(); head++)
+    {
+        int u = topologicalOrder[head];
+        for (int a = arcBegin(u); a < arcEnd(u); a++)
+        {
+            if (arcs[a].forward && --inDegree[arcs[a].head] == 0)
+                topologicalOrder.push_back(arcs[a].head);
+        }
+    }
+
+    acyclic = static_cast<int>(topologicalOrder.size()) == n;
+    if (!acyclic)
+    {
+        topologicalOrder.clear();
+        topologicalPosition.clear();
+        return;
+    }
+
+    topologicalPosition.assign(n, 0);
+    for (int position = 0; position < n; position++)
+    {
+        topologicalPosition[topologicalOrder[position]] = position;
+    }
+}
+
+void FlatGraph::build(const Graph &graph, const PipelineNetwork &network)
+{
+    clear();
+
+    vector<int> vertices = graph.getVertices();
+    stationIds.reserve(vertices.size());
+    nodeByStation.reserve(vertices.size());
+    for (int station : vertices)
+    {
+        addNode(station);
+    }
+
+    auto connections = graph.getConnectionsWithPipe();
+    pending.reserve(connections.size());
+    for (const auto &conn : connections)
+    {
+        const Pipe *pipe = network.getPipeById(conn.second.second);
+        if (!pipe)
+        {
+            continue;
+        }
+
+        double capacity = NetworkCalculator::calculatePipeCapacity(
+            pipe->getLength(),
+            pipe->getDiameter(),
+            pipe->isUnderRepair());
+        double length = NetworkCalculator::calculateEdgeWeight(pipe->getLength(), pipe->isUnderRepair());
+
+        addArcPair(nodeOf(conn.first), nodeOf(conn.second.first), pipe->getId(), capacity, length);
+    }
+
+    finalize();
+
+    sourceGraph = &graph;
+    sourceNetwork = &network;
+    graphVersion = graph.getVersion();
+    networkVersion = network.getVersion();
+}
+
+void FlatGraph::buildUndirected(const Graph &graph, const PipelineNetwork &network)
+{
+    build(graph, network);
+
+    for (const Arc &existing : arcs)
+    {
+        if (existing.forward && existing.pipeId >= 0)
+        {
+            pending.push_back({existing.head, existing.tail, -1, existing.capacity, existing.length});
+        }
+    }
+    finalize();
+}
+
+void FlatGraph::buildSplit(const FlatGraph &base, const vector<double> &nodeCapacity, bool unitPipes)
+{
+    clear();
+
+    int n = base.getNodeCount();
+    stationIds.reserve(2 * n);
+    nodeByStation.reserve(n);
+    for (int v = 0; v < n; v++)
+    {
+        addNode(base.stationAt(v));
+    }
+    splitOut.resize(n);
+    for (int v = 0; v < n; v++)
+    {
+        splitOut[v] = nodeCapacity[v] < 0.0 ? v : addNode(-1);
+    }
+    splitIn.resize(getNodeCount());
+    for (int v = 0; v < n; v++)
+    {
+        splitIn[v] = v;
+        splitIn[splitOut[v]] = v;
+    }
+
+    pending.reserve(n + base.getArcCount() / 2);
+    for (int v = 0; v < n; v++)
+    {
+        if (splitOut[v] != v)
+        {
+            addArcPair(v, splitOut[v], -1, nodeCapacity[v], 0.0);
+        }
+    }
+    for (int a = 0; a < base.getArcCount(); a++)
+    {
+        const Arc &arc = base.arc(a);
+        if (arc.forward)
+        {
+            double capacity = unitPipes ? (arc.capacity > NetworkCalculator::FLOW_EPSILON ? 1.0 : 0.0) : arc.capacity;
+            addArcPair(splitOut[arc.tail], arc.head, arc.pipeId, capacity, arc.length);
+        }
+    }
+
+    finalize();
+
+    // Актуален, пока актуален исходный граф
+    sourceGraph = base.sourceGraph;
+    sourceNetwork = base.sourceNetwork;
+    graphVersion = base.graphVersion;
+    networkVersion = base.networkVersion;
+}
+
+bool FlatGraph::isBuiltFrom(const Graph &graph, const PipelineNetwork &network) const
+{
+    return sourceGraph == &graph && sourceNetwork == &network &&
+           graphVersion == graph.getVersion() && networkVersion == network.getVersion();
+}
+
+int FlatGraph::nodeOf(int stationId) const
+{
+    auto it = nodeByStation.find(stationId);
+    return it != nodeByStation.end() ? it->second : -1;
+}
+
+int FlatGraph::arcOfPipe(int pipeId) const
+{
+    auto it = arcByPipe.find(pipeId);
+    return it != arcByPipe.end() ? it->second : -1;
+}
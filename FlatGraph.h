@@ -0,0 +1,125 @@
+#ifndef FLAT_GRAPH_H
+#define FLAT_GRAPH_H
+
+#include "Graph.h"
+#include "PipelineNetwork.h"
+#include "MemoryTracker.h"
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+// Плоское (CSR) представление сети для расчетов.
+// Станции перенумерованы подряд (0..n-1), дуги исходящие из узла лежат непрерывно.
+// Каждая труба дает пару дуг остаточной сети: прямую (capacity, length)
+// и обратную (пропускная способность 0, стоимость -length).
+class FlatGraph
+{
+public:
+    struct Arc
+    {
+        int tail;       // узел-начало
+        int head;       // узел-конец
+        int reverse;    // индекс парной дуги
+        int pipeId;     // ID трубы (-1 для служебных дуг)
+        double capacity;
+        double length;  // вес для кратчайших путей (INF для труб в ремонте)
+        bool forward;   // true - дуга трубы, false - обратная дуга остаточной сети
+    };
+
+private:
+    struct PendingArc
+    {
+        int tail;
+        int head;
+        int pipeId;
+        double capacity;
+        double length;
+    };
+
+    IndexVector<int> stationIds;                 // узел -> ID станции (-1 для служебных узлов)
+    IndexVector<int> firstArc;                   // CSR: дуги узла v - [firstArc[v], firstArc[v + 1])
+    IndexVector<Arc> arcs;
+    IndexVector<PendingArc> pending;             // дуги, добавленные после последнего finalize()
+    std::unordered_map<int, int, std::hash<int>, std::equal_to<int>,
+                       TrackingAllocator<std::pair<const int, int>, MemoryCategory::Indexes>>
+        nodeByStation;
+    std::unordered_map<int, int, std::hash<int>, std::equal_to<int>,
+                       TrackingAllocator<std::pair<const int, int>, MemoryCategory::Indexes>>
+        arcByPipe;
+
+    // Топологический порядок узлов по прямым дугам (считается в finalize)
+    IndexVector<int> topologicalOrder;
+    IndexVector<int> topologicalPosition;
+    bool acyclic = false;
+
+    void computeTopologicalOrder();
+
+    // Откуда построен граф: для проверки актуальности кэша
+    const Graph *sourceGraph = nullptr;
+    const PipelineNetwork *sourceNetwork = nullptr;
+    uint64_t graphVersion = 0;
+    uint64_t networkVersion = 0;
+
+    // Расщепленный граф: выход узла-входа и вход (владелец) каждого узла;
+    // пусто, если граф не расщеплен
+    IndexVector<int> splitOut;
+    IndexVector<int> splitIn;
+
+public:
+    FlatGraph() = default;
+
+    // Построить по топологии и данным труб (трубы без данных пропускаются)
+    void build(const Graph &graph, const PipelineNetwork &network);
+    // Неориентированное представление: каждая труба проводима в обе стороны
+    // (встречная пара дуг имеет pipeId = -1)
+    void buildUndirected(const Graph &graph, const PipelineNetwork &network);
+    bool isBuiltFrom(const Graph &graph, const PipelineNetwork &network) const;
+
+    // Граф с расщепленными узлами: узел v исходного графа становится парой
+    // "вход" (узел v, ID станции сохраняется) и "выход" (служебный узел после
+    // узлов исходного графа), связанных дугой с пропускной способностью nodeCapacity[v].
+    // Трубы u -> v идут из выхода u во вход v. Так ограничения на станции сводятся к дугам.
+    // Узлы с отрицательной nodeCapacity не расщепляются: ограничения у них нет,
+    // и граф остается почти того же размера, что исходный.
+    // unitPipes - трубы с ненулевой пропускной способностью получают 1 (независимые маршруты).
+    void buildSplit(const FlatGraph &base, const std::vector<double> &nodeCapacity, bool unitPipes = false);
+    int splitOutNode(int node) const { return splitOut.empty() ? node : splitOut[node]; }
+    // Узел-вход станции, которой принадлежит узел (для выхода - его вход)
+    int splitInNode(int node) const { return splitIn.empty() ? node : splitIn[node]; }
+    // Дуга вход -> выход расщепленной станции (ее пропускная способность - ограничение станции)
+    bool isStationArc(int index) const
+    {
+        const Arc &a = arcs[index];
+        return a.forward && a.pipeId < 0 && !splitIn.empty() && a.head != a.tail &&
+               splitIn[a.head] == a.tail;
+    }
+
+    // Ручное построение: узлы, пары дуг, затем finalize()
+    void clear();
+    int addNode(int stationId);
+    void addArcPair(int fromNode, int toNode, int pipeId, double capacity, double length);
+    void finalize();
+
+    int getNodeCount() const { return static_cast<int>(stationIds.size()); }
+    int getArcCount() const { return static_cast<int>(arcs.size()); }
+    int getPipeCount() const { return static_cast<int>(arcByPipe.size()); }
+
+    // Узел станции или -1
+    int nodeOf(int stationId) const;
+    int stationAt(int node) const { return stationIds[node]; }
+
+    int arcBegin(int node) const { return firstArc[node]; }
+    int arcEnd(int node) const { return firstArc[node + 1]; }
+    const Arc &arc(int index) const { return arcs[index]; }
+
+    // Прямая дуга трубы или -1
+    int arcOfPipe(int pipeId) const;
+
+    // Нет ли циклов по прямым дугам (как Graph::hasCycle); для ацикличного графа -
+    // топологический порядок узлов и позиция узла в нем
+    bool isAcyclic() const { return acyclic; }
+    int topologicalNode(int position) const { return topologicalOrder[position]; }
+    int topologicalIndex(int node) const { return topologicalPosition[node]; }
+};
+
+#endif
@@ -0,0 +1,321 @@
+#include "FrontierBfs.h"
+#include "TaskScheduler.h"
+#include <algorithm>
+#include <limits>
+
+using namespace std;
+
+namespace
+{
+    // Труба дуги проходима (трубы в ремонте имеют length = INF, т.е. max double)
+    bool passable(const FlatGraph &graph, const FlatGraph::Arc &arc, bool workingOnly)
+    {
+        const FlatGraph::Arc &pipe = arc.forward ? arc : graph.arc(arc.reverse);
+        return !workingOnly || pipe.length < numeric_limits<double>::max();
+    }
+
+    // Сверху вниз: по дуге можно перейти из узла в arc.head
+    bool leadsOut(const FlatGraph &graph, const FlatGraph::Arc &arc, const FrontierBfs::Options &options)
+    {
+        return (arc.forward || options.direction == FrontierBfs::Direction::Both) &&
+               passable(graph, arc, options.workingOnly);
+    }
+
+    // Снизу вверх: по дуге можно прийти в узел из arc.head
+    bool leadsIn(const FlatGraph &graph, const FlatGraph::Arc &arc, const FrontierBfs::Options &options)
+    {
+        return (!arc.forward || options.direction == FrontierBfs::Direction::Both) &&
+               passable(graph, arc, options.workingOnly);
+    }
+
+    size_t degree(const FlatGraph &graph, int node)
+    {
+        return static_cast<size_t>(graph.arcEnd(node) - graph.arcBegin(node));
+    }
+}
+
+void FrontierBfs::prepare(const FlatGraph &graph)
+{
+    nodeCount = graph.getNodeCount();
+    words = (static_cast<size_t>(nodeCount) + 63) / 64;
+
+    // Буферы прошлых обходов входят в пик временной памяти замера
+    using Scope = MemoryTracker::ScratchScope;
+    size_t nodes = static_cast<size_t>(nodeCount);
+    Scope::reuse(reusedScope,
+                 Scope::reusedBytes(levels, nodes) + Scope::reusedBytes(components, nodes) +
+                     Scope::reusedBytes(visited, words) + Scope::reusedBytes(frontierBits, words) +
+                     Scope::reusedBytes(nextBits, words) + Scope::reusedBytes(frontier, nodes) +
+                     Scope::reusedBytes(next, nodes));
+
+    levels.assign(nodeCount, -1);
+    components.assign(nodeCount, -1);
+    if (visited.size() != words)
+    {
+        // atomic не перемещается - буфер другого размера создается заново
+        ScratchVector<atomic<uint64_t>> fresh(words);
+        visited.swap(fresh);
+    }
+    for (atomic<uint64_t> &word : visited)
+    {
+        word.store(0, memory_order_relaxed);
+    }
+    frontierBits.assign(words, 0);
+    nextBits.assign(words, 0);
+    frontier.clear();
+    next.clear();
+
+    currentLabel = 0;
+    visitedCount = 0;
+    levelCount = 0;
+    remainingArcs = static_cast<size_t>(graph.getArcCount());
+    topDownSteps = 0;
+    bottomUpSteps = 0;
+}
+
+bool FrontierBfs::claim(int node, bool concurrent)
+{
+    uint64_t mask = uint64_t(1) << (node & 63);
+    atomic<uint64_t> &word = visited[node >> 6];
+    if (concurrent)
+    {
+        return (word.fetch_or(mask, memory_order_relaxed) & mask) == 0;
+    }
+    uint64_t old = word.load(memory_order_relaxed);
+    if (old & mask)
+    {
+        return false;
+    }
+    word.store(old | mask, memory_order_relaxed);
+    return true;
+}
+
+void FrontierBfs::run(const FlatGraph &graph, int sourceNode, const Options &options)
+{
+    run(graph, vector<int>{sourceNode}, options);
+}
+
+void FrontierBfs::run(const FlatGraph &graph, const vector<int> &sourceNodes, const Options &options)
+{
+    static const MemoryTracker::ScratchTag scratchTag("FrontierBfs::run");
+    MemoryTracker::ScratchScope scratch(scratchTag);
+
+    prepare(graph);
+    for (int source : sourceNodes)
+    {
+        if (source >= 0 && source < nodeCount && claim(source, false))
+        {
+            levels[source] = 0;
+            components[source] = currentLabel;
+            frontier.push_back(source);
+        }
+    }
+    sweep(graph, options);
+}
+
+int FrontierBfs::labelComponents(const FlatGraph &graph, bool workingOnly, bool parallel)
+{
+    static const MemoryTracker::ScratchTag scratchTag("FrontierBfs::labelComponents");
+    MemoryTracker::ScratchScope scratch(scratchTag);
+
+    Options options;
+    options.direction = Direction::Both;
+    options.workingOnly = workingOnly;
+    options.parallel = parallel;
+
+    prepare(graph);
+    for (int root = 0; root < nodeCount; root++)
+    {
+        if (!claim(root, false))
+            continue;
+
+        levels[root] = 0;
+        components[root] = currentLabel;
+        frontier.clear();
+        frontier.push_back(root);
+        sweep(graph, options);
+        currentLabel++;
+    }
+    return currentLabel;
+}
+
+void FrontierBfs::sweep(const FlatGraph &graph, const Options &options)
+{
+    size_t frontierSize = frontier.size();
+    size_t frontierArcs = 0;
+    for (int node : frontier)
+    {
+        frontierArcs += degree(graph, node);
+    }
+    visitedCount += static_cast<int>(frontierSize);
+    remainingArcs -= min(remainingArcs, frontierArcs);
+
+    bool bottomUp = false;
+    int level = 0;
+    while (frontierSize > 0)
+    {
+        levelCount = max(levelCount, level + 1);
+
+        if (!bottomUp && frontierArcs > remainingArcs / ALPHA)
+        {
+            // Фронт "тяжелый": дальше дешевле искать родителей непосещенным узлам
+            bottomUp = true;
+            fill(frontierBits.begin(), frontierBits.end(), 0);
+            for (int node : frontier)
+            {
+                frontierBits[node >> 6] |= uint64_t(1) << (node & 63);
+            }
+        }
+        else if (bottomUp && frontierSize < static_cast<size_t>(nodeCount / BETA))
+        {
+            bottomUp = false;
+            frontier.clear();
+            for (size_t w = 0; w < words; w++)
+            {
+                for (uint64_t bits = frontierBits[w]; bits != 0; bits &= bits - 1)
+                {
+                    frontier.push_back(static_cast<int>(w * 64 + __builtin_ctzll(bits)));
+                }
+            }
+        }
+
+        level++;
+        if (bottomUp)
+        {
+            stepBottomUp(graph, options, level, frontierSize, frontierArcs);
+        }
+        else
+        {
+            stepTopDown(graph, options, level, frontierArcs);
+            frontierSize = frontier.size();
+        }
+        visitedCount += static_cast<int>(frontierSize);
+        remainingArcs -= min(remainingArcs, frontierArcs);
+    }
+}
+
+void FrontierBfs::stepTopDown(const FlatGraph &graph, const Options &options, int level, size_t &frontierArcs)
+{
+    TaskScheduler &scheduler = TaskScheduler::instance();
+    size_t size = frontier.size();
+    bool concurrent = options.parallel && scheduler.getWorkerCount() > 0 && size >= PARALLEL_THRESHOLD;
+
+    // Обход части фронта [begin, end): новые узлы - в out
+    auto expand = [&](size_t begin, size_t end, ScratchVector<int> &out, bool atomicClaim)
+    {
+        size_t arcsOut = 0;
+        for (size_t i = begin; i < end; i++)
+        {
+            int u = frontier[i];
+            for (int a = graph.arcBegin(u); a < graph.arcEnd(u); a++)
+            {
+                const FlatGraph::Arc &arc = graph.arc(a);
+                if (leadsOut(graph, arc, options) && claim(arc.head, atomicClaim))
+                {
+                    levels[arc.head] = level;
+                    components[arc.head] = currentLabel;
+                    out.push_back(arc.head);
+                    arcsOut += degree(graph, arc.head);
+                }
+            }
+        }
+        return arcsOut;
+    };
+
+    next.clear();
+    if (!concurrent)
+    {
+        frontierArcs = expand(0, size, next, false);
+    }
+    else
+    {
+        size_t grain = max<size_t>(1024, size / (scheduler.getWorkerCount() * 4));
+        size_t blocks = (size + grain - 1) / grain;
+        if (blockNext.size() < blocks)
+        {
+            blockNext.resize(blocks);
+        }
+
+        atomic<size_t> arcsOut{0};
+        scheduler.parallelForRange(0, size, grain, [&](size_t begin, size_t end)
+                                   {
+                                       ScratchVector<int> &out = blockNext[begin / grain];
+                                       out.clear();
+                                       arcsOut.fetch_add(expand(begin, end, out, true), memory_order_relaxed); });
+
+        // Склейка в порядке блоков: следующий фронт не зависит от планирования
+        for (size_t b = 0; b < blocks; b++)
+        {
+            next.insert(next.end(), blockNext[b].begin(), blockNext[b].end());
+        }
+        frontierArcs = arcsOut.load();
+    }
+
+    frontier.swap(next);
+    topDownSteps++;
+}
+
+void FrontierBfs::stepBottomUp(const FlatGraph &graph, const Options &options, int level,
+                               size_t &frontierSize, size_t &frontierArcs)
+{
+    TaskScheduler &scheduler = TaskScheduler::instance();
+    bool concurrent = options.parallel && scheduler.getWorkerCount() > 0 &&
+                      static_cast<size_t>(nodeCount) >= PARALLEL_THRESHOLD;
+
+    fill(nextBits.begin(), nextBits.end(), 0);
+    uint64_t lastWordMask = nodeCount % 64 == 0 ? ~uint64_t(0) : (uint64_t(1) << (nodeCount % 64)) - 1;
+
+    atomic<size_t> found{0};
+    atomic<size_t> foundArcs{0};
+
+    // Слова маски [begin, end) обрабатываются одним потоком: запись только в свои слова
+    auto scan = [&](size_t begin, size_t end)
+    {
+        size_t localFound = 0;
+        size_t localArcs = 0;
+        for (size_t w = begin; w < end; w++)
+        {
+            uint64_t before = visited[w].load(memory_order_relaxed);
+            uint64_t candidates = ~before & (w + 1 == words ? lastWordMask : ~uint64_t(0));
+            uint64_t added = 0;
+            for (; candidates != 0; candidates &= candidates - 1)
+            {
+                int v = static_cast<int>(w * 64 + __builtin_ctzll(candidates));
+                for (int a = graph.arcBegin(v); a < graph.arcEnd(v); a++)
+                {
+                    const FlatGraph::Arc &arc = graph.arc(a);
+                    if (((frontierBits[arc.head >> 6] >> (arc.head & 63)) & 1) && leadsIn(graph, arc, options))
+                    {
+                        levels[v] = level;
+                        components[v] = currentLabel;
+                        added |= uint64_t(1) << (v & 63);
+                        localFound++;
+                        localArcs += degree(graph, v);
+                        break;
+                    }
+                }
+            }
+            if (added)
+            {
+                visited[w].store(before | added, memory_order_relaxed);
+                nextBits[w] = added;
+            }
+        }
+        found.fetch_add(localFound, memory_order_relaxed);
+        foundArcs.fetch_add(localArcs, memory_order_relaxed);
+    };
+
+    if (concurrent)
+    {
+        scheduler.parallelForRange(0, words, 64, scan);
+    }
+    else
+    {
+        scan(0, words);
+    }
+
+    frontierBits.swap(nextBits);
+    frontierSize = found.load();
+    frontierArcs = foundArcs.load();
+    bottomUpSteps++;
+}
@@ -0,0 +1,86 @@
+#ifndef FRONTIER_BFS_H
+#define FRONTIER_BFS_H
+
+#include "FlatGraph.h"
+#include "MemoryTracker.h"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Обход в ширину по плоскому графу с фронтом в виде списка или битовой маски
+// с переключением направления (Beamer): пока фронт мал - "сверху вниз"
+// (из фронта по исходящим дугам), когда дуг фронта становится больше, чем
+// неисследованных дуг / ALPHA - "снизу вверх" (каждый непосещенный узел ищет
+// родителя во фронте и останавливается на первом). Обратно - когда во фронте
+// меньше n / BETA узлов.
+// Параллельный вариант: шаг сверху вниз делит фронт на блоки (узлы захватываются
+// атомарно в битовой маске посещенных), шаг снизу вверх - слова маски.
+// Уровни узлов не зависят от числа потоков.
+// Объект хранит буферы между обходами; один объект - на один поток.
+class FrontierBfs
+{
+public:
+    static constexpr int ALPHA = 14;
+    static constexpr int BETA = 24;
+    static constexpr size_t PARALLEL_THRESHOLD = 4096; // меньший фронт обходится в одном потоке
+
+    enum class Direction
+    {
+        Forward, // по направлению труб
+        Both     // без учета направления (связность)
+    };
+
+    struct Options
+    {
+        Direction direction = Direction::Forward;
+        bool workingOnly = true; // трубы в ремонте (length = INF) не проходимы
+        bool parallel = false;
+    };
+
+private:
+    int nodeCount = 0;
+    size_t words = 0;
+
+    ScratchVector<int> levels;         // уровень узла в текущем обходе, -1 - не достигнут
+    ScratchVector<int> components;     // метка обхода (компоненты), в котором узел посещен
+    ScratchVector<std::atomic<uint64_t>> visited;
+    ScratchVector<uint64_t> frontierBits;
+    ScratchVector<uint64_t> nextBits;
+    ScratchVector<int> frontier;
+    ScratchVector<int> next;
+    std::vector<ScratchVector<int>> blockNext; // частичные фронты параллельного шага
+    uint64_t reusedScope = 0;                  // замер временной памяти, в котором буферы уже учтены
+
+    int currentLabel = 0;
+    int visitedCount = 0;
+    int levelCount = 0;
+    size_t remainingArcs = 0; // дуги еще не посещенных узлов
+    size_t topDownSteps = 0;
+    size_t bottomUpSteps = 0;
+
+    void prepare(const FlatGraph &graph);
+    bool claim(int node, bool concurrent);
+    // Обход от уже захваченных узлов frontier без сброса посещенных
+    void sweep(const FlatGraph &graph, const Options &options);
+    void stepTopDown(const FlatGraph &graph, const Options &options, int level, size_t &frontierArcs);
+    void stepBottomUp(const FlatGraph &graph, const Options &options, int level,
+                      size_t &frontierSize, size_t &frontierArcs);
+
+public:
+    void run(const FlatGraph &graph, int sourceNode, const Options &options);
+    void run(const FlatGraph &graph, const std::vector<int> &sourceNodes, const Options &options);
+
+    // Компоненты связности без учета направления труб; возвращает их число.
+    // Метка узла - component(node), номера компонент идут по наименьшему узлу.
+    int labelComponents(const FlatGraph &graph, bool workingOnly, bool parallel = false);
+
+    int level(int node) const { return levels[node]; }
+    bool isVisited(int node) const { return levels[node] >= 0; }
+    int component(int node) const { return components[node]; }
+    int getVisitedCount() const { return visitedCount; }
+    int getLevelCount() const { return levelCount; }
+    size_t getTopDownSteps() const { return topDownSteps; }
+    size_t getBottomUpSteps() const { return bottomUpSteps; }
+};
+
+#endif
@@ -1,13 +1,113 @@
 #include "GasNetwork.h"
 #include "utils.h"
+#include "TaskScheduler.h"
+#include "ContingencyAnalyzer.h"
+#include "ReliabilityAnalyzer.h"
+#include "SensitivityAnalyzer.h"
+#include "KShortestPaths.h"
+#include "TopologicalLayers.h"
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <chrono>
 
 using namespace std;
 
+GasNetwork::GasNetwork()
+{
+    currentSnapshot = make_shared<const NetworkSnapshot>(
+        0,
+        make_shared<const PipelineNetwork>(pipelineNetwork),
+        make_shared<const Graph>(networkGraph));
+}
+
+shared_ptr<const NetworkSnapshot> GasNetwork::snapshot() const
+{
+    return atomic_load(&currentSnapshot);
+}
+
+void GasNetwork::publishSnapshot(bool pipesChanged, bool topologyChanged)
+{
+    // Вызывается только писателем под writerMutex.
+    // Неизмененные части разделяются с предыдущей версией без копирования, а копия
+    // измененной - O(1): трубы, станции и смежность лежат во фрагментах PersistentMap,
+    // и следующая правка живой копии скопирует только свои фрагменты.
+    shared_ptr<const NetworkSnapshot> previous = atomic_load(&currentSnapshot);
+
+    shared_ptr<const PipelineNetwork> pipesPart = pipesChanged
+                                                      ? make_shared<const PipelineNetwork>(pipelineNetwork)
+                                                      : previous->sharePipelineNetwork();
+    shared_ptr<const Graph> graphPart = topologyChanged
+                                            ? make_shared<const Graph>(networkGraph)
+                                            : previous->shareGraph();
+
+    uint64_t version = versionCounter.load() + 1;
+    atomic_store(&currentSnapshot,
+                 shared_ptr<const NetworkSnapshot>(make_shared<const NetworkSnapshot>(version, pipesPart, graphPart)));
+    versionCounter.store(version);
+}
+
+void GasNetwork::addPipe()
+{
+    lock_guard<mutex> lock(writerMutex);
+    pipelineNetwork.addPipe();
+    publishSnapshot(true, false);
+}
+
+void GasNetwork::addStation()
+{
+    lock_guard<mutex> lock(writerMutex);
+    pipelineNetwork.addStation();
+    publishSnapshot(true, false);
+}
+
+void GasNetwork::editPipe(int id)
+{
+    lock_guard<mutex> lock(writerMutex);
+    pipelineNetwork.editPipe(id);
+    publishSnapshot(true, false);
+}
+
+void GasNetwork::editStation(int id)
+{
+    lock_guard<mutex> lock(writerMutex);
+    pipelineNetwork.editStation(id);
+    publishSnapshot(true, false);
+}
+
+void GasNetwork::batchEditPipes(const vector<int> &pipeIds)
+{
+    lock_guard<mutex> lock(writerMutex);
+    pipelineNetwork.batchEditPipes(pipeIds);
+    publishSnapshot(true, false);
+}
+
+void GasNetwork::deletePipe(int id)
+{
+    lock_guard<mutex> lock(writerMutex);
+    pipelineNetwork.deletePipe(id);
+    publishSnapshot(true, false);
+}
+
+void GasNetwork::loadFromFile(const std::string &filename)
+{
+    lock_guard<mutex> lock(writerMutex);
+    pipelineNetwork.loadFromFile(filename);
+    publishSnapshot(true, false);
+}
+
+void GasNetwork::replaceNetwork(PipelineNetwork objects, Graph topology)
+{
+    lock_guard<mutex> lock(writerMutex);
+    pipelineNetwork = move(objects);
+    networkGraph = move(topology);
+    publishSnapshot(true, true);
+}
+
 bool GasNetwork::connectStations(int fromStation, int toStation, int diameter, int pipeId)
 {
+    lock_guard<mutex> lock(writerMutex);
+
     // Проверяем валидность диаметра
     if (diameter != 500 && diameter != 700 && diameter != 1000 && diameter != 1400)
     {
@@ -73,11 +173,30 @@ bool GasNetwork::connectStations(int fromStation, int toStation, int diameter, i
         return false;
     }
 
+    // Соединение, по которому газ вернется к станции-источнику, образует цикл
+    shared_ptr<const ReachabilityIndex> index = atomic_load(&reachability);
+    bool indexed = index && index->isBuiltFrom(networkGraph);
+    bool closesCycle = indexed ? index->reaches(toStation, fromStation)
+                               : networkGraph.reaches(toStation, fromStation);
+
     // Всё проверено, создаем соединение
     pipelineNetwork.markPipeAsConnected(pipeId, true);
 
+    uint64_t previousVersion = networkGraph.getVersion();
     if (networkGraph.addConnection(fromStation, toStation, pipeId, diameter))
     {
+        if (indexed && index->usesBitsets())
+        {
+            // Копия дополняется на месте; перестройку оставляем следующему читателю
+            auto updated = make_shared<ReachabilityIndex>(*index);
+            updated->addConnection(networkGraph, fromStation, toStation, previousVersion);
+            if (updated->isBuiltFrom(networkGraph))
+            {
+                atomic_store(&reachability, shared_ptr<const ReachabilityIndex>(updated));
+            }
+        }
+        publishSnapshot(true, true);
+
         cout << "\n════════════════════════════════════════" << endl;
         cout << "✅ CONNECTION SUCCESSFUL!" << endl;
         cout << "════════════════════════════════════════" << endl;
@@ -93,17 +212,26 @@ bool GasNetwork::connectStations(int fromStation, int toStation, int diameter, i
             selectedPipe->getDiameter(),
             selectedPipe->isUnderRepair());
         cout << "Capacity:    " << capacity << " м³/час" << endl;
+        if (closesCycle)
+        {
+            cout << "⚠️  Warning: Station " << fromStation << " is downstream of Station "
+                 << toStation << " - this connection closes a cycle." << endl;
+        }
 
         cout << "════════════════════════════════════════" << endl;
         return true;
     }
 
+    // Откатываем пометку трубы, чтобы не оставить рассогласованное состояние
+    pipelineNetwork.markPipeAsConnected(pipeId, false);
     cout << "❌ Failed to create connection in graph." << endl;
     return false;
 }
 
 void GasNetwork::disconnectStations(int fromStation, int toStation)
 {
+    lock_guard<mutex> lock(writerMutex);
+
     int pipeId = networkGraph.getPipeId(fromStation, toStation);
     if (pipeId != -1)
     {
@@ -111,6 +239,7 @@ void GasNetwork::disconnectStations(int fromStation, int toStation)
         {
             // Помечаем трубу как свободную
             pipelineNetwork.markPipeAsConnected(pipeId, false);
+            publishSnapshot(true, true);
 
             cout << "\n════════════════════════════════════════" << endl;
             cout << "✅ DISCONNECTION SUCCESSFUL!" << endl;
@@ -133,40 +262,47 @@ void GasNetwork::disconnectStations(int fromStation, int toStation)
 
 void GasNetwork::displayNetwork() const
 {
+    shared_ptr<const NetworkSnapshot> pinned = snapshot();
+    const Graph &graph = pinned->getGraph();
+    const PipelineNetwork &network = pinned->getPipelineNetwork();
+
     cout << "\n════════════════════════════════════════" << endl;
     cout << "      GAS TRANSMISSION NETWORK" << endl;
     cout << "════════════════════════════════════════" << endl;
 
     // Показываем все объекты
-    pipelineNetwork.displayAllObjects();
+    network.displayAllObjects();
 
     // Показываем связи
-    networkGraph.display();
+    graph.display();
 
     // Показываем статус сети
-    displayNetworkStatus();
+    displayNetworkStatus(*pinned);
 }
 
 void GasNetwork::performTopologicalSort() const
 {
+    shared_ptr<const NetworkSnapshot> pinned = snapshot();
+    const Graph &graph = pinned->getGraph();
+    const PipelineNetwork &network = pinned->getPipelineNetwork();
     cout << "\n════════════════════════════════════════" << endl;
     cout << "        TOPOLOGICAL SORT" << endl;
     cout << "════════════════════════════════════════" << endl;
 
-    if (networkGraph.isEmpty())
+    if (graph.isEmpty())
     {
         cout << "Network is empty. No stations connected." << endl;
         return;
     }
 
-    if (networkGraph.hasCycle())
+    if (graph.hasCycle())
     {
         cout << "⚠️  Warning: Network contains cycles!" << endl;
         cout << "Topological sort may not be possible for cyclic graphs." << endl;
         cout << "--------------------------------" << endl;
     }
 
-    vector<int> sorted = networkGraph.topologicalSort();
+    vector<int> sorted = graph.topologicalSort();
 
     cout << "Topological order of stations:" << endl;
     cout << "--------------------------------" << endl;
@@ -182,7 +318,7 @@ void GasNetwork::performTopologicalSort() const
             cout << i + 1 << ". Station " << sorted[i];
 
             // Показываем информацию о станции
-            const CompressorStation *station = pipelineNetwork.getStationById(sorted[i]);
+            const CompressorStation *station = network.getStationById(sorted[i]);
             if (station)
             {
                 cout << " (" << station->getName() << ")";
@@ -195,8 +331,51 @@ void GasNetwork::performTopologicalSort() const
     cout << "Total stations in sorted order: " << sorted.size() << endl;
 }
 
+void GasNetwork::displayTopologicalLevels() const
+{
+    shared_ptr<const NetworkSnapshot> pinned = snapshot();
+    const Graph &graph = pinned->getGraph();
+    const PipelineNetwork &network = pinned->getPipelineNetwork();
+
+    cout << "\n════════════════════════════════════════" << endl;
+    cout << "    ТОПОЛОГИЧЕСКИЕ УРОВНИ (ЭТАПЫ)" << endl;
+    cout << "════════════════════════════════════════" << endl;
+
+    if (graph.isEmpty())
+    {
+        cout << "❌ В сети нет соединений!" << endl;
+        return;
+    }
+
+    const FlatGraph &flat = NetworkCalculator::cachedFlatGraph(graph, network);
+    TopologicalLayers layers;
+    layers.build(flat);
+
+    for (int level = 0; level < layers.getLevelCount(); level++)
+    {
+        cout << "Уровень " << level << " (" << layers.levelEnd(level) - layers.levelBegin(level) << "):";
+        for (int position = layers.levelBegin(level); position < layers.levelEnd(level); position++)
+        {
+            cout << " " << flat.stationAt(layers.nodeAt(position));
+        }
+        cout << endl;
+    }
+
+    cout << "────────────────────────────────────────" << endl;
+    cout << "Уровней: " << layers.getLevelCount() << endl;
+    if (layers.getUnlayeredCount() > 0)
+    {
+        cout << "⚠️  Станций на циклах и ниже них по потоку (без уровня): "
+             << layers.getUnlayeredCount() << endl;
+    }
+    cout << "════════════════════════════════════════" << endl;
+}
+
 void GasNetwork::saveNetworkToFile(const std::string &filename) const
 {
+    shared_ptr<const NetworkSnapshot> pinned = snapshot();
+    const Graph &graph = pinned->getGraph();
+    const PipelineNetwork &network = pinned->getPipelineNetwork();
     string networkFilename = filename + "_network.txt";
     ofstream file(networkFilename);
 
@@ -208,7 +387,7 @@ void GasNetwork::saveNetworkToFile(const std::string &filename) const
         file << "Connections:" << endl;
 
         // Сохраняем все соединения
-        auto connections = networkGraph.getConnectionsWithPipe();
+        auto connections = graph.getConnectionsWithPipe();
         for (const auto &conn : connections)
         {
             int fromStation = conn.first;
@@ -225,7 +404,7 @@ void GasNetwork::saveNetworkToFile(const std::string &filename) const
 
         // Сохраняем данные объектов в отдельный файл
         string dataFilename = filename + "_data.txt";
-        pipelineNetwork.saveToFile(dataFilename);
+        network.saveToFile(dataFilename);
     }
     else
     {
@@ -235,6 +414,8 @@ void GasNetwork::saveNetworkToFile(const std::string &filename) const
 
 void GasNetwork::loadNetworkFromFile(const std::string &filename)
 {
+    lock_guard<mutex> lock(writerMutex);
+
     string networkFilename = filename + "_network.txt";
     ifstream file(networkFilename);
 
@@ -246,6 +427,7 @@ void GasNetwork::loadNetworkFromFile(const std::string &filename)
 
     // Очищаем текущую сеть
     networkGraph.clear();
+    size_t loadedConnections = 0;
 
     string line;
     bool readingConnections = false;
@@ -272,15 +454,18 @@ void GasNetwork::loadNetworkFromFile(const std::string &filename)
             if (sscanf(line.c_str(), "%d %d %d", &fromStation, &toStation, &pipeId) == 3)
             {
                 // Получаем диаметр трубы
-                const Pipe *pipe = pipelineNetwork.getPipeById(pipeId);
+                Pipe *pipe = pipelineNetwork.getPipeById(pipeId);
                 int diameter = pipe ? pipe->getDiameter() : 500;
 
-                networkGraph.addConnection(fromStation, toStation, pipeId, diameter);
+                if (networkGraph.addConnection(fromStation, toStation, pipeId, diameter))
+                {
+                    loadedConnections++;
+                }
 
-                // Помечаем трубу как подключенную
+                // Помечаем трубу как подключенную (без записи в журнал на каждую трубу)
                 if (pipe)
                 {
-                    pipelineNetwork.markPipeAsConnected(pipeId, true);
+                    pipe->setIsConnected(true);
                 }
             }
         }
@@ -288,25 +473,45 @@ void GasNetwork::loadNetworkFromFile(const std::string &filename)
 
     file.close();
 
-    cout << "✅ Network structure loaded from: " << networkFilename << endl;
+    cout << "✅ Network structure loaded from: " << networkFilename
+         << " (" << loadedConnections << " connections)" << endl;
 
     // Загружаем данные объектов
     string dataFilename = filename + "_data.txt";
     pipelineNetwork.loadFromFile(dataFilename);
+
+    publishSnapshot(true, true);
 }
 
 void GasNetwork::displayNetworkStatus() const
 {
+    displayNetworkStatus(*snapshot());
+}
+
+void GasNetwork::displayNetworkStatus(const NetworkSnapshot &pinned) const
+{
+    const Graph &graph = pinned.getGraph();
+
     cout << "\n════════════════════════════════════════" << endl;
     cout << "          NETWORK STATUS" << endl;
     cout << "════════════════════════════════════════" << endl;
-    cout << "Total stations:        " << networkGraph.getVertexCount() << endl;
-    cout << "Total connections:     " << networkGraph.getEdgeCount() << endl;
-    cout << "Contains cycles:       " << (networkGraph.hasCycle() ? "Yes ⚠️" : "No ✅") << endl;
+    cout << "Total stations:        " << graph.getVertexCount() << endl;
+    cout << "Total connections:     " << graph.getEdgeCount() << endl;
+    cout << "Contains cycles:       " << (graph.hasCycle() ? "Yes ⚠️" : "No ✅") << endl;
+
+    {
+        lock_guard<mutex> lock(connectivityMutex);
+        const ConnectivityAnalyzer::Report &critical = connectivity.analyze(graph);
+        cout << "Connected components:  " << critical.components << endl;
+        cout << "Bridge pipes:          " << critical.bridges.size()
+             << (critical.bridges.empty() ? " ✅" : " ⚠️") << endl;
+        cout << "Articulation stations: " << critical.articulationStations.size()
+             << (critical.articulationStations.empty() ? " ✅" : " ⚠️") << endl;
+    }
 
-    if (!networkGraph.isEmpty())
+    if (!graph.isEmpty())
     {
-        vector<int> sorted = networkGraph.topologicalSort();
+        vector<int> sorted = graph.topologicalSort();
         cout << "Topological order:      ";
         for (size_t i = 0; i < sorted.size(); i++)
         {
@@ -319,8 +524,80 @@ void GasNetwork::displayNetworkStatus() const
     cout << "════════════════════════════════════════" << endl;
 }
 
+MemoryReport GasNetwork::memoryReport() const
+{
+    shared_ptr<const NetworkSnapshot> pinned = snapshot();
+    const Graph &graph = pinned->getGraph();
+    const PipelineNetwork &network = pinned->getPipelineNetwork();
+    MemoryReport report;
+    for (size_t i = 0; i < static_cast<size_t>(MemoryCategory::Count); i++)
+    {
+        report.categories.push_back(MemoryTracker::getStats(static_cast<MemoryCategory>(i)));
+    }
+    report.algorithms = MemoryTracker::getAlgorithmStats();
+
+    report.pipeCount = network.getPipeCount();
+    report.stationCount = network.getStationCount();
+    report.edgeCount = graph.getEdgeCount();
+    network.estimateNameBytes(report.pipeNameBytes, report.stationNameBytes);
+    return report;
+}
+
+void GasNetwork::displayMemoryReport() const
+{
+    MemoryReport report = memoryReport();
+
+    auto perObject = [](int64_t bytes, size_t count) -> string
+    {
+        return count == 0 ? "-" : to_string(bytes / static_cast<int64_t>(count)) + " B";
+    };
+
+    cout << "\n════════════════════════════════════════" << endl;
+    cout << "          MEMORY REPORT" << endl;
+    cout << "════════════════════════════════════════" << endl;
+    cout << "Subsystem    Live bytes    Live allocs   Total allocs  Peak bytes" << endl;
+    cout << "────────────────────────────────────────" << endl;
+    for (const auto &stats : report.categories)
+    {
+        cout << stats.name;
+        for (size_t pad = stats.name.size(); pad < 13; pad++)
+            cout << " ";
+        cout << stats.liveBytes << "\t" << stats.liveAllocations << "\t"
+             << stats.totalAllocations << "\t" << stats.peakBytes << endl;
+    }
+
+    const MemoryCategoryStats &pipes = report.categories[static_cast<size_t>(MemoryCategory::Pipes)];
+    const MemoryCategoryStats &stations = report.categories[static_cast<size_t>(MemoryCategory::Stations)];
+    const MemoryCategoryStats &adjacency = report.categories[static_cast<size_t>(MemoryCategory::Adjacency)];
+
+    cout << "────────────────────────────────────────" << endl;
+    cout << "Pipes: " << report.pipeCount << ", bytes per pipe: "
+         << perObject(pipes.liveBytes + report.pipeNameBytes, report.pipeCount)
+         << " (names outside SSO: " << report.pipeNameBytes << " B)" << endl;
+    cout << "Stations: " << report.stationCount << ", bytes per station: "
+         << perObject(stations.liveBytes + report.stationNameBytes, report.stationCount) << endl;
+    cout << "Edges: " << report.edgeCount << ", bytes per edge: "
+         << perObject(adjacency.liveBytes, report.edgeCount) << endl;
+
+    if (!report.algorithms.empty())
+    {
+        cout << "────────────────────────────────────────" << endl;
+        cout << "Peak scratch per algorithm run:" << endl;
+        for (const auto &algorithm : report.algorithms)
+        {
+            cout << "  " << algorithm.algorithm << ": runs " << algorithm.runs
+                 << ", last " << algorithm.lastPeakBytes << " B"
+                 << ", max " << algorithm.maxPeakBytes << " B" << endl;
+        }
+    }
+    cout << "Note: totals include versions pinned by snapshots." << endl;
+    cout << "════════════════════════════════════════" << endl;
+}
+
 void GasNetwork::deleteStation(int id)
 {
+    lock_guard<mutex> lock(writerMutex);
+
     // Удаляем все соединения с этой станцией
     auto connections = networkGraph.getConnections();
     for (const auto &conn : connections)
@@ -346,23 +623,30 @@ void GasNetwork::deleteStation(int id)
 
     // Удаляем саму станцию
     pipelineNetwork.deleteStation(id);
+
+    publishSnapshot(true, true);
 }
 
 // НОВЫЕ МЕТОДЫ ДЛЯ РАСЧЕТОВ
 
 void GasNetwork::calculateShortestPath(int sourceStation, int targetStation)
 {
+    // Расчет идет по закрепленному снимку и не блокирует редактирование сети
+    shared_ptr<const NetworkSnapshot> pinned = snapshot();
+    const Graph &graph = pinned->getGraph();
+    const PipelineNetwork &network = pinned->getPipelineNetwork();
+
     cout << "\n════════════════════════════════════════" << endl;
     cout << "    РАСЧЕТ КРАТЧАЙШЕГО ПУТИ" << endl;
     cout << "════════════════════════════════════════" << endl;
 
-    if (!stationExists(sourceStation))
+    if (!network.stationExists(sourceStation))
     {
         cout << "❌ Станция-источник " << sourceStation << " не найдена!" << endl;
         return;
     }
 
-    if (!stationExists(targetStation))
+    if (!network.stationExists(targetStation))
     {
         cout << "❌ Станция-цель " << targetStation << " не найдена!" << endl;
         return;
@@ -376,8 +660,8 @@ void GasNetwork::calculateShortestPath(int sourceStation, int targetStation)
 
     double totalDistance = 0.0;
     vector<int> path = NetworkCalculator::findShortestPath(
-        networkGraph,
-        pipelineNetwork,
+        graph,
+        network,
         sourceStation,
         targetStation,
         totalDistance);
@@ -389,7 +673,7 @@ void GasNetwork::calculateShortestPath(int sourceStation, int targetStation)
         cout << "Станция-цель: " << targetStation << endl;
         cout << "Общее расстояние: " << totalDistance << " км" << endl;
 
-        NetworkCalculator::displayPath(path, pipelineNetwork, networkGraph);
+        NetworkCalculator::displayPath(path, network, graph);
     }
     else
     {
@@ -401,17 +685,22 @@ void GasNetwork::calculateShortestPath(int sourceStation, int targetStation)
 
 void GasNetwork::calculateMaxFlow(int sourceStation, int targetStation)
 {
+    // Расчет идет по закрепленному снимку и не блокирует редактирование сети
+    shared_ptr<const NetworkSnapshot> pinned = snapshot();
+    const Graph &graph = pinned->getGraph();
+    const PipelineNetwork &network = pinned->getPipelineNetwork();
+
     cout << "\n════════════════════════════════════════" << endl;
     cout << "    РАСЧЕТ МАКСИМАЛЬНОГО ПОТОКА" << endl;
     cout << "════════════════════════════════════════" << endl;
 
-    if (!stationExists(sourceStation))
+    if (!network.stationExists(sourceStation))
     {
         cout << "❌ Станция-источник " << sourceStation << " не найдена!" << endl;
         return;
     }
 
-    if (!stationExists(targetStation))
+    if (!network.stationExists(targetStation))
     {
         cout << "❌ Станция-цель " << targetStation << " не найдена!" << endl;
         return;
@@ -423,17 +712,31 @@ void GasNetwork::calculateMaxFlow(int sourceStation, int targetStation)
         return;
     }
 
-    if (networkGraph.isEmpty())
+    if (graph.isEmpty())
     {
         cout << "❌ В сети нет соединений!" << endl;
         return;
     }
 
-    double maxFlow = NetworkCalculator::calculateMaxFlow(
-        networkGraph,
-        pipelineNetwork,
-        sourceStation,
-        targetStation);
+    MinCut cut;
+    double maxFlow = 0.0;
+    {
+        lock_guard<mutex> lock(flowStateMutex);
+        if (flowState.isValidFor(graph, sourceStation, targetStation))
+        {
+            size_t changed = flowState.refresh(network);
+            maxFlow = flowState.getFlow();
+            if (changed > 0)
+            {
+                cout << "♻️  Поток обновлен инкрементально (изменено труб и станций: " << changed << ")" << endl;
+            }
+        }
+        else
+        {
+            maxFlow = flowState.reset(graph, network, sourceStation, targetStation);
+        }
+        flowState.extractMinCut(cut);
+    }
 
     cout << "Максимальный поток от станции " << sourceStation
          << " к станции " << targetStation << ":" << endl;
@@ -446,18 +749,37 @@ void GasNetwork::calculateMaxFlow(int sourceStation, int targetStation)
 
     cout << "════════════════════════════════════════" << endl;
 
+    // Узкие места: трубы и станции минимального разреза из того же расчета
+    if (!cut.pipes.empty() || !cut.stations.empty())
+    {
+        cout << "\n🔻 УЗКИЕ МЕСТА (минимальный разрез):" << endl;
+        for (const auto &cutPipe : cut.pipes)
+        {
+            cout << "Труба ID: " << cutPipe.pipeId
+                 << " (станция " << cutPipe.fromStation << " → станция " << cutPipe.toStation << ")"
+                 << ", пропускная способность: " << cutPipe.capacity << " м³/час" << endl;
+        }
+        for (const auto &cutStation : cut.stations)
+        {
+            cout << "Станция ID: " << cutStation.stationId
+                 << " (работающие цеха), пропускная способность: " << cutStation.capacity << " м³/час" << endl;
+        }
+        cout << "Суммарная пропускная способность разреза: " << cut.capacity << " м³/час" << endl;
+        cout << "════════════════════════════════════════" << endl;
+    }
+
     // Дополнительная информация
     cout << "\n💡 ИНФОРМАЦИЯ О СЕТИ:" << endl;
-    cout << "Количество станций: " << networkGraph.getVertexCount() << endl;
-    cout << "Количество соединений: " << networkGraph.getEdgeCount() << endl;
+    cout << "Количество станций: " << graph.getVertexCount() << endl;
+    cout << "Количество соединений: " << graph.getEdgeCount() << endl;
 
     // Проверяем наличие труб в ремонте на пути
-    auto connections = networkGraph.getConnectionsWithPipe();
+    auto connections = graph.getConnectionsWithPipe();
     int pipesUnderRepair = 0;
     for (const auto &conn : connections)
     {
         int pipeId = conn.second.second;
-        const Pipe *pipe = pipelineNetwork.getPipeById(pipeId);
+        const Pipe *pipe = network.getPipeById(pipeId);
         if (pipe && pipe->isUnderRepair())
         {
             pipesUnderRepair++;
@@ -472,4 +794,1164 @@ void GasNetwork::calculateMaxFlow(int sourceStation, int targetStation)
     }
 
     cout << "════════════════════════════════════════" << endl;
-}
\ No newline at end of file
+}
+
+void GasNetwork::calculateMaxFlowMatrix()
+{
+    shared_ptr<const NetworkSnapshot> pinned = snapshot();
+    const Graph &graph = pinned->getGraph();
+    const PipelineNetwork &network = pinned->getPipelineNetwork();
+
+    cout << "\n════════════════════════════════════════" << endl;
+    cout << "    МАТРИЦА МАКСИМАЛЬНЫХ ПОТОКОВ" << endl;
+    cout << "════════════════════════════════════════" << endl;
+
+    if (graph.isEmpty())
+    {
+        cout << "❌ В сети нет соединений!" << endl;
+        return;
+    }
+
+    vector<int> stations = graph.getVertices();
+    vector<vector<double>> matrix = NetworkCalculator::calculateMaxFlowMatrix(graph, network, stations);
+
+    cout << "Потоки в м³/час (строка - источник, столбец - цель)" << endl;
+    cout << "Потоков расчета: " << TaskScheduler::instance().getWorkerCount() << endl;
+    cout << "────────────────────────────────────────" << endl;
+
+    cout << "     ";
+    for (int station : stations)
+    {
+        cout << "\t" << station;
+    }
+    cout << endl;
+
+    for (size_t i = 0; i < stations.size(); i++)
+    {
+        cout << stations[i] << ":";
+        for (size_t j = 0; j < stations.size(); j++)
+        {
+            cout << "\t";
+            if (i == j)
+                cout << "-";
+            else
+                cout << matrix[i][j];
+        }
+        cout << endl;
+    }
+    cout << "════════════════════════════════════════" << endl;
+}
+
+void GasNetwork::analyzeContingencies(int sourceStation, int targetStation, int depth)
+{
+    shared_ptr<const NetworkSnapshot> pinned = snapshot();
+    const Graph &graph = pinned->getGraph();
+    const PipelineNetwork &network = pinned->getPipelineNetwork();
+
+    cout << "\n════════════════════════════════════════" << endl;
+    cout << "    АНАЛИЗ ОТКАЗОВ N-" << (depth >= 2 ? 2 : 1) << endl;
+    cout << "════════════════════════════════════════" << endl;
+
+    if (!network.stationExists(sourceStation) || !network.stationExists(targetStation))
+    {
+        cout << "❌ Одна из указанных станций не существует!" << endl;
+        return;
+    }
+
+    if (sourceStation == targetStation)
+    {
+        cout << "❌ Станция-источник и станция-цель совпадают!" << endl;
+        return;
+    }
+
+    if (graph.isEmpty())
+    {
+        cout << "❌ В сети нет соединений!" << endl;
+        return;
+    }
+
+    // Отказы только уменьшают пропускную способность труб - достаточно расщепить
+    // станции, которые ограничивают поток уже сейчас
+    const FlatGraph &flat = NetworkCalculator::cachedStationGraph(graph, network);
+    ContingencyAnalyzer::Report report = ContingencyAnalyzer::analyze(flat, sourceStation, targetStation, depth);
+
+    cout << "Базовый поток: " << report.baseFlow << " м³/час" << endl;
+    cout << "Рассчитано сценариев: " << report.evaluatedScenarios
+         << ", без влияния (трубы без потока): " << report.skippedScenarios << endl;
+    cout << "────────────────────────────────────────" << endl;
+
+    if (report.ranking.empty())
+    {
+        cout << "Нет отказов, влияющих на поток." << endl;
+        cout << "════════════════════════════════════════" << endl;
+        return;
+    }
+
+    const size_t maxRows = 30;
+    size_t rank = 0;
+    for (const auto &outage : report.ranking)
+    {
+        if (rank == maxRows)
+        {
+            cout << "... и еще " << report.ranking.size() - maxRows << " сценариев" << endl;
+            break;
+        }
+        rank++;
+
+        cout << rank << ". ";
+        for (size_t i = 0; i < outage.pipeIds.size(); i++)
+        {
+            if (i > 0)
+                cout << " + ";
+            cout << "Труба " << outage.pipeIds[i] << " (" << outage.fromStations[i]
+                 << " → " << outage.toStations[i] << ")";
+        }
+        cout << "\n   Остаток: " << outage.remainingFlow << " м³/час"
+             << ", потеря: " << outage.lostFlow << " м³/час (" << outage.lostPercent << "%)" << endl;
+    }
+    cout << "════════════════════════════════════════" << endl;
+}
+
+void GasNetwork::simulateReliability(int sourceStation, int targetStation, long long samples, double demand)
+{
+    shared_ptr<const NetworkSnapshot> pinned = snapshot();
+    const Graph &graph = pinned->getGraph();
+    const PipelineNetwork &network = pinned->getPipelineNetwork();
+
+    cout << "\n════════════════════════════════════════" << endl;
+    cout << "    НАДЕЖНОСТЬ ПОСТАВКИ (МОНТЕ-КАРЛО)" << endl;
+    cout << "════════════════════════════════════════" << endl;
+
+    if (!network.stationExists(sourceStation) || !network.stationExists(targetStation))
+    {
+        cout << "❌ Одна из указанных станций не существует!" << endl;
+        return;
+    }
+
+    if (sourceStation == targetStation)
+    {
+        cout << "❌ Станция-источник и станция-цель совпадают!" << endl;
+        return;
+    }
+
+    if (samples <= 0)
+    {
+        cout << "❌ Число сценариев должно быть положительным!" << endl;
+        return;
+    }
+
+    if (demand < 0.0)
+    {
+        cout << "❌ Требуемая поставка не может быть отрицательной!" << endl;
+        return;
+    }
+
+    if (graph.isEmpty())
+    {
+        cout << "❌ В сети нет соединений!" << endl;
+        return;
+    }
+
+    ReliabilityAnalyzer::Settings settings;
+    settings.samples = samples;
+    settings.demand = demand;
+    const FlatGraph &flat = NetworkCalculator::cachedStationGraph(graph, network);
+    auto start = chrono::steady_clock::now();
+    ReliabilityAnalyzer::Report report = ReliabilityAnalyzer::simulate(flat, network, sourceStation, targetStation, settings);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "Базовый поток: " << report.baseFlow << " м³/час" << endl;
+    if (report.baseFlow <= NetworkCalculator::FLOW_EPSILON)
+    {
+        cout << "⚠️  Поток от источника к цели невозможен - оценивать нечего" << endl;
+        cout << "════════════════════════════════════════" << endl;
+        return;
+    }
+
+    cout << "Отказы: " << settings.failuresPerKmYear << " на км в год, восстановление "
+         << settings.repairHours << " ч" << endl;
+    cout << "Сценариев: " << report.samples << ", рассчитано потоков: " << report.evaluatedSamples
+         << ", время: " << seconds << " с" << endl;
+    cout << "Вероятность отказа труб с потоком: " << report.failureProbability * 100.0 << "%" << endl;
+    cout << "────────────────────────────────────────" << endl;
+    cout << "Ожидаемый поток: " << report.expectedFlow << " ± " << report.standardError << " м³/час ("
+         << report.expectedFlow / report.baseFlow * 100.0 << "% базового)" << endl;
+    cout << "Требуемая поставка: " << report.demand << " м³/час" << endl;
+    cout << "Средняя недопоставка: " << report.expectedUnserved << " м³/час" << endl;
+    cout << "Вероятность недопоставки: " << report.shortfallProbability * 100.0 << "%" << endl;
+    for (const ReliabilityAnalyzer::Percentile &percentile : report.percentiles)
+    {
+        cout << "   с вероятностью " << percentile.level << "% поток не выше " << percentile.flow << " м³/час" << endl;
+    }
+    cout << "════════════════════════════════════════" << endl;
+}
+
+void GasNetwork::analyzeSensitivity(int sourceStation, int targetStation, const string &exportFilename)
+{
+    shared_ptr<const NetworkSnapshot> pinned = snapshot();
+    const Graph &graph = pinned->getGraph();
+    const PipelineNetwork &network = pinned->getPipelineNetwork();
+
+    cout << "\n════════════════════════════════════════" << endl;
+    cout << "    ЧУВСТВИТЕЛЬНОСТЬ МАКСИМАЛЬНОГО ПОТОКА" << endl;
+    cout << "════════════════════════════════════════" << endl;
+
+    if (!network.stationExists(sourceStation) || !network.stationExists(targetStation))
+    {
+        cout << "❌ Одна из указанных станций не существует!" << endl;
+        return;
+    }
+
+    if (sourceStation == targetStation)
+    {
+        cout << "❌ Станция-источник и станция-цель совпадают!" << endl;
+        return;
+    }
+
+    if (graph.isEmpty())
+    {
+        cout << "❌ В сети нет соединений!" << endl;
+        return;
+    }
+
+    // Расширение трубы не должно снимать ограничение ни с одной станции
+    const FlatGraph &flat = NetworkCalculator::cachedStationGraph(graph, network, true);
+    auto start = chrono::steady_clock::now();
+    SensitivityAnalyzer::Report report = SensitivityAnalyzer::analyze(flat, network, sourceStation, targetStation);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "Базовый поток: " << report.baseFlow << " м³/час" << endl;
+    cout << "Труб в расчете: " << report.pipeCount << ", на минимальных разрезах: " << report.minCutPipes
+         << ", из них на каждом: " << report.criticalPipes << endl;
+    if (!report.limitingStations.empty())
+    {
+        cout << "⚠️  Поток ограничивают цеха станций:";
+        for (int id : report.limitingStations)
+        {
+            cout << " " << id;
+        }
+        cout << endl;
+    }
+    cout << "Время расчета: " << seconds << " с" << endl;
+    cout << "────────────────────────────────────────" << endl;
+
+    if (report.ranking.empty())
+    {
+        cout << "Нет труб, ограничивающих поток." << endl;
+    }
+
+    const size_t maxRows = 30;
+    size_t rank = 0;
+    for (const SensitivityAnalyzer::PipeSensitivity &entry : report.ranking)
+    {
+        if (rank == maxRows)
+        {
+            cout << "... и еще " << report.ranking.size() - maxRows << " труб" << endl;
+            break;
+        }
+        rank++;
+
+        cout << rank << ". Труба " << entry.pipeId << " (" << entry.fromStation << " → " << entry.toStation
+             << "), " << entry.diameter << " мм, " << entry.capacity << " м³/час" << endl;
+        if (!entry.onEveryMinCut)
+        {
+            cout << "   Расширять только вместе с другими трубами разреза (предельная ценность 0)" << endl;
+            continue;
+        }
+        cout << "   Предельная ценность: " << entry.marginalValue << " м³/час на 1 м³/час пропускной способности" << endl;
+        if (entry.upgrades.empty())
+        {
+            cout << "   Наибольший диаметр - нужна параллельная нитка" << endl;
+        }
+        for (const SensitivityAnalyzer::Upgrade &upgrade : entry.upgrades)
+        {
+            cout << "   → " << upgrade.diameter << " мм: +" << upgrade.gain << " м³/час ("
+                 << upgrade.gain * 100.0 / max(report.baseFlow, NetworkCalculator::FLOW_EPSILON) << "%)" << endl;
+        }
+    }
+
+    if (!exportFilename.empty())
+    {
+        ofstream file(exportFilename);
+        if (!file.is_open())
+        {
+            cout << "❌ Не удалось открыть файл " << exportFilename << " для записи!" << endl;
+        }
+        else
+        {
+            file << "rank,pipe_id,from_station,to_station,diameter_mm,capacity_m3h,flow_m3h,"
+                    "on_every_min_cut,marginal_value,gain_700_m3h,gain_1000_m3h,gain_1400_m3h"
+                 << endl;
+            rank = 0;
+            for (const SensitivityAnalyzer::PipeSensitivity &entry : report.ranking)
+            {
+                file << ++rank << "," << entry.pipeId << "," << entry.fromStation << "," << entry.toStation << ","
+                     << entry.diameter << "," << entry.capacity << "," << entry.flow << ","
+                     << (entry.onEveryMinCut ? 1 : 0) << "," << entry.marginalValue;
+                for (int diameter : {700, 1000, 1400})
+                {
+                    file << ",";
+                    for (const SensitivityAnalyzer::Upgrade &upgrade : entry.upgrades)
+                    {
+                        if (upgrade.diameter == diameter)
+                            file << upgrade.gain;
+                    }
+                }
+                file << endl;
+            }
+            cout << "✅ Рейтинг сохранен в " << exportFilename << endl;
+        }
+    }
+    cout << "════════════════════════════════════════" << endl;
+}
+
+void GasNetwork::calculateSupplyDemand(const map<int, double> &supply, const map<int, double> &demand)
+{
+    shared_ptr<const NetworkSnapshot> pinned = snapshot();
+    const Graph &graph = pinned->getGraph();
+    const PipelineNetwork &network = pinned->getPipelineNetwork();
+
+    cout << "\n════════════════════════════════════════" << endl;
+    cout << "    РАСПРЕДЕЛЕНИЕ ПОСТАВОК И ПОТРЕБЛЕНИЯ" << endl;
+    cout << "════════════════════════════════════════" << endl;
+
+    for (const auto &entry : supply)
+    {
+        if (!network.stationExists(entry.first))
+            cout << "⚠️  Станция-источник " << entry.first << " не найдена и пропущена" << endl;
+    }
+    for (const auto &entry : demand)
+    {
+        if (!network.stationExists(entry.first))
+            cout << "⚠️  Станция-потребитель " << entry.first << " не найдена и пропущена" << endl;
+    }
+
+    SupplyDemandResult result = NetworkCalculator::calculateSupplyDemand(graph, network, supply, demand);
+
+    if (result.supplies.empty() || result.demands.empty())
+    {
+        cout << "❌ Нужен хотя бы один источник и один потребитель с положительным объемом!" << endl;
+        return;
+    }
+
+    cout << "Суммарная поставка:    " << result.totalSupply << " м³/час" << endl;
+    cout << "Суммарная потребность: " << result.totalDemand << " м³/час" << endl;
+    cout << "Доставлено:            " << result.delivered << " м³/час" << endl;
+    cout << (result.feasible ? "✅ Все потребности покрыты" : "❌ Потребности покрыты не полностью") << endl;
+    cout << "────────────────────────────────────────" << endl;
+
+    cout << "Источники:" << endl;
+    for (const auto &balance : result.supplies)
+    {
+        cout << "  Станция " << balance.stationId << ": закачано " << balance.actual
+             << " из " << balance.required << " м³/час" << endl;
+    }
+
+    cout << "Потребители:" << endl;
+    for (const auto &balance : result.demands)
+    {
+        cout << "  Станция " << balance.stationId << ": получено " << balance.actual
+             << " из " << balance.required << " м³/час";
+        if (balance.shortfall > NetworkCalculator::FLOW_EPSILON * max(1.0, balance.required))
+        {
+            cout << ", недопоставка " << balance.shortfall;
+        }
+        cout << endl;
+    }
+    cout << "════════════════════════════════════════" << endl;
+}
+
+void GasNetwork::calculateHydraulics(const map<int, double> &sourcePressure,
+                                     const map<int, double> &demand,
+                                     HydraulicSolver::Equation equation)
+{
+    shared_ptr<const NetworkSnapshot> pinned = snapshot();
+    const Graph &graph = pinned->getGraph();
+    const PipelineNetwork &network = pinned->getPipelineNetwork();
+
+    cout << "\n════════════════════════════════════════" << endl;
+    cout << "    ГИДРАВЛИЧЕСКИЙ РАСЧЕТ" << endl;
+    cout << "════════════════════════════════════════" << endl;
+
+    map<int, double> sources;
+    for (const auto &entry : sourcePressure)
+    {
+        if (!network.stationExists(entry.first))
+            cout << "⚠️  Станция заданного давления " << entry.first << " не найдена и пропущена" << endl;
+        else if (entry.second <= 0)
+            cout << "⚠️  Давление станции " << entry.first << " должно быть положительным, станция пропущена" << endl;
+        else
+            sources[entry.first] = entry.second;
+    }
+    map<int, double> loads;
+    for (const auto &entry : demand)
+    {
+        if (!network.stationExists(entry.first))
+            cout << "⚠️  Станция-потребитель " << entry.first << " не найдена и пропущена" << endl;
+        else
+            loads[entry.first] = entry.second;
+    }
+
+    if (sources.empty())
+    {
+        cout << "❌ Нужна хотя бы одна станция с заданным давлением!" << endl;
+        return;
+    }
+
+    if (graph.isEmpty())
+    {
+        cout << "❌ В сети нет соединений!" << endl;
+        return;
+    }
+
+    HydraulicSolver::Settings settings;
+    settings.equation = equation;
+    HydraulicSolver::Result result = HydraulicSolver::solve(graph, network, sources, loads, settings);
+
+    cout << "Уравнение трубы: " << (equation == HydraulicSolver::Equation::Weymouth ? "Уэймут" : "Панхендл A") << endl;
+    cout << (result.converged ? "✅ Расчет сошелся" : "❌ Расчет не сошелся")
+         << " за " << result.iterations << " итераций (линейных: " << result.linearIterations << ")" << endl;
+    cout << "Наибольший небаланс станции: " << result.residual << " м³/час" << endl;
+    cout << "Минимальное давление: " << result.minPressure << " бар" << endl;
+    if (!result.feasible)
+    {
+        cout << "⚠️  Давление падает до нуля: сеть не пропускает заданные отборы" << endl;
+    }
+    if (!result.unresolvedStations.empty())
+    {
+        cout << "⚠️  Не связаны со станциями заданного давления: " << result.unresolvedStations.size()
+             << " станций (не рассчитаны)" << endl;
+    }
+    cout << "────────────────────────────────────────" << endl;
+
+    cout << "Станции:" << endl;
+    for (const auto &state : result.stations)
+    {
+        cout << "  Станция " << state.stationId << ": " << state.pressure << " бар";
+        if (state.outletPressure > state.pressure)
+        {
+            cout << ", на выходе " << state.outletPressure << " бар";
+        }
+        if (sources.count(state.stationId))
+        {
+            cout << ", закачка " << state.injection << " м³/час";
+        }
+        cout << endl;
+    }
+
+    cout << "Трубы:" << endl;
+    for (const auto &state : result.pipes)
+    {
+        cout << "  Труба ID: " << state.pipeId
+             << " (станция " << state.fromStation << " → станция " << state.toStation << ")"
+             << ": " << state.flow << " м³/час, " << state.inletPressure << " → " << state.outletPressure << " бар" << endl;
+    }
+    cout << "════════════════════════════════════════" << endl;
+}
+
+void GasNetwork::simulateTransient(const TransientSimulator::Scenario &scenario, double duration, double outputInterval)
+{
+    shared_ptr<const NetworkSnapshot> pinned = snapshot();
+    const Graph &graph = pinned->getGraph();
+    const PipelineNetwork &network = pinned->getPipelineNetwork();
+
+    cout << "\n════════════════════════════════════════" << endl;
+    cout << "    НЕСТАЦИОНАРНЫЙ РАСЧЕТ" << endl;
+    cout << "════════════════════════════════════════" << endl;
+
+    TransientSimulator::Scenario checked;
+    for (const auto &entry : scenario.sourcePressure)
+    {
+        if (!network.stationExists(entry.first))
+            cout << "⚠️  Станция заданного давления " << entry.first << " не найдена и пропущена" << endl;
+        else if (entry.second <= 0)
+            cout << "⚠️  Давление станции " << entry.first << " должно быть положительным, станция пропущена" << endl;
+        else
+            checked.sourcePressure[entry.first] = entry.second;
+    }
+    for (const auto &entry : scenario.demand)
+    {
+        if (!network.stationExists(entry.first))
+            cout << "⚠️  Станция-потребитель " << entry.first << " не найдена и пропущена" << endl;
+        else
+            checked.demand[entry.first] = entry.second;
+    }
+    for (const TransientSimulator::Event &event : scenario.events)
+    {
+        bool isPipeEvent = event.type == TransientSimulator::EventType::PipeRepair ||
+                           event.type == TransientSimulator::EventType::PipeReturn;
+        bool exists = isPipeEvent ? network.getPipeById(event.id) != nullptr : network.stationExists(event.id);
+        if (!exists)
+            cout << "⚠️  " << (isPipeEvent ? "Труба " : "Станция ") << event.id << " события не найдена, событие пропущено" << endl;
+        else if (event.time < 0 || event.time > duration)
+            cout << "⚠️  Событие для " << event.id << " вне интервала расчета и пропущено" << endl;
+        else
+            checked.events.push_back(event);
+    }
+    for (int id : scenario.monitoredStations)
+    {
+        if (!network.stationExists(id))
+            cout << "⚠️  Станция " << id << " не найдена и не отслеживается" << endl;
+        else
+            checked.monitoredStations.push_back(id);
+    }
+
+    if (checked.sourcePressure.empty())
+    {
+        cout << "❌ Нужна хотя бы одна станция с заданным давлением!" << endl;
+        return;
+    }
+
+    if (duration <= 0 || outputInterval <= 0)
+    {
+        cout << "❌ Длительность и интервал вывода должны быть положительными!" << endl;
+        return;
+    }
+
+    if (graph.isEmpty())
+    {
+        cout << "❌ В сети нет соединений!" << endl;
+        return;
+    }
+
+    TransientSimulator::Settings settings;
+    settings.duration = duration;
+    settings.outputInterval = outputInterval;
+    auto start = chrono::steady_clock::now();
+    TransientSimulator::Result result = TransientSimulator::simulate(graph, network, checked, settings);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    if (!result.started)
+    {
+        cout << "❌ Стационарный расчет начального состояния не сошелся или сеть не пропускает отборы!" << endl;
+        return;
+    }
+
+    cout << "Отрезков труб: " << result.segments << ", шаг " << result.timeStep << " с, шагов: " << result.steps << endl;
+    cout << "Применено событий: " << result.appliedEvents << " из " << checked.events.size() << endl;
+    if (!result.unresolvedStations.empty())
+    {
+        cout << "⚠️  Не связаны со станциями заданного давления: " << result.unresolvedStations.size()
+             << " станций (не рассчитаны)" << endl;
+    }
+    cout << "Время расчета: " << seconds << " с";
+    if (seconds > 0)
+    {
+        cout << " (в " << duration * 3600.0 / seconds << " раз быстрее реального)";
+    }
+    cout << endl;
+    cout << "────────────────────────────────────────" << endl;
+
+    cout << "Час | запас, млн м³ | закачка | отбор | недопоставка (м³/час) | мин. давление, бар";
+    for (int id : result.monitoredStations)
+    {
+        cout << " | ст. " << id;
+    }
+    cout << endl;
+    for (const TransientSimulator::Sample &sample : result.samples)
+    {
+        cout << "  " << sample.time << " | " << sample.linePack << " | " << sample.injection << " | "
+             << sample.delivered << " | " << sample.unserved << " | " << sample.minPressure;
+        for (double pressure : sample.pressures)
+        {
+            cout << " | " << pressure;
+        }
+        cout << endl;
+    }
+    cout << "════════════════════════════════════════" << endl;
+}
+
+void GasNetwork::calculateMinCostFlow(int sourceStation, int targetStation, double volume)
+{
+    shared_ptr<const NetworkSnapshot> pinned = snapshot();
+    const Graph &graph = pinned->getGraph();
+    const PipelineNetwork &network = pinned->getPipelineNetwork();
+
+    cout << "\n════════════════════════════════════════" << endl;
+    cout << "    ПОТОК МИНИМАЛЬНОЙ СТОИМОСТИ" << endl;
+    cout << "════════════════════════════════════════" << endl;
+
+    if (!network.stationExists(sourceStation) || !network.stationExists(targetStation))
+    {
+        cout << "❌ Одна из указанных станций не существует!" << endl;
+        return;
+    }
+
+    if (sourceStation == targetStation)
+    {
+        cout << "❌ Станция-источник и станция-цель совпадают!" << endl;
+        return;
+    }
+
+    if (volume <= 0.0)
+    {
+        cout << "❌ Объем должен быть положительным!" << endl;
+        return;
+    }
+
+    if (graph.isEmpty())
+    {
+        cout << "❌ В сети нет соединений!" << endl;
+        return;
+    }
+
+    MinCostFlowResult result = NetworkCalculator::calculateMinCostFlow(
+        graph, network, sourceStation, targetStation, volume);
+
+    cout << "Запрошено:  " << result.requested << " м³/час" << endl;
+    cout << "Доставлено: " << result.delivered << " м³/час" << endl;
+    if (result.requested - result.delivered > NetworkCalculator::FLOW_EPSILON * max(1.0, result.requested))
+    {
+        cout << "⚠️  Объем превышает максимальный поток, доставлен максимум" << endl;
+    }
+    cout << "Стоимость транспорта: " << result.totalCost << " м³/час·км" << endl;
+    cout << "────────────────────────────────────────" << endl;
+
+    for (const auto &pipeFlow : result.pipes)
+    {
+        cout << "Труба ID: " << pipeFlow.pipeId
+             << " (станция " << pipeFlow.fromStation << " → станция " << pipeFlow.toStation << ")"
+             << ": " << pipeFlow.flow << " м³/час, стоимость " << pipeFlow.cost << endl;
+    }
+    cout << "════════════════════════════════════════" << endl;
+}
+
+void GasNetwork::queryPairwiseMaxFlow(const vector<pair<int, int>> &pairs)
+{
+    shared_ptr<const NetworkSnapshot> pinned = snapshot();
+    const Graph &graph = pinned->getGraph();
+    const PipelineNetwork &network = pinned->getPipelineNetwork();
+
+    cout << "\n════════════════════════════════════════" << endl;
+    cout << "    МАКСИМАЛЬНЫЕ ПОТОКИ МЕЖДУ ПАРАМИ СТАНЦИЙ" << endl;
+    cout << "════════════════════════════════════════" << endl;
+
+    if (graph.isEmpty())
+    {
+        cout << "❌ В сети нет соединений!" << endl;
+        return;
+    }
+
+    lock_guard<mutex> lock(cutTreeMutex);
+    if (!cutTree.isBuiltFrom(graph, network))
+    {
+        cutTree.build(graph, network);
+        cout << "Дерево потоков построено: " << cutTree.getNodeCount() << " станций, "
+             << cutTree.getFlowComputations() << " расчетов потока" << endl;
+    }
+    cout << "Модель: трубы проводят газ в обоих направлениях" << endl;
+    cout << "────────────────────────────────────────" << endl;
+
+    for (const auto &query : pairs)
+    {
+        if (!network.stationExists(query.first) || !network.stationExists(query.second))
+        {
+            cout << "Станции " << query.first << " → " << query.second << ": ❌ станция не существует" << endl;
+            continue;
+        }
+        if (query.first == query.second)
+        {
+            cout << "Станции " << query.first << " → " << query.second << ": ❌ станции совпадают" << endl;
+            continue;
+        }
+        cout << "Станции " << query.first << " ↔ " << query.second << ": "
+             << cutTree.maxFlow(query.first, query.second) << " м³/час" << endl;
+    }
+    cout << "════════════════════════════════════════" << endl;
+}
+
+void GasNetwork::calculateWidestPath(int sourceStation, int targetStation)
+{
+    shared_ptr<const NetworkSnapshot> pinned = snapshot();
+    const Graph &graph = pinned->getGraph();
+    const PipelineNetwork &network = pinned->getPipelineNetwork();
+
+    cout << "\n════════════════════════════════════════" << endl;
+    cout << "    РАСЧЕТ САМОГО ШИРОКОГО ПУТИ" << endl;
+    cout << "════════════════════════════════════════" << endl;
+
+    if (!network.stationExists(sourceStation))
+    {
+        cout << "❌ Станция-источник " << sourceStation << " не найдена!" << endl;
+        return;
+    }
+
+    if (!network.stationExists(targetStation))
+    {
+        cout << "❌ Станция-цель " << targetStation << " не найдена!" << endl;
+        return;
+    }
+
+    if (sourceStation == targetStation)
+    {
+        cout << "❌ Станция-источник и станция-цель совпадают!" << endl;
+        return;
+    }
+
+    double bottleneck = 0.0;
+    vector<int> path = NetworkCalculator::findWidestPath(
+        graph,
+        network,
+        sourceStation,
+        targetStation,
+        bottleneck);
+
+    if (!path.empty())
+    {
+        cout << "✅ Самый широкий путь найден!" << endl;
+        cout << "Узкое место пути: " << bottleneck << " м³/час" << endl;
+
+        NetworkCalculator::displayPath(path, network, graph);
+    }
+    else
+    {
+        cout << "❌ Путь между станциями не найден!" << endl;
+    }
+
+    cout << "════════════════════════════════════════" << endl;
+}
+
+void GasNetwork::queryPairwiseBottlenecks(const vector<pair<int, int>> &pairs)
+{
+    shared_ptr<const NetworkSnapshot> pinned = snapshot();
+    const Graph &graph = pinned->getGraph();
+    const PipelineNetwork &network = pinned->getPipelineNetwork();
+
+    cout << "\n════════════════════════════════════════" << endl;
+    cout << "    ШИРИНА МАРШРУТОВ МЕЖДУ ПАРАМИ СТАНЦИЙ" << endl;
+    cout << "════════════════════════════════════════" << endl;
+
+    if (graph.isEmpty())
+    {
+        cout << "❌ В сети нет соединений!" << endl;
+        return;
+    }
+
+    lock_guard<mutex> lock(bottleneckMutex);
+    if (!bottleneckIndex.isBuiltFrom(graph, network))
+    {
+        bottleneckIndex.build(graph, network);
+    }
+    cout << "Модель: трубы проводят газ в обоих направлениях" << endl;
+    cout << "────────────────────────────────────────" << endl;
+
+    vector<int> stations;
+    vector<int> pipeIds;
+    for (const auto &query : pairs)
+    {
+        if (!network.stationExists(query.first) || !network.stationExists(query.second))
+        {
+            cout << "Станции " << query.first << " → " << query.second << ": ❌ станция не существует" << endl;
+            continue;
+        }
+        if (query.first == query.second)
+        {
+            cout << "Станции " << query.first << " → " << query.second << ": ❌ станции совпадают" << endl;
+            continue;
+        }
+        if (!bottleneckIndex.route(query.first, query.second, stations, pipeIds))
+        {
+            cout << "Станции " << query.first << " ↔ " << query.second << ": маршрута нет" << endl;
+            continue;
+        }
+
+        cout << "Станции " << query.first << " ↔ " << query.second << ": "
+             << bottleneckIndex.bottleneck(query.first, query.second) << " м³/час, маршрут: ";
+        for (size_t i = 0; i < stations.size(); i++)
+        {
+            if (i > 0)
+                cout << " → ";
+            cout << stations[i];
+        }
+        cout << endl;
+    }
+    cout << "════════════════════════════════════════" << endl;
+}
+
+void GasNetwork::calculateDisjointPaths(int sourceStation, int targetStation, int k, bool stationDisjoint)
+{
+    shared_ptr<const NetworkSnapshot> pinned = snapshot();
+    const Graph &graph = pinned->getGraph();
+    const PipelineNetwork &network = pinned->getPipelineNetwork();
+
+    cout << "\n════════════════════════════════════════" << endl;
+    cout << "    НЕЗАВИСИМЫЕ МАРШРУТЫ" << endl;
+    cout << "════════════════════════════════════════" << endl;
+
+    if (sourceStation == targetStation)
+    {
+        cout << "❌ Станция-источник и станция-цель совпадают!" << endl;
+        return;
+    }
+
+    if (k <= 0)
+    {
+        cout << "❌ Число маршрутов должно быть положительным!" << endl;
+        return;
+    }
+
+    vector<DisjointPath> paths = NetworkCalculator::findDisjointPaths(
+        graph, network, sourceStation, targetStation, k, stationDisjoint);
+
+    cout << "Независимость: " << (stationDisjoint ? "по трубам и станциям" : "по трубам") << endl;
+    cout << "Найдено маршрутов: " << paths.size() << " из " << k << endl;
+    cout << "────────────────────────────────────────" << endl;
+
+    double totalLength = 0.0;
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        const DisjointPath &path = paths[i];
+        totalLength += path.length;
+
+        cout << i + 1 << ". ";
+        for (size_t j = 0; j < path.stations.size(); j++)
+        {
+            if (j > 0)
+                cout << " → ";
+            cout << path.stations[j];
+        }
+        cout << "\n   Длина: " << path.length << " км, узкое место: " << path.bottleneck << " м³/час" << endl;
+    }
+
+    if (!paths.empty())
+    {
+        cout << "Суммарная длина: " << totalLength << " км" << endl;
+    }
+    cout << "════════════════════════════════════════" << endl;
+}
+
+void GasNetwork::auditRedundancy(int sourceStation, bool stationDisjoint)
+{
+    shared_ptr<const NetworkSnapshot> pinned = snapshot();
+    const Graph &graph = pinned->getGraph();
+    const PipelineNetwork &network = pinned->getPipelineNetwork();
+
+    cout << "\n════════════════════════════════════════" << endl;
+    cout << "    АУДИТ РЕЗЕРВИРОВАНИЯ" << endl;
+    cout << "════════════════════════════════════════" << endl;
+
+    if (!network.stationExists(sourceStation))
+    {
+        cout << "❌ Станция-источник " << sourceStation << " не найдена!" << endl;
+        return;
+    }
+
+    if (graph.isEmpty())
+    {
+        cout << "❌ В сети нет соединений!" << endl;
+        return;
+    }
+
+    // Общие графы только читаются; у каждого потока своя рабочая область.
+    // Граф единичных пропускных способностей строится один раз на весь аудит
+    const FlatGraph &flat = NetworkCalculator::cachedFlatGraph(graph, network);
+    FlatGraph unit;
+    NetworkCalculator::buildDisjointGraph(unit, flat, stationDisjoint);
+    vector<int> stations = graph.getVertices();
+    sort(stations.begin(), stations.end());
+
+    vector<int> routeCount(stations.size(), 0);
+    TaskScheduler::instance().parallelFor(0, stations.size(), 1, [&](size_t i)
+                                          {
+        if (stations[i] != sourceStation)
+        {
+            routeCount[i] = static_cast<int>(NetworkCalculator::findDisjointPaths(
+                flat, unit, NetworkCalculator::threadWorkspace(), sourceStation, stations[i], 2).size());
+        } });
+
+    size_t unreachable = 0;
+    size_t singleRoute = 0;
+    for (size_t i = 0; i < stations.size(); i++)
+    {
+        if (stations[i] == sourceStation)
+            continue;
+        if (routeCount[i] == 0)
+            unreachable++;
+        else if (routeCount[i] == 1)
+            singleRoute++;
+    }
+
+    cout << "Независимость: " << (stationDisjoint ? "по трубам и станциям" : "по трубам") << endl;
+    cout << "Станций проверено: " << (stations.empty() ? 0 : stations.size() - 1) << endl;
+    cout << "С резервом (2+ маршрута): " << stations.size() - 1 - unreachable - singleRoute << endl;
+    cout << "Недостижимы: " << unreachable << endl;
+    cout << "Без резерва (1 маршрут): " << singleRoute << endl;
+
+    if (singleRoute > 0)
+    {
+        cout << "────────────────────────────────────────" << endl;
+        cout << "Станции без резерва:";
+        for (size_t i = 0; i < stations.size(); i++)
+        {
+            if (stations[i] != sourceStation && routeCount[i] == 1)
+                cout << " " << stations[i];
+        }
+        cout << endl;
+    }
+    cout << "════════════════════════════════════════" << endl;
+}
+
+void GasNetwork::calculateAlternativeRoutes(int sourceStation, int targetStation, int k)
+{
+    shared_ptr<const NetworkSnapshot> pinned = snapshot();
+    const Graph &graph = pinned->getGraph();
+    const PipelineNetwork &network = pinned->getPipelineNetwork();
+
+    cout << "\n════════════════════════════════════════" << endl;
+    cout << "    АЛЬТЕРНАТИВНЫЕ МАРШРУТЫ" << endl;
+    cout << "════════════════════════════════════════" << endl;
+
+    if (!network.stationExists(sourceStation) || !network.stationExists(targetStation))
+    {
+        cout << "❌ Одна из указанных станций не существует!" << endl;
+        return;
+    }
+
+    if (sourceStation == targetStation)
+    {
+        cout << "❌ Станция-источник и станция-цель совпадают!" << endl;
+        return;
+    }
+
+    if (k <= 0)
+    {
+        cout << "❌ Число маршрутов должно быть положительным!" << endl;
+        return;
+    }
+
+    if (graph.isEmpty())
+    {
+        cout << "❌ В сети нет соединений!" << endl;
+        return;
+    }
+
+    const FlatGraph &flat = NetworkCalculator::cachedFlatGraph(graph, network);
+    vector<KShortestPaths::Route> routes = KShortestPaths::find(flat, sourceStation, targetStation, k);
+
+    if (routes.empty())
+    {
+        cout << "❌ Путь между станциями не найден!" << endl;
+        cout << "════════════════════════════════════════" << endl;
+        return;
+    }
+
+    cout << "Найдено маршрутов: " << routes.size() << " из " << k << endl;
+    cout << "────────────────────────────────────────" << endl;
+    for (size_t i = 0; i < routes.size(); i++)
+    {
+        const KShortestPaths::Route &route = routes[i];
+        cout << i + 1 << ". ";
+        for (size_t j = 0; j < route.stations.size(); j++)
+        {
+            if (j > 0)
+                cout << " → ";
+            cout << route.stations[j];
+        }
+        cout << "\n   Длина: " << route.length << " км, узкое место: " << route.bottleneck << " м³/час" << endl;
+    }
+    cout << "════════════════════════════════════════" << endl;
+}
+
+void GasNetwork::calculateLongestPath(int sourceStation, int targetStation)
+{
+    shared_ptr<const NetworkSnapshot> pinned = snapshot();
+    const Graph &graph = pinned->getGraph();
+    const PipelineNetwork &network = pinned->getPipelineNetwork();
+
+    cout << "\n════════════════════════════════════════" << endl;
+    cout << "    КРИТИЧЕСКАЯ ЦЕПОЧКА ТРАНСПОРТА" << endl;
+    cout << "════════════════════════════════════════" << endl;
+
+    if (sourceStation == targetStation)
+    {
+        cout << "❌ Станция-источник и станция-цель совпадают!" << endl;
+        return;
+    }
+
+    double totalDistance = 0.0;
+    vector<int> path = NetworkCalculator::findLongestPath(
+        graph,
+        network,
+        sourceStation,
+        targetStation,
+        totalDistance);
+
+    if (!path.empty())
+    {
+        cout << "✅ Самый длинный путь найден!" << endl;
+        cout << "Общее расстояние: " << totalDistance << " км" << endl;
+
+        NetworkCalculator::displayPath(path, network, graph);
+    }
+
+    cout << "════════════════════════════════════════" << endl;
+}
+
+void GasNetwork::displayReachableStations(int sourceStation)
+{
+    shared_ptr<const NetworkSnapshot> pinned = snapshot();
+    const Graph &graph = pinned->getGraph();
+    const PipelineNetwork &network = pinned->getPipelineNetwork();
+
+    cout << "\n════════════════════════════════════════" << endl;
+    cout << "    ДОСТИЖИМЫЕ СТАНЦИИ" << endl;
+    cout << "════════════════════════════════════════" << endl;
+
+    vector<int> stations = NetworkCalculator::findReachableStations(graph, network, sourceStation);
+    if (stations.empty())
+    {
+        return;
+    }
+
+    cout << "Из станции " << sourceStation << " газ может попасть на "
+         << stations.size() - 1 << " станций:" << endl;
+    for (int station : stations)
+    {
+        if (station != sourceStation)
+            cout << " " << station;
+    }
+    cout << endl;
+    cout << "════════════════════════════════════════" << endl;
+}
+
+void GasNetwork::displayCriticalElements() const
+{
+    shared_ptr<const NetworkSnapshot> pinned = snapshot();
+    const Graph &graph = pinned->getGraph();
+
+    cout << "\n════════════════════════════════════════" << endl;
+    cout << "    КРИТИЧЕСКИЕ ЭЛЕМЕНТЫ СЕТИ" << endl;
+    cout << "════════════════════════════════════════" << endl;
+
+    if (graph.isEmpty())
+    {
+        cout << "❌ В сети нет соединений!" << endl;
+        return;
+    }
+
+    lock_guard<mutex> lock(connectivityMutex);
+    const ConnectivityAnalyzer::Report &report = connectivity.analyze(graph);
+
+    cout << "Компонент связности: " << report.components << endl;
+    cout << "────────────────────────────────────────" << endl;
+
+    cout << "Трубы-мосты (отказ разделяет сеть): " << report.bridges.size() << endl;
+    for (const auto &bridge : report.bridges)
+    {
+        cout << "  Труба ID: " << bridge.pipeId
+             << " (станция " << bridge.fromStation << " → станция " << bridge.toStation << ")" << endl;
+    }
+
+    cout << "Станции - точки сочленения (отказ разделяет сеть): " << report.articulationStations.size() << endl;
+    if (!report.articulationStations.empty())
+    {
+        cout << " ";
+        for (int station : report.articulationStations)
+        {
+            cout << " " << station;
+        }
+        cout << endl;
+    }
+    cout << "════════════════════════════════════════" << endl;
+}
+
+void GasNetwork::analyzeDominators(int sourceStation, int station)
+{
+    shared_ptr<const NetworkSnapshot> pinned = snapshot();
+    const Graph &graph = pinned->getGraph();
+    const PipelineNetwork &network = pinned->getPipelineNetwork();
+
+    cout << "\n════════════════════════════════════════" << endl;
+    cout << "    ОБЯЗАТЕЛЬНЫЕ СТАНЦИИ И ПОСЛЕДСТВИЯ ОТКАЗА" << endl;
+    cout << "════════════════════════════════════════" << endl;
+
+    if (!network.stationExists(sourceStation) || !network.stationExists(station))
+    {
+        cout << "❌ Одна из указанных станций не существует!" << endl;
+        return;
+    }
+
+    lock_guard<mutex> lock(dominatorMutex);
+    if (!dominatorTree.isBuiltFrom(graph, network, sourceStation))
+    {
+        dominatorTree.build(graph, network, sourceStation);
+    }
+
+    if (!dominatorTree.isReachable(station))
+    {
+        cout << "❌ Станция " << station << " не получает газ от станции " << sourceStation << "!" << endl;
+        return;
+    }
+
+    if (station != sourceStation)
+    {
+        vector<int> dominators = dominatorTree.dominatorsOf(station);
+        cout << "Любой путь " << sourceStation << " → " << station << " проходит через:";
+        for (int dominator : dominators)
+        {
+            cout << " " << dominator;
+        }
+        cout << endl;
+    }
+
+    vector<int> cutOff = dominatorTree.cutOffBy(station);
+    cout << "При отказе станции " << station << " без газа остаются: " << cutOff.size() << " станций" << endl;
+    if (!cutOff.empty())
+    {
+        cout << " ";
+        for (int lost : cutOff)
+        {
+            cout << " " << lost;
+        }
+        cout << endl;
+    }
+    cout << "════════════════════════════════════════" << endl;
+}
+
+shared_ptr<const ReachabilityIndex> GasNetwork::reachabilityFor(const Graph &graph)
+{
+    shared_ptr<const ReachabilityIndex> cached = atomic_load(&reachability);
+    if (cached && cached->isBuiltFrom(graph))
+    {
+        return cached;
+    }
+
+    // Строится вне каких-либо блокировок: писатель и другие читатели не ждут
+    shared_ptr<const ReachabilityIndex> built = [&graph]()
+    {
+        auto index = make_shared<ReachabilityIndex>();
+        index->build(graph);
+        return index;
+    }();
+
+    // В кэш - только индекс последней версии и только если его не заменили, пока он строился
+    if (built->isBuiltFrom(snapshot()->getGraph()))
+    {
+        atomic_compare_exchange_strong(&reachability, &cached, built);
+    }
+    return built;
+}
+
+void GasNetwork::checkDownstream(int upstream, int downstream)
+{
+    shared_ptr<const NetworkSnapshot> pinned = snapshot();
+    const Graph &graph = pinned->getGraph();
+    const PipelineNetwork &network = pinned->getPipelineNetwork();
+
+    if (!network.stationExists(upstream) || !network.stationExists(downstream))
+    {
+        cout << "❌ Одна из указанных станций не существует!" << endl;
+        return;
+    }
+
+    bool reachable = reachabilityFor(graph)->reaches(upstream, downstream);
+
+    if (reachable)
+    {
+        cout << "✅ Станция " << downstream << " находится ниже по потоку от станции " << upstream << endl;
+    }
+    else
+    {
+        cout << "❌ Газ от станции " << upstream << " не может попасть на станцию " << downstream << endl;
+    }
+}
@@ -4,8 +4,21 @@
 #include "PipelineNetwork.h"
 #include "Graph.h"
 #include "NetworkCalculator.h"
+#include "NetworkSnapshot.h"
+#include "IncrementalMaxFlow.h"
+#include "GomoryHuTree.h"
+#include "BottleneckIndex.h"
+#include "ConnectivityAnalyzer.h"
+#include "DominatorTree.h"
+#include "ReachabilityIndex.h"
+#include "HydraulicSolver.h"
+#include "TransientSimulator.h"
 #include <vector>
+#include <map>
 #include <string>
+#include <memory>
+#include <mutex>
+#include <atomic>
 
 class GasNetwork
 {
@@ -13,38 +26,144 @@ private:
     PipelineNetwork pipelineNetwork;
     Graph networkGraph;
 
+    // Модель параллелизма: один писатель (writerMutex) изменяет рабочую копию
+    // и атомарно публикует новый снимок; читатели берут снимок без блокировок
+    mutable std::mutex writerMutex;
+    std::shared_ptr<const NetworkSnapshot> currentSnapshot;
+    std::atomic<uint64_t> versionCounter{0};
+
+    // Отчет о состоянии по уже закрепленному снимку (displayNetwork показывает одну версию)
+    void displayNetworkStatus(const NetworkSnapshot &pinned) const;
+    void publishSnapshot(bool pipesChanged, bool topologyChanged);
+
+    // Поток последнего запроса calculateMaxFlow: повторный запрос той же пары
+    // после изменения труб (без изменения топологии) пересчитывается инкрементально
+    std::mutex flowStateMutex;
+    IncrementalMaxFlow flowState;
+
+    // Дерево эквивалентных потоков последней версии сети (строится при первом запросе)
+    std::mutex cutTreeMutex;
+    GomoryHuTree cutTree;
+
+    // Предрасчет ширины маршрутов для всех пар (строится при первом запросе)
+    std::mutex bottleneckMutex;
+    BottleneckIndex bottleneckIndex;
+
+    // Мосты и точки сочленения, кэш по версии графа (используется и в отчете о состоянии)
+    mutable std::mutex connectivityMutex;
+    mutable ConnectivityAnalyzer connectivity;
+
+    // Дерево доминаторов последнего запрошенного источника
+    std::mutex dominatorMutex;
+    DominatorTree dominatorTree;
+
+    // Индекс достижимости последней опубликованной топологии. Читатели строят его
+    // по графу закрепленного снимка без блокировок и публикуют атомарно, как снимки;
+    // писатель только дополняет копию в connectStations и никогда не ждет построения
+    // (при устаревшем индексе проверка цикла - обходом графа)
+    std::shared_ptr<const ReachabilityIndex> reachability;
+    std::shared_ptr<const ReachabilityIndex> reachabilityFor(const Graph &graph);
+
 public:
-    GasNetwork() = default;
+    GasNetwork();
 
-    PipelineNetwork &getPipelineNetwork() { return pipelineNetwork; }
-    Graph &getGraph() { return networkGraph; }
+    // Части последнего опубликованного снимка (изменения - только через методы GasNetwork)
+    std::shared_ptr<const PipelineNetwork> getPipelineNetwork() const { return snapshot()->sharePipelineNetwork(); }
+    std::shared_ptr<const Graph> getGraph() const { return snapshot()->shareGraph(); }
+
+    // Снимок последней опубликованной версии для аналитических запросов
+    std::shared_ptr<const NetworkSnapshot> snapshot() const;
+    uint64_t getVersion() const { return versionCounter.load(); }
 
     bool connectStations(int fromStation, int toStation, int diameter, int pipeId = -1);
     void disconnectStations(int fromStation, int toStation);
     void displayNetwork() const;
     void performTopologicalSort() const;
+    // Топологические уровни (этапы): станции одного уровня не зависят друг от друга
+    void displayTopologicalLevels() const;
     void saveNetworkToFile(const std::string &filename) const;
     void loadNetworkFromFile(const std::string &filename);
+
+    // Заменить сеть целиком (импорт, генератор тестовых сетей) и опубликовать снимок
+    void replaceNetwork(PipelineNetwork objects, Graph topology);
     void displayNetworkStatus() const;
+    // Трубы и станции, потеря которых разделяет сеть
+    void displayCriticalElements() const;
+    // Через какие станции обязательно идет газ от источника к station
+    // и какие станции отрезаны при ее отказе
+    void analyzeDominators(int sourceStation, int station);
+
+    // Учет памяти по подсистемам (трубы, станции, смежность, индексы, буферы алгоритмов).
+    // Байты - по всему процессу, включая закрепленные читателями снимки.
+    MemoryReport memoryReport() const;
+    void displayMemoryReport() const;
 
     // НОВЫЕ МЕТОДЫ ДЛЯ РАСЧЕТОВ
     void calculateShortestPath(int sourceStation, int targetStation);
+    // Критическая (самая длинная) цепочка транспорта в сети без циклов
+    void calculateLongestPath(int sourceStation, int targetStation);
+    // Находится ли станция downstream ниже по потоку от upstream (по направлению труб)
+    void checkDownstream(int upstream, int downstream);
+    // Станции, куда газ может попасть из данной
+    void displayReachableStations(int sourceStation);
+    // k кратчайших альтернативных маршрутов (без повторения станций)
+    void calculateAlternativeRoutes(int sourceStation, int targetStation, int k);
+    // Маршрут с наибольшей минимальной пропускной способностью трубы
+    void calculateWidestPath(int sourceStation, int targetStation);
+    // k независимых маршрутов (без общих труб, по желанию - без общих станций)
+    void calculateDisjointPaths(int sourceStation, int targetStation, int k, bool stationDisjoint);
+    // Аудит резервирования: число независимых маршрутов от источника до каждой станции
+    void auditRedundancy(int sourceStation, bool stationDisjoint);
+    // Ширина маршрутов для многих пар по предрасчитанному лесу (неориентированная модель)
+    void queryPairwiseBottlenecks(const std::vector<std::pair<int, int>> &pairs);
     void calculateMaxFlow(int sourceStation, int targetStation);
+    void calculateMaxFlowMatrix();
+
+    // Максимальные потоки для многих пар станций по дереву эквивалентных потоков
+    // (неориентированная модель: трубы проводят газ в обе стороны)
+    void queryPairwiseMaxFlow(const std::vector<std::pair<int, int>> &pairs);
+
+    // Доставка объема (м³/час) источник -> сток с минимальной стоимостью транспорта
+    void calculateMinCostFlow(int sourceStation, int targetStation, double volume);
+
+    // Распределение от нескольких источников к нескольким потребителям (м³/час по станциям)
+    void calculateSupplyDemand(const std::map<int, double> &supply, const std::map<int, double> &demand);
+
+    // Стационарные давления и потоки: станции заданного давления (бар) и отборы (м³/час)
+    void calculateHydraulics(const std::map<int, double> &sourcePressure,
+                             const std::map<int, double> &demand,
+                             HydraulicSolver::Equation equation);
+
+    // Нестационарный расчет сценария (отключения компрессоров, ремонты труб, смена отборов)
+    // от стационарного режима: временной ряд давлений и запаса газа
+    void simulateTransient(const TransientSimulator::Scenario &scenario, double duration, double outputInterval);
+
+    // Анализ отказов N-1 / N-2: рейтинг труб по потере потока источник -> сток
+    void analyzeContingencies(int sourceStation, int targetStation, int depth);
+
+    // Надежность поставки источник -> сток при случайных отказах труб (Монте-Карло):
+    // ожидаемый поток, недопоставка относительно demand (0 - базовый поток), квантили
+    void simulateReliability(int sourceStation, int targetStation, long long samples, double demand);
+
+    // Чувствительность максимального потока к трубам: трубы минимальных разрезов,
+    // прирост потока от замены диаметра; рейтинг, при exportFilename - в CSV
+    void analyzeSensitivity(int sourceStation, int targetStation, const std::string &exportFilename);
 
-    // Методы-обертки для PipelineNetwork
-    void addPipe() { pipelineNetwork.addPipe(); }
-    void addStation() { pipelineNetwork.addStation(); }
-    void displayAllObjects() const { pipelineNetwork.displayAllObjects(); }
-    void editPipe(int id) { pipelineNetwork.editPipe(id); }
-    void editStation(int id) { pipelineNetwork.editStation(id); }
-    void deletePipe(int id) { pipelineNetwork.deletePipe(id); }
+    // Методы-обертки для PipelineNetwork (изменяющие публикуют новый снимок, читающие - по снимку)
+    void addPipe();
+    void addStation();
+    void displayAllObjects() const { snapshot()->getPipelineNetwork().displayAllObjects(); }
+    void editPipe(int id);
+    void editStation(int id);
+    void batchEditPipes(const std::vector<int> &pipeIds);
+    void deletePipe(int id);
     void deleteStation(int id);
-    void saveToFile(const std::string &filename) const { pipelineNetwork.saveToFile(filename); }
-    void loadFromFile(const std::string &filename) { pipelineNetwork.loadFromFile(filename); }
+    void saveToFile(const std::string &filename) const { snapshot()->getPipelineNetwork().saveToFile(filename); }
+    void loadFromFile(const std::string &filename);
 
     // Новые методы для работы с сетью
-    bool stationExists(int id) const { return pipelineNetwork.stationExists(id); }
-    void displayStations() const { pipelineNetwork.displayStations(); }
+    bool stationExists(int id) const { return snapshot()->getPipelineNetwork().stationExists(id); }
+    void displayStations() const { snapshot()->getPipelineNetwork().displayStations(); }
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,113 @@
+#include "GomoryHuTree.h"
+#include "NetworkCalculator.h"
+#include "TaskScheduler.h"
+#include <algorithm>
+#include <deque>
+#include <limits>
+
+using namespace std;
+
+void GomoryHuTree::build(const Graph &graph, const PipelineNetwork &network)
+{
+    static const MemoryTracker::ScratchTag scratchTag("GomoryHuTree::build");
+    MemoryTracker::ScratchScope scratch(scratchTag);
+
+    flat.buildUndirected(graph, network);
+    int n = flat.getNodeCount();
+
+    parent.assign(n, 0);
+    parentFlow.assign(n, 0.0);
+    flowComputations = 0;
+
+    // Гасфилд: шаг s считает поток s -> parent[s] и переподвешивает к s узлы i > s
+    // с тем же родителем, оказавшиеся на стороне s. Шаги зависят друг от друга
+    // только через parent, поэтому окно следующих шагов считается параллельно
+    // с текущими родителями, а применяется по порядку. Результат шага годен,
+    // пока его родитель не изменился; иначе шаг пересчитывается в следующем окне.
+    TaskScheduler &scheduler = TaskScheduler::instance();
+    size_t window = max<size_t>(1, scheduler.getWorkerCount() * 2);
+
+    struct Step
+    {
+        int target = -1; // родитель, с которым посчитан шаг (-1 - не посчитан)
+        double flow = 0.0;
+        vector<int> sourceSide;
+    };
+    deque<Step> steps; // steps[i] - шаг next + i
+    vector<int> stale;
+
+    int next = 1;
+    while (next < n)
+    {
+        size_t count = min<size_t>(window, static_cast<size_t>(n - next));
+        steps.resize(count);
+
+        stale.clear();
+        for (size_t index = 0; index < count; index++)
+        {
+            if (steps[index].target != parent[next + index])
+                stale.push_back(static_cast<int>(index));
+        }
+
+        scheduler.parallelFor(0, stale.size(), 1, [&](size_t i)
+                              {
+            int s = next + stale[i];
+            Step &step = steps[stale[i]];
+            step.target = parent[s];
+
+            CalculationWorkspace &workspace = NetworkCalculator::threadWorkspace();
+            workspace.prepare(flat);
+            step.flow = NetworkCalculator::augmentFlow(
+                flat, workspace, s, step.target, numeric_limits<double>::max());
+
+            // Сторона s минимального разреза - узлы последнего (неудачного) поиска пути
+            step.sourceSide.clear();
+            for (int v = s + 1; v < n; v++)
+            {
+                if (workspace.isTouched(v))
+                    step.sourceSide.push_back(v);
+            } });
+        flowComputations += stale.size();
+
+        while (!steps.empty() && steps.front().target == parent[next])
+        {
+            const Step &step = steps.front();
+            parentFlow[next] = step.flow;
+            for (int v : step.sourceSide)
+            {
+                if (parent[v] == step.target)
+                    parent[v] = next;
+            }
+            steps.pop_front();
+            next++;
+        }
+    }
+
+    // Корень дерева - узел 0
+    if (n > 0)
+    {
+        parent[0] = -1;
+    }
+    lookup.build(parent, parentFlow);
+
+    graphVersion = graph.getVersion();
+    networkVersion = network.getVersion();
+    built = true;
+}
+
+bool GomoryHuTree::isBuiltFrom(const Graph &graph, const PipelineNetwork &network) const
+{
+    return built && graphVersion == graph.getVersion() && networkVersion == network.getVersion();
+}
+
+double GomoryHuTree::maxFlow(int stationA, int stationB) const
+{
+    int a = flat.nodeOf(stationA);
+    int b = flat.nodeOf(stationB);
+    if (!built || a < 0 || b < 0 || a == b)
+    {
+        return 0.0;
+    }
+
+    return lookup.pathMinimum(a, b);
+}
@@ -0,0 +1,41 @@
+#ifndef GOMORY_HU_TREE_H
+#define GOMORY_HU_TREE_H
+
+#include "FlatGraph.h"
+#include "MemoryTracker.h"
+#include "TreePathIndex.h"
+#include <cstdint>
+#include <vector>
+
+// Дерево эквивалентных потоков (алгоритм Гасфилда) для неориентированного
+// представления сети: трубы проводят газ в обе стороны с одинаковой пропускной
+// способностью. Строится n-1 расчетами максимального потока один раз на версию сети;
+// максимальный поток (= минимальный разрез) между любыми двумя станциями - минимум
+// веса ребер на пути между ними в дереве, O(log n) на запрос.
+class GomoryHuTree
+{
+private:
+    FlatGraph flat;
+    IndexVector<int> parent;        // родитель узла в дереве (parent[v] < v, корень - узел 0)
+    IndexVector<double> parentFlow; // максимальный поток между v и parent[v]
+    TreePathIndex lookup;
+
+    uint64_t graphVersion = 0;
+    uint64_t networkVersion = 0;
+    bool built = false;
+    size_t flowComputations = 0;
+
+public:
+    // Построить дерево; расчеты потоков идут параллельно в пуле TaskScheduler
+    void build(const Graph &graph, const PipelineNetwork &network);
+    bool isBuiltFrom(const Graph &graph, const PipelineNetwork &network) const;
+
+    // Максимальный поток между станциями (0, если станции нет в сети соединений)
+    double maxFlow(int stationA, int stationB) const;
+
+    int getNodeCount() const { return flat.getNodeCount(); }
+    // Выполнено расчетов потока (n-1 плюс повторы отброшенных спекулятивных расчетов)
+    size_t getFlowComputations() const { return flowComputations; }
+};
+
+#endif
@@ -3,9 +3,12 @@
 #include <queue>
 #include <algorithm>
 #include <stack>
+#include <unordered_set>
 
 using namespace std;
 
+atomic<uint64_t> Graph::nextVersion{1};
+
 Graph::Graph()
 {
     adjacencyList.clear();
@@ -21,7 +24,8 @@ bool Graph::addConnection(int fromStation, int toStation, int pipeId, int diamet
     }
 
     // Проверяем, нет ли уже соединения
-    if (adjacencyList[fromStation].find(toStation) != adjacencyList[fromStation].end())
+    const EdgeMap *existing = adjacencyList.find(fromStation);
+    if (existing && existing->find(toStation) != existing->end())
     {
         cout << "Error: Connection already exists between stations "
              << fromStation << " and " << toStation << "!" << endl;
@@ -33,28 +37,32 @@ bool Graph::addConnection(int fromStation, int toStation, int pipeId, int diamet
     edge.diameter = diameter;
     edge.isAvailable = true;
 
-    adjacencyList[fromStation][toStation] = edge;
-    vertexIds.insert(fromStation);
-    vertexIds.insert(toStation);
+    EdgeMap *edges = adjacencyList.findMutable(fromStation);
+    if (!edges)
+    {
+        edges = &adjacencyList.set(fromStation, EdgeMap());
+    }
+    (*edges)[toStation] = edge;
+    vertexIds.set(fromStation, 1);
+    vertexIds.set(toStation, 1);
+    touch();
 
     return true;
 }
 
 bool Graph::removeConnection(int fromStation, int toStation)
 {
-    auto fromIt = adjacencyList.find(fromStation);
-    if (fromIt != adjacencyList.end())
+    const EdgeMap *existing = adjacencyList.find(fromStation);
+    if (existing && existing->find(toStation) != existing->end())
     {
-        auto toIt = fromIt->second.find(toStation);
-        if (toIt != fromIt->second.end())
+        EdgeMap *edges = adjacencyList.findMutable(fromStation);
+        edges->erase(toStation);
+        if (edges->empty())
         {
-            fromIt->second.erase(toIt);
-            if (fromIt->second.empty())
-            {
-                adjacencyList.erase(fromIt);
-            }
-            return true;
+            adjacencyList.erase(fromStation);
         }
+        touch();
+        return true;
     }
     return false;
 }
@@ -70,9 +78,9 @@ vector<int> Graph::topologicalSort() const
 
     // Вычисляем входящие степени
     map<int, int> inDegree;
-    for (int vertex : vertexIds)
+    for (const auto &vertex : vertexIds)
     {
-        inDegree[vertex] = 0;
+        inDegree[vertex.first] = 0;
     }
 
     for (const auto &fromPair : adjacencyList)
@@ -100,10 +108,10 @@ vector<int> Graph::topologicalSort() const
         zeroInDegreeQueue.pop();
         result.push_back(vertex);
 
-        auto it = adjacencyList.find(vertex);
-        if (it != adjacencyList.end())
+        const EdgeMap *edges = adjacencyList.find(vertex);
+        if (edges)
         {
-            for (const auto &neighbor : it->second)
+            for (const auto &neighbor : *edges)
             {
                 inDegree[neighbor.first]--;
                 if (inDegree[neighbor.first] == 0)
@@ -117,12 +125,12 @@ vector<int> Graph::topologicalSort() const
     // Проверка на цикл
     if (result.size() != vertexIds.size())
     {
-        // Добавляем оставшиеся вершины
-        for (int vertex : vertexIds)
+        // Добавляем оставшиеся вершины (у них осталась ненулевая входящая степень)
+        for (const auto &vertex : vertexIds)
         {
-            if (find(result.begin(), result.end(), vertex) == result.end())
+            if (inDegree[vertex.first] > 0)
             {
-                result.push_back(vertex);
+                result.push_back(vertex.first);
             }
         }
     }
@@ -164,42 +172,63 @@ void Graph::display() const
 
 bool Graph::dfsCycleCheck(int vertex, map<int, int> &visited) const
 {
+    // Итеративный DFS с явным стеком: рекурсия переполняет стек на длинных магистралях
+    using NeighborIterator = EdgeMap::const_iterator;
+    static const EdgeMap noNeighbors;
+
+    auto neighborsOf = [this](int v) -> const EdgeMap &
+    {
+        const EdgeMap *edges = adjacencyList.find(v);
+        return edges ? *edges : noNeighbors;
+    };
+
+    vector<pair<int, NeighborIterator>> stack;
     visited[vertex] = 1; // Посещаем вершину
+    stack.push_back({vertex, neighborsOf(vertex).begin()});
 
-    auto it = adjacencyList.find(vertex);
-    if (it != adjacencyList.end())
+    while (!stack.empty())
     {
-        for (const auto &neighbor : it->second)
+        int current = stack.back().first;
+        NeighborIterator &next = stack.back().second;
+
+        if (next == neighborsOf(current).end())
         {
-            if (visited[neighbor.first] == 0)
-            {
-                if (dfsCycleCheck(neighbor.first, visited))
-                    return true;
-            }
-            else if (visited[neighbor.first] == 1)
-            {
-                return true; // Найден цикл
-            }
+            visited[current] = 2; // Завершаем обработку
+            stack.pop_back();
+            continue;
+        }
+
+        int neighbor = next->first;
+        ++next;
+
+        int &state = visited[neighbor];
+        if (state == 0)
+        {
+            state = 1;
+            stack.push_back({neighbor, neighborsOf(neighbor).begin()});
+        }
+        else if (state == 1)
+        {
+            return true; // Найден цикл
         }
     }
 
-    visited[vertex] = 2; // Завершаем обработку
     return false;
 }
 
 bool Graph::hasCycle() const
 {
     map<int, int> visited;
-    for (int vertex : vertexIds)
+    for (const auto &vertex : vertexIds)
     {
-        visited[vertex] = 0;
+        visited[vertex.first] = 0;
     }
 
-    for (int vertex : vertexIds)
+    for (const auto &vertex : vertexIds)
     {
-        if (visited[vertex] == 0)
+        if (visited[vertex.first] == 0)
         {
-            if (dfsCycleCheck(vertex, visited))
+            if (dfsCycleCheck(vertex.first, visited))
                 return true;
         }
     }
@@ -207,14 +236,51 @@ bool Graph::hasCycle() const
     return false;
 }
 
+bool Graph::reaches(int fromStation, int toStation) const
+{
+    if (fromStation == toStation)
+    {
+        return true;
+    }
+
+    // Обход в глубину с остановкой на искомой станции
+    unordered_set<int> visited{fromStation};
+    vector<int> stack{fromStation};
+    while (!stack.empty())
+    {
+        const EdgeMap *edges = adjacencyList.find(stack.back());
+        stack.pop_back();
+        if (!edges)
+        {
+            continue;
+        }
+        for (const auto &neighbor : *edges)
+        {
+            if (neighbor.first == toStation)
+            {
+                return true;
+            }
+            if (visited.insert(neighbor.first).second)
+            {
+                stack.push_back(neighbor.first);
+            }
+        }
+    }
+    return false;
+}
+
 bool Graph::vertexExists(int stationId) const
 {
-    return vertexIds.find(stationId) != vertexIds.end();
+    return vertexIds.contains(stationId);
 }
 
 void Graph::addVertex(int stationId)
 {
-    vertexIds.insert(stationId);
+    if (!vertexIds.contains(stationId))
+    {
+        vertexIds.set(stationId, 1);
+        touch();
+    }
 }
 
 void Graph::removeVertex(int stationId)
@@ -222,23 +288,37 @@ void Graph::removeVertex(int stationId)
     // Удаляем все исходящие связи
     adjacencyList.erase(stationId);
 
-    // Удаляем все входящие связи
-    for (auto &fromPair : adjacencyList)
+    // Удаляем все входящие связи; отделяются от снимков только списки, где они есть
+    vector<int> sources;
+    for (const auto &fromPair : adjacencyList)
     {
-        fromPair.second.erase(stationId);
+        if (fromPair.second.find(stationId) != fromPair.second.end())
+        {
+            sources.push_back(fromPair.first);
+        }
+    }
+    for (int source : sources)
+    {
+        EdgeMap *edges = adjacencyList.findMutable(source);
+        edges->erase(stationId);
+        if (edges->empty())
+        {
+            adjacencyList.erase(source);
+        }
     }
 
     // Удаляем вершину
     vertexIds.erase(stationId);
+    touch();
 }
 
 int Graph::getPipeId(int fromStation, int toStation) const
 {
-    auto fromIt = adjacencyList.find(fromStation);
-    if (fromIt != adjacencyList.end())
+    const EdgeMap *edges = adjacencyList.find(fromStation);
+    if (edges)
     {
-        auto toIt = fromIt->second.find(toStation);
-        if (toIt != fromIt->second.end())
+        auto toIt = edges->find(toStation);
+        if (toIt != edges->end())
         {
             return toIt->second.pipeId;
         }
@@ -246,6 +326,17 @@ int Graph::getPipeId(int fromStation, int toStation) const
     return -1;
 }
 
+vector<int> Graph::getVertices() const
+{
+    vector<int> vertices;
+    vertices.reserve(vertexIds.size());
+    for (const auto &vertex : vertexIds)
+    {
+        vertices.push_back(vertex.first);
+    }
+    return vertices;
+}
+
 vector<pair<int, int>> Graph::getConnections() const
 {
     vector<pair<int, int>> connections;
@@ -276,6 +367,7 @@ void Graph::clear()
 {
     adjacencyList.clear();
     vertexIds.clear();
+    touch();
 }
 
 bool Graph::isEmpty() const
@@ -3,9 +3,12 @@
 
 #include <vector>
 #include <map>
-#include <set>
 #include <string>
 #include <iostream>
+#include <atomic>
+#include <cstdint>
+#include "MemoryTracker.h"
+#include "PersistentMap.h"
 
 class Graph
 {
@@ -18,8 +21,20 @@ private:
         bool isAvailable;
     };
 
-    std::map<int, std::map<int, Edge>> adjacencyList; // from -> (to -> Edge)
-    std::set<int> vertexIds;                          // все вершины (станции)
+    using EdgeMap = std::map<int, Edge, std::less<int>,
+                             TrackingAllocator<std::pair<const int, Edge>, MemoryCategory::Adjacency>>;
+    // Копия графа (снимок) разделяет с оригиналом списки смежности, кроме измененных после копирования
+    using AdjacencyMap = PersistentMap<EdgeMap, MemoryCategory::Adjacency>;
+    using VertexSet = PersistentMap<char, MemoryCategory::Indexes>; // значения не используются
+
+    AdjacencyMap adjacencyList; // from -> (to -> Edge)
+    VertexSet vertexIds;        // все вершины (станции)
+
+    // Версия топологии: уникальна среди всех графов процесса и меняется при каждом
+    // изменении, поэтому по паре (адрес, версия) можно кэшировать производные структуры
+    static std::atomic<uint64_t> nextVersion;
+    uint64_t version = nextVersion.fetch_add(1);
+    void touch() { version = nextVersion.fetch_add(1); }
 
     bool dfsCycleCheck(int vertex, std::map<int, int> &visited) const;
 
@@ -31,16 +46,20 @@ public:
     std::vector<int> topologicalSort() const;
     void display() const;
     bool hasCycle() const;
+    // Достижима ли станция to из from по направлению соединений (обход без индекса)
+    bool reaches(int fromStation, int toStation) const;
     bool vertexExists(int stationId) const;
     void addVertex(int stationId);
     void removeVertex(int stationId);
     int getPipeId(int fromStation, int toStation) const;
+    std::vector<int> getVertices() const;
     std::vector<std::pair<int, int>> getConnections() const;
     std::vector<std::pair<int, std::pair<int, int>>> getConnectionsWithPipe() const;
     void clear();
     bool isEmpty() const;
     size_t getVertexCount() const;
     size_t getEdgeCount() const;
+    uint64_t getVersion() const { return version; }
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,887 @@
+#include "HydraulicSolver.h"
+#include "NetworkCalculator.h"
+#include "TaskScheduler.h"
+#include "MemoryTracker.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace
+{
+    constexpr double BASE_TEMPERATURE = 288.15; // К
+    constexpr double BASE_PRESSURE = 101.325;   // кПа
+    constexpr double KPA_PER_BAR = 100.0;
+    constexpr size_t GRAIN = 4096;
+
+    constexpr int LINEAR_MAX_ITERATIONS = 1000;
+    constexpr double LINEAR_TOLERANCE = 1e-10;
+    constexpr size_t FILL_LIMIT = 8; // связей графа исключения на элемент матрицы для точного LU
+    constexpr int REFACTOR_ITERATIONS = 8; // дольше - разложение прошлой итерации Ньютона устарело
+    constexpr double INITIAL_FLOW_SHARE = 1e-3;
+
+    // Разреженная матрица в CSR; столбцы строки отсортированы
+    struct SparseMatrix
+    {
+        ScratchVector<int> rowStart;
+        ScratchVector<int> column;
+        ScratchVector<int> diagonal; // позиция диагонального элемента строки
+        ScratchVector<double> value;
+
+        int rows() const { return static_cast<int>(rowStart.size()) - 1; }
+
+        void multiply(const ScratchVector<double> &x, ScratchVector<double> &y) const
+        {
+            TaskScheduler::instance().parallelFor(0, rows(), GRAIN, [&](size_t i)
+                                                  {
+                                                      double sum = 0.0;
+                                                      for (int p = rowStart[i]; p < rowStart[i + 1]; p++)
+                                                          sum += value[p] * x[column[p]];
+                                                      y[i] = sum; });
+        }
+    };
+
+    // Скалярное произведение по блокам фиксированного размера: сумма не зависит от числа потоков
+    double dot(const ScratchVector<double> &a, const ScratchVector<double> &b)
+    {
+        size_t blockCount = (a.size() + GRAIN - 1) / GRAIN;
+        ScratchVector<double> partial(blockCount, 0.0);
+        TaskScheduler::instance().parallelFor(0, blockCount, 1, [&](size_t block)
+                                              {
+                                                  size_t end = min(a.size(), (block + 1) * GRAIN);
+                                                  double sum = 0.0;
+                                                  for (size_t i = block * GRAIN; i < end; i++)
+                                                      sum += a[i] * b[i];
+                                                  partial[block] = sum; });
+        double sum = 0.0;
+        for (double value : partial)
+            sum += value;
+        return sum;
+    }
+
+    // Строки, сгруппированные по уровням зависимости треугольного решения:
+    // строки одного уровня решаются независимо (параллельно)
+    struct LevelSchedule
+    {
+        ScratchVector<int> levelStart;
+        ScratchVector<int> rowOrder;
+
+        template <typename Body>
+        void run(Body body) const
+        {
+            TaskScheduler &scheduler = TaskScheduler::instance();
+            for (size_t level = 0; level + 1 < levelStart.size(); level++)
+            {
+                int begin = levelStart[level];
+                int end = levelStart[level + 1];
+                if (end - begin >= static_cast<int>(GRAIN))
+                {
+                    scheduler.parallelFor(begin, end, GRAIN, [&](size_t k)
+                                          { body(rowOrder[k]); });
+                }
+                else
+                {
+                    for (int k = begin; k < end; k++)
+                        body(rowOrder[k]);
+                }
+            }
+        }
+    };
+
+    // Прямое LU-разложение без перестановок строк в порядке минимальной степени.
+    // Матрица по давлениям структурно симметрична и имеет диагональное преобладание
+    // по столбцам (приток в трубу равен оттоку из нее), поэтому исключение без выбора
+    // ведущего элемента устойчиво, а образец L совпадает с образцом U^T. Порядок и образец
+    // строятся один раз (между итерациями Ньютона меняются только значения); строка k
+    // разложения - решение треугольных систем по поддереву строки в дереве исключения.
+    // Прямой и обратный ход параллельны по уровням дерева исключения.
+    // Если граф исключения разрастается больше FILL_LIMIT (у безмасштабной сети ядро
+    // из хабов заполняется почти целиком), разложение неполное - LU(0) в исходном порядке строк.
+    class SparseLU
+    {
+    private:
+        ScratchVector<int> order;       // строка матрицы на шаге k
+        ScratchVector<int> stepOf;      // обратная перестановка
+        ScratchVector<int> transposeOf; // позиция элемента (j, i) для элемента (i, j)
+        // Образец L по строкам (столбцы j < k, от потомков к предкам дерева исключения)
+        // и по столбцам (строки i > j по возрастанию); rowSlot - позиция элемента строки в столбце
+        ScratchVector<int> rowStart, rowColumn, rowSlot;
+        ScratchVector<int> columnStart, columnRow;
+        ScratchVector<double> lower, upper; // L(i, j) и U(j, i) в позиции столбца j
+        ScratchVector<double> pivot;
+        LevelSchedule forwardLevels, backwardLevels;
+        mutable ScratchVector<double> work;
+        bool complete = false; // точное разложение, иначе заполнение отброшено
+
+        // Исключение на графе образца: каждый раз - станция наименьшей степени,
+        // ее соседи становятся попарно связанными. false - заполнение больше FILL_LIMIT
+        static bool minimumDegree(const SparseMatrix &matrix, ScratchVector<int> &order)
+        {
+            int n = matrix.rows();
+            vector<ScratchVector<int>> adjacent(n);
+            for (int i = 0; i < n; i++)
+            {
+                for (int p = matrix.rowStart[i]; p < matrix.rowStart[i + 1]; p++)
+                {
+                    if (matrix.column[p] != i)
+                        adjacent[i].push_back(matrix.column[p]);
+                }
+            }
+
+            // Корзины по степени: двусвязные списки
+            ScratchVector<int> head(n + 1, -1), next(n, -1), previous(n, -1), degree(n);
+            auto insert = [&](int v)
+            {
+                int d = degree[v];
+                previous[v] = -1;
+                next[v] = head[d];
+                if (head[d] >= 0)
+                    previous[head[d]] = v;
+                head[d] = v;
+            };
+            auto remove = [&](int v)
+            {
+                if (previous[v] >= 0)
+                    next[previous[v]] = next[v];
+                else
+                    head[degree[v]] = next[v];
+                if (next[v] >= 0)
+                    previous[next[v]] = previous[v];
+            };
+            for (int v = n - 1; v >= 0; v--)
+            {
+                degree[v] = static_cast<int>(adjacent[v].size());
+                insert(v);
+            }
+
+            ScratchVector<int> mark(n, -1);
+            int stamp = 0;
+            size_t links = matrix.column.size() - n, linkLimit = FILL_LIMIT * matrix.column.size();
+            order.clear();
+            order.reserve(n);
+            int minimum = 0;
+            for (int step = 0; step < n; step++)
+            {
+                while (head[minimum] < 0)
+                    minimum++;
+                int v = head[minimum];
+                remove(v);
+                order.push_back(v);
+
+                ScratchVector<int> neighbors;
+                neighbors.swap(adjacent[v]);
+                links -= 2 * neighbors.size();
+                for (int u : neighbors)
+                {
+                    ScratchVector<int> &list = adjacent[u];
+                    list.erase(find(list.begin(), list.end(), v));
+                }
+                for (int u : neighbors)
+                {
+                    ScratchVector<int> &list = adjacent[u];
+                    stamp++;
+                    mark[u] = stamp;
+                    for (int w : list)
+                        mark[w] = stamp;
+                    for (int w : neighbors)
+                    {
+                        if (mark[w] != stamp)
+                        {
+                            list.push_back(w);
+                            links++;
+                        }
+                    }
+                    remove(u);
+                    degree[u] = static_cast<int>(list.size());
+                    insert(u);
+                    minimum = min(minimum, degree[u]);
+                }
+                if (links > linkLimit)
+                    return false;
+            }
+            return true;
+        }
+
+        // Уровни строк для параллельного треугольного решения
+        static void buildSchedule(const ScratchVector<int> &level, LevelSchedule &schedule)
+        {
+            int n = static_cast<int>(level.size());
+            int levelCount = 0;
+            for (int l : level)
+                levelCount = max(levelCount, l + 1);
+            schedule.levelStart.assign(levelCount + 1, 0);
+            for (int i = 0; i < n; i++)
+                schedule.levelStart[level[i] + 1]++;
+            for (int l = 0; l < levelCount; l++)
+                schedule.levelStart[l + 1] += schedule.levelStart[l];
+            ScratchVector<int> next(schedule.levelStart.begin(), schedule.levelStart.end() - 1);
+            schedule.rowOrder.resize(n);
+            for (int i = 0; i < n; i++)
+                schedule.rowOrder[next[level[i]]++] = i;
+        }
+
+    public:
+        // Порядок исключения, дерево исключения и образец множителей
+        void analyze(const SparseMatrix &matrix)
+        {
+            int n = matrix.rows();
+            complete = minimumDegree(matrix, order);
+            if (!complete)
+            {
+                order.resize(n);
+                for (int k = 0; k < n; k++)
+                    order[k] = k;
+            }
+            stepOf.assign(n, 0);
+            for (int k = 0; k < n; k++)
+                stepOf[order[k]] = k;
+
+            transposeOf.assign(matrix.column.size(), -1);
+            {
+                ScratchVector<int> next(matrix.rowStart.begin(), matrix.rowStart.end() - 1);
+                for (int i = 0; i < n; i++)
+                {
+                    for (int p = matrix.rowStart[i]; p < matrix.rowStart[i + 1]; p++)
+                        transposeOf[next[matrix.column[p]]++] = p;
+                }
+            }
+
+            // Строка k множителя L - поддерево строки в дереве исключения:
+            // пути вверх от столбцов строки матрицы до уже отмеченных вершин.
+            // Неполное разложение - только столбцы строки матрицы
+            ScratchVector<int> parent(n, -1), mark(n, -1), path;
+            ScratchVector<int> count(n, 0);
+            rowStart.assign(1, 0);
+            rowColumn.clear();
+            for (int k = 0; k < n; k++)
+            {
+                int r = order[k];
+                mark[k] = k;
+                size_t rowBegin = rowColumn.size();
+                for (int p = matrix.rowStart[r]; p < matrix.rowStart[r + 1]; p++)
+                {
+                    int j = stepOf[matrix.column[p]];
+                    if (j >= k)
+                        continue;
+                    if (!complete)
+                    {
+                        rowColumn.push_back(j);
+                        continue;
+                    }
+                    path.clear();
+                    for (; mark[j] != k; j = parent[j])
+                    {
+                        if (parent[j] < 0)
+                            parent[j] = k;
+                        mark[j] = k;
+                        path.push_back(j);
+                    }
+                    // Путь снизу вверх дописывается целиком: потомки раньше предков
+                    rowColumn.insert(rowColumn.end(), path.begin(), path.end());
+                }
+                // Пути разных столбцов могут сливаться: порядок "потомок раньше предка" внутри
+                // строки дает сортировка по шагу (номер потомка меньше номера предка)
+                sort(rowColumn.begin() + rowBegin, rowColumn.end());
+                for (size_t q = rowBegin; q < rowColumn.size(); q++)
+                    count[rowColumn[q]]++;
+                rowStart.push_back(static_cast<int>(rowColumn.size()));
+            }
+
+            columnStart.assign(n + 1, 0);
+            for (int j = 0; j < n; j++)
+                columnStart[j + 1] = columnStart[j] + count[j];
+            columnRow.resize(rowColumn.size());
+            rowSlot.resize(rowColumn.size());
+            ScratchVector<int> next(columnStart.begin(), columnStart.end() - 1);
+            for (int k = 0; k < n; k++)
+            {
+                for (int q = rowStart[k]; q < rowStart[k + 1]; q++)
+                {
+                    int slot = next[rowColumn[q]]++;
+                    columnRow[slot] = k;
+                    rowSlot[q] = slot;
+                }
+            }
+            lower.assign(rowColumn.size(), 0.0);
+            upper.assign(rowColumn.size(), 0.0);
+            pivot.assign(n, 0.0);
+            work.assign(n, 0.0);
+
+            // Прямой ход: строка ждет свои столбцы; обратный - строки своего столбца
+            ScratchVector<int> level(n, 0);
+            for (int k = 0; k < n; k++)
+            {
+                for (int q = rowStart[k]; q < rowStart[k + 1]; q++)
+                    level[k] = max(level[k], level[rowColumn[q]] + 1);
+            }
+            buildSchedule(level, forwardLevels);
+            fill(level.begin(), level.end(), 0);
+            for (int k = n - 1; k >= 0; k--)
+            {
+                for (int q = columnStart[k]; q < columnStart[k + 1]; q++)
+                    level[k] = max(level[k], level[columnRow[q]] + 1);
+            }
+            buildSchedule(level, backwardLevels);
+        }
+
+        bool exact() const { return complete; }
+
+        // Численное разложение по образцу из analyze
+        void factorize(const SparseMatrix &matrix)
+        {
+            int n = matrix.rows();
+            ScratchVector<double> columnPart(n, 0.0), rowPart(n, 0.0);
+            for (int k = 0; k < n; k++)
+            {
+                int r = order[k];
+                double diagonal = 0.0, rowScale = 0.0;
+                for (int p = matrix.rowStart[r]; p < matrix.rowStart[r + 1]; p++)
+                {
+                    int j = stepOf[matrix.column[p]];
+                    rowScale = max(rowScale, fabs(matrix.value[p]));
+                    if (j < k)
+                    {
+                        rowPart[j] = matrix.value[p];                 // A(k, j)
+                        columnPart[j] = matrix.value[transposeOf[p]]; // A(j, k)
+                    }
+                    else if (j == k)
+                        diagonal = matrix.value[p];
+                }
+
+                // L(k, j) = (A(k, j) - sum L(k, i) U(i, j)) / U(j, j), U(j, k) = A(j, k) - sum L(j, i) U(i, k)
+                for (int q = rowStart[k]; q < rowStart[k + 1]; q++)
+                {
+                    int j = rowColumn[q];
+                    double u = columnPart[j];
+                    double l = rowPart[j] / pivot[j];
+                    columnPart[j] = 0.0;
+                    rowPart[j] = 0.0;
+                    int slot = rowSlot[q];
+                    for (int s = columnStart[j]; s < slot; s++)
+                    {
+                        int i = columnRow[s];
+                        columnPart[i] -= lower[s] * u;
+                        rowPart[i] -= upper[s] * l;
+                    }
+                    diagonal -= l * u;
+                    lower[slot] = l;
+                    upper[slot] = u;
+                }
+
+                // Обновления вне образца строки отбрасываются
+                if (!complete)
+                {
+                    for (int q = rowStart[k]; q < rowStart[k + 1]; q++)
+                    {
+                        for (int s = columnStart[rowColumn[q]]; s < rowSlot[q]; s++)
+                        {
+                            columnPart[columnRow[s]] = 0.0;
+                            rowPart[columnRow[s]] = 0.0;
+                        }
+                    }
+                }
+
+                // Вырожденная строка (станция без влияния на балансы) - малый ведущий элемент
+                double minimum = 1e-12 * (rowScale > 0.0 ? rowScale : 1.0);
+                if (fabs(diagonal) < minimum)
+                    diagonal = diagonal < 0.0 ? -minimum : minimum;
+                pivot[k] = diagonal;
+            }
+        }
+
+        // x = (LU)^-1 rhs; строки одного уровня - параллельно
+        void solve(const ScratchVector<double> &rhs, ScratchVector<double> &x) const
+        {
+            forwardLevels.run([&](int k)
+                              {
+                                  double sum = rhs[order[k]];
+                                  for (int q = rowStart[k]; q < rowStart[k + 1]; q++)
+                                      sum -= lower[rowSlot[q]] * work[rowColumn[q]];
+                                  work[k] = sum; });
+            backwardLevels.run([&](int k)
+                               {
+                                   double sum = work[k];
+                                   for (int s = columnStart[k]; s < columnStart[k + 1]; s++)
+                                       sum -= upper[s] * work[columnRow[s]];
+                                   work[k] = sum / pivot[k]; });
+            TaskScheduler::instance().parallelFor(0, order.size(), GRAIN, [&](size_t k)
+                                                  { x[order[k]] = work[k]; });
+        }
+    };
+
+    // BiCGSTAB с правым предобусловливанием; x - начальное приближение и ответ.
+    // Возвращает число итераций (maxIterations - не сошелся).
+    int solveLinear(const SparseMatrix &matrix, const SparseLU &preconditioner,
+                    const ScratchVector<double> &rhs, ScratchVector<double> &x, int maxIterations)
+    {
+        TaskScheduler &scheduler = TaskScheduler::instance();
+        size_t n = rhs.size();
+        double rhsNorm = sqrt(dot(rhs, rhs));
+        if (rhsNorm == 0.0)
+        {
+            fill(x.begin(), x.end(), 0.0);
+            return 0;
+        }
+
+        ScratchVector<double> r(n), shadow(n), p(n, 0.0), v(n, 0.0), s(n), t(n), adjusted(n), adjustedS(n);
+        matrix.multiply(x, r);
+        scheduler.parallelFor(0, n, GRAIN, [&](size_t i)
+                              { r[i] = rhs[i] - r[i]; });
+        shadow = r;
+
+        double rho = 1.0, alpha = 1.0, omega = 1.0;
+        int iteration = 0;
+        while (iteration < maxIterations && sqrt(dot(r, r)) > LINEAR_TOLERANCE * rhsNorm)
+        {
+            iteration++;
+            double rhoNext = dot(shadow, r);
+            if (rhoNext == 0.0)
+                break;
+
+            double beta = (rhoNext / rho) * (alpha / omega);
+            scheduler.parallelFor(0, n, GRAIN, [&](size_t i)
+                                  { p[i] = r[i] + beta * (p[i] - omega * v[i]); });
+            rho = rhoNext;
+
+            preconditioner.solve(p, adjusted);
+            matrix.multiply(adjusted, v);
+            double denominator = dot(shadow, v);
+            if (denominator == 0.0)
+                break;
+            alpha = rho / denominator;
+
+            scheduler.parallelFor(0, n, GRAIN, [&](size_t i)
+                                  { s[i] = r[i] - alpha * v[i]; });
+            if (sqrt(dot(s, s)) <= LINEAR_TOLERANCE * rhsNorm)
+            {
+                scheduler.parallelFor(0, n, GRAIN, [&](size_t i)
+                                      { x[i] += alpha * adjusted[i]; });
+                break;
+            }
+
+            preconditioner.solve(s, adjustedS);
+            matrix.multiply(adjustedS, t);
+            double tt = dot(t, t);
+            omega = tt > 0.0 ? dot(t, s) / tt : 0.0;
+
+            scheduler.parallelFor(0, n, GRAIN, [&](size_t i)
+                                  {
+                                      x[i] += alpha * adjusted[i] + omega * adjustedS[i];
+                                      r[i] = s[i] - omega * t[i]; });
+            if (omega == 0.0)
+                break;
+        }
+        return iteration;
+    }
+
+    // Q (м³/час) = prefix * D^k / L^m * (dP²)^m, dP² в кПа²
+    struct PipeLaw
+    {
+        double exponent;
+        double diameterPower;
+        double prefix;
+    };
+
+    PipeLaw pipeLaw(const HydraulicSolver::Settings &settings)
+    {
+        PipeLaw law;
+        if (settings.equation == HydraulicSolver::Equation::Weymouth)
+        {
+            law.exponent = 0.5;
+            law.diameterPower = 2.667;
+            law.prefix = 3.7435e-3 * settings.efficiency * (BASE_TEMPERATURE / BASE_PRESSURE) *
+                         pow(settings.gasGravity * settings.temperature * settings.compressibility, -law.exponent);
+        }
+        else
+        {
+            law.exponent = 0.5394;
+            law.diameterPower = 2.6182;
+            law.prefix = 4.5965e-3 * settings.efficiency * pow(BASE_TEMPERATURE / BASE_PRESSURE, 1.0788) *
+                         pow(pow(settings.gasGravity, 0.8539) * settings.temperature * settings.compressibility, -law.exponent);
+        }
+        law.prefix /= 24.0; // м³/сутки -> м³/час
+        return law;
+    }
+
+    // Квадрат давления на выходе станции (после компримирования) и производная по входу
+    double outletSquare(double inlet, double ratioSquare, double maxSquare, double &derivative)
+    {
+        if (ratioSquare <= 1.0)
+        {
+            derivative = 1.0;
+            return inlet;
+        }
+        double boosted = ratioSquare * inlet;
+        if (boosted <= maxSquare)
+        {
+            derivative = ratioSquare;
+            return boosted;
+        }
+        if (inlet >= maxSquare)
+        {
+            derivative = 1.0;
+            return inlet;
+        }
+        derivative = 0.0; // нагнетание на пределе - не зависит от входа
+        return maxSquare;
+    }
+}
+
+double HydraulicSolver::flowCoefficient(const Pipe &pipe, const Settings &settings)
+{
+    PipeLaw law = pipeLaw(settings);
+    return law.prefix * pow(static_cast<double>(pipe.getDiameter()), law.diameterPower) /
+           pow(max(pipe.getLength(), 1e-3), law.exponent);
+}
+
+double HydraulicSolver::compressionRatio(const CompressorStation &station, const Settings &settings)
+{
+    double ratio = 1.0 + settings.ratioPerShop * max(0, station.getWorkingShops());
+    return max(1.0, min(ratio, settings.maxRatio));
+}
+
+HydraulicSolver::Result HydraulicSolver::solve(const Graph &graph,
+                                               const PipelineNetwork &network,
+                                               const map<int, double> &sourcePressure,
+                                               const map<int, double> &demand,
+                                               const Settings &settings)
+{
+    static const MemoryTracker::ScratchTag scratchTag("HydraulicSolver::solve");
+    MemoryTracker::ScratchScope scratch(scratchTag);
+    Result result;
+
+    const FlatGraph &flat = NetworkCalculator::cachedFlatGraph(graph, network);
+    int n = flat.getNodeCount();
+    TaskScheduler &scheduler = TaskScheduler::instance();
+
+    double exponent = pipeLaw(settings).exponent;
+
+    // Исправные трубы (массивы по трубам) и труба каждой дуги плоского графа
+    ScratchVector<int> pipeTail, pipeHead, pipeIds;
+    ScratchVector<double> coefficient;
+    ScratchVector<int> pipeOfArc(flat.getArcCount(), -1);
+    for (int a = 0; a < flat.getArcCount(); a++)
+    {
+        const FlatGraph::Arc &arc = flat.arc(a);
+        if (!arc.forward || arc.pipeId < 0 || arc.tail == arc.head)
+            continue;
+        const Pipe *pipe = network.getPipeById(arc.pipeId);
+        if (!pipe || pipe->isUnderRepair())
+            continue;
+
+        int e = static_cast<int>(pipeIds.size());
+        pipeIds.push_back(arc.pipeId);
+        pipeTail.push_back(arc.tail);
+        pipeHead.push_back(arc.head);
+        coefficient.push_back(flowCoefficient(*pipe, settings));
+        pipeOfArc[a] = e;
+        pipeOfArc[arc.reverse] = e;
+    }
+    size_t pipeCount = pipeIds.size();
+
+    // Станция без входящих исправных труб (и не источник) газа не получает - цеха простаивают
+    ScratchVector<char> hasInflow(n, 0);
+    for (size_t e = 0; e < pipeIds.size(); e++)
+    {
+        hasInflow[pipeHead[e]] = 1;
+    }
+    ScratchVector<double> ratioSquare(n, 1.0);
+    for (int v = 0; v < n; v++)
+    {
+        const CompressorStation *station = network.getStationById(flat.stationAt(v));
+        if (station && (hasInflow[v] || sourcePressure.count(station->getId())))
+        {
+            double ratio = compressionRatio(*station, settings);
+            ratioSquare[v] = ratio * ratio;
+        }
+    }
+    double maxSquare = pow(settings.maxPressure * KPA_PER_BAR, 2);
+
+    // Граничные условия
+    ScratchVector<double> square(n, 0.0); // квадрат давления, кПа²
+    ScratchVector<char> fixed(n, 0);
+    ScratchVector<double> load(n, 0.0);
+    ScratchVector<int> bfsOrder;
+    ScratchVector<char> reached(n, 0);
+    bfsOrder.reserve(n);
+    double referenceSquare = 0.0;
+    for (const auto &entry : sourcePressure)
+    {
+        int v = flat.nodeOf(entry.first);
+        if (v < 0 || entry.second <= 0.0 || fixed[v])
+            continue;
+        fixed[v] = 1;
+        reached[v] = 1;
+        square[v] = pow(entry.second * KPA_PER_BAR, 2);
+        referenceSquare = max(referenceSquare, square[v]);
+        bfsOrder.push_back(v);
+    }
+    double totalLoad = 0.0;
+    for (const auto &entry : demand)
+    {
+        int v = flat.nodeOf(entry.first);
+        if (v >= 0)
+        {
+            load[v] += entry.second;
+            totalLoad += fabs(entry.second);
+        }
+    }
+
+    // Обход от станций заданного давления по исправным трубам: какие станции рассчитываются,
+    // начальное давление (как у ближайшего источника) и порядок строк матрицы
+    for (size_t head = 0; head < bfsOrder.size(); head++)
+    {
+        int u = bfsOrder[head];
+        for (int a = flat.arcBegin(u); a < flat.arcEnd(u); a++)
+        {
+            const FlatGraph::Arc &arc = flat.arc(a);
+            if (pipeOfArc[a] < 0 || reached[arc.head])
+                continue;
+            reached[arc.head] = 1;
+            bfsOrder.push_back(arc.head);
+            square[arc.head] = square[u];
+        }
+    }
+
+    for (int v = 0; v < n; v++)
+    {
+        if (!reached[v])
+            result.unresolvedStations.push_back(flat.stationAt(v));
+    }
+    if (referenceSquare == 0.0)
+    {
+        return result;
+    }
+
+    // Строки - станции без заданного давления, от дальних к источникам
+    ScratchVector<int> rowOf(n, -1);
+    ScratchVector<int> nodeOfRow;
+    for (size_t i = bfsOrder.size(); i-- > 0;)
+    {
+        int v = bfsOrder[i];
+        if (!fixed[v])
+        {
+            rowOf[v] = static_cast<int>(nodeOfRow.size());
+            nodeOfRow.push_back(v);
+        }
+    }
+    int rows = static_cast<int>(nodeOfRow.size());
+
+    // Образец якобиана и позиция элемента для каждой дуги строки
+    SparseMatrix jacobian;
+    ScratchVector<int> entryOfArc(flat.getArcCount(), -1);
+    jacobian.rowStart.assign(1, 0);
+    jacobian.diagonal.resize(rows);
+    ScratchVector<int> columns;
+    for (int i = 0; i < rows; i++)
+    {
+        int v = nodeOfRow[i];
+        columns.clear();
+        columns.push_back(i);
+        for (int a = flat.arcBegin(v); a < flat.arcEnd(v); a++)
+        {
+            if (pipeOfArc[a] >= 0 && rowOf[flat.arc(a).head] >= 0)
+                columns.push_back(rowOf[flat.arc(a).head]);
+        }
+        sort(columns.begin(), columns.end());
+        columns.erase(unique(columns.begin(), columns.end()), columns.end());
+
+        int offset = static_cast<int>(jacobian.column.size());
+        jacobian.column.insert(jacobian.column.end(), columns.begin(), columns.end());
+        jacobian.rowStart.push_back(static_cast<int>(jacobian.column.size()));
+        jacobian.diagonal[i] = offset + static_cast<int>(lower_bound(columns.begin(), columns.end(), i) - columns.begin());
+        for (int a = flat.arcBegin(v); a < flat.arcEnd(v); a++)
+        {
+            int other = flat.arc(a).head;
+            if (pipeOfArc[a] >= 0 && rowOf[other] >= 0)
+                entryOfArc[a] = offset + static_cast<int>(lower_bound(columns.begin(), columns.end(), rowOf[other]) - columns.begin());
+        }
+    }
+    jacobian.value.assign(jacobian.column.size(), 0.0);
+
+    // Ньютон по давлениям и потокам (глобальный градиентный метод, как в EPANET):
+    // уравнение трубы dP² = R * Q|Q|^(n-1) (n = 1/m) линеаризуется по потоку, где оно
+    // выпукло, а баланс станций линеен по потокам. После исключения поправок потоков
+    // остается система по давлениям с проводимостями 1 / (dP²)'_Q.
+    double power = 1.0 / exponent;
+    ScratchVector<double> resistance(pipeCount);
+    for (size_t e = 0; e < pipeCount; e++)
+    {
+        resistance[e] = pow(coefficient[e], -power);
+    }
+    double flowScale = max(1.0, totalLoad);
+    double minFlow = 1e-3 * flowScale; // масштаб сглаживания закона трубы у нуля
+
+    ScratchVector<double> flow(pipeCount), conductance(pipeCount), lawError(pipeCount);
+    ScratchVector<double> outlet(n), outletSlope(n, 1.0);
+    ScratchVector<double> imbalance(rows), rhs(rows);
+
+    // Начальные потоки - малые, одного направления с трубой
+    fill(flow.begin(), flow.end(), INITIAL_FLOW_SHARE * flowScale);
+
+    // Невязки в текущей точке, правая часть и матрица системы по давлениям
+    auto evaluate = [&]()
+    {
+        scheduler.parallelFor(0, n, GRAIN, [&](size_t v)
+                              { outlet[v] = outletSquare(square[v], ratioSquare[v], maxSquare, outletSlope[v]); });
+
+        scheduler.parallelFor(0, pipeCount, GRAIN, [&](size_t e)
+                              {
+                                  // Сглаженный закон R * Q * (Q² + q²)^((n-1)/2): у нулевого потока
+                                  // простой корень, Ньютон сходится квадратично
+                                  double q2 = flow[e] * flow[e] + minFlow * minFlow;
+                                  double scaled = resistance[e] * pow(q2, 0.5 * (power - 3.0));
+                                  double law = scaled * q2 * flow[e];
+                                  double derivative = scaled * (power * flow[e] * flow[e] + minFlow * minFlow);
+                                  conductance[e] = 1.0 / derivative;
+                                  lawError[e] = law - (outlet[pipeTail[e]] - square[pipeHead[e]]); });
+
+        scheduler.parallelFor(0, rows, GRAIN, [&](size_t i)
+                              {
+                                  int v = nodeOfRow[i];
+                                  for (int p = jacobian.rowStart[i]; p < jacobian.rowStart[i + 1]; p++)
+                                      jacobian.value[p] = 0.0;
+
+                                  // Небаланс: приток - отток - отбор
+                                  double balance = -load[v];
+                                  double correction = 0.0;
+                                  double &diagonal = jacobian.value[jacobian.diagonal[i]];
+                                  for (int a = flat.arcBegin(v); a < flat.arcEnd(v); a++)
+                                  {
+                                      int e = pipeOfArc[a];
+                                      if (e < 0)
+                                          continue;
+                                      int other = flat.arc(a).head;
+                                      if (flat.arc(a).forward)
+                                      {
+                                          balance -= flow[e];
+                                          correction -= conductance[e] * lawError[e];
+                                          diagonal -= conductance[e] * outletSlope[v];
+                                          if (entryOfArc[a] >= 0)
+                                              jacobian.value[entryOfArc[a]] += conductance[e];
+                                      }
+                                      else
+                                      {
+                                          balance += flow[e];
+                                          correction += conductance[e] * lawError[e];
+                                          diagonal -= conductance[e];
+                                          if (entryOfArc[a] >= 0)
+                                              jacobian.value[entryOfArc[a]] += conductance[e] * outletSlope[other];
+                                      }
+                                  }
+                                  imbalance[i] = balance;
+                                  rhs[i] = correction - balance; });
+
+        double worst = 0.0;
+        for (double value : imbalance)
+            worst = max(worst, fabs(value));
+        result.residual = worst;
+    };
+
+    evaluate();
+    SparseLU preconditioner;
+    preconditioner.analyze(jacobian);
+    ScratchVector<double> step(rows), flowStep(pipeCount);
+    ScratchVector<double> nodeStep(n, 0.0);
+
+    // Точное разложение - решение на своей итерации Ньютона и предобусловливатель
+    // на следующих; если BiCGSTAB с ним не сходится за несколько итераций
+    // (переключился режим компрессора), матрица раскладывается заново.
+    // Неполное разложение обновляется на каждой итерации
+    bool factorized = false;
+    while (result.iterations < settings.maxIterations)
+    {
+        result.iterations++;
+
+        fill(step.begin(), step.end(), 0.0);
+        bool solved = false;
+        if (factorized && preconditioner.exact())
+        {
+            int linear = solveLinear(jacobian, preconditioner, rhs, step, REFACTOR_ITERATIONS);
+            result.linearIterations += linear;
+            solved = linear < REFACTOR_ITERATIONS;
+        }
+        if (!solved)
+        {
+            preconditioner.factorize(jacobian);
+            factorized = true;
+            result.linearIterations += solveLinear(jacobian, preconditioner, rhs, step, LINEAR_MAX_ITERATIONS);
+        }
+
+        // Поправки потоков: dQ = (d(dP²) - ошибка уравнения) * проводимость
+        for (int i = 0; i < rows; i++)
+            nodeStep[nodeOfRow[i]] = step[i];
+        scheduler.parallelFor(0, pipeCount, GRAIN, [&](size_t e)
+                              {
+                                  int tail = pipeTail[e];
+                                  double change = outletSlope[tail] * nodeStep[tail] - nodeStep[pipeHead[e]];
+                                  flowStep[e] = conductance[e] * (change - lawError[e]); });
+
+        // Полный шаг: баланс станций линеен по потокам и выполняется сразу,
+        // уравнения труб выпуклы по потоку - дробление шага не нужно
+        double totalChange = 0.0, totalFlow = 0.0, squareChange = 0.0;
+        for (int i = 0; i < rows; i++)
+        {
+            square[nodeOfRow[i]] += step[i];
+            squareChange = max(squareChange, fabs(step[i]));
+        }
+        for (size_t e = 0; e < pipeCount; e++)
+        {
+            flow[e] += flowStep[e];
+            totalChange += fabs(flowStep[e]);
+            totalFlow += fabs(flow[e]);
+        }
+        evaluate();
+        if (!isfinite(result.residual) || !isfinite(totalChange))
+            break;
+
+        // Сходимость: потоки и давления перестали меняться (как в EPANET), балансы выполнены.
+        // Одних потоков мало: в дереве они точны после первого шага, а давления еще
+        // линеаризованы не на том участке характеристики компрессора
+        if (totalChange <= settings.tolerance * max(totalFlow, flowScale) &&
+            squareChange <= settings.tolerance * referenceSquare &&
+            result.residual <= settings.tolerance * flowScale)
+        {
+            result.converged = true;
+            break;
+        }
+    }
+
+    // Результат
+    double minSquare = referenceSquare;
+    for (int v : bfsOrder)
+    {
+        minSquare = min(minSquare, square[v]);
+        result.stations.push_back({flat.stationAt(v),
+                                   sqrt(max(square[v], 0.0)) / KPA_PER_BAR,
+                                   sqrt(max(outlet[v], 0.0)) / KPA_PER_BAR,
+                                   0.0});
+    }
+    result.feasible = minSquare > 0.0;
+    result.minPressure = sqrt(max(minSquare, 0.0)) / KPA_PER_BAR;
+    sort(result.stations.begin(), result.stations.end(),
+         [](const StationState &a, const StationState &b)
+         { return a.stationId < b.stationId; });
+
+    ScratchVector<double> injection(n, 0.0);
+    for (size_t e = 0; e < pipeCount; e++)
+    {
+        int tail = pipeTail[e];
+        int head = pipeHead[e];
+        if (!reached[tail] || !reached[head])
+            continue;
+        injection[tail] += flow[e];
+        injection[head] -= flow[e];
+        result.pipes.push_back({pipeIds[e], flat.stationAt(tail), flat.stationAt(head), flow[e],
+                                sqrt(max(outlet[tail], 0.0)) / KPA_PER_BAR,
+                                sqrt(max(square[head], 0.0)) / KPA_PER_BAR});
+    }
+    for (StationState &state : result.stations)
+    {
+        int v = flat.nodeOf(state.stationId);
+        if (fixed[v])
+            state.injection = injection[v] + load[v];
+    }
+
+    return result;
+}
@@ -0,0 +1,99 @@
+#ifndef HYDRAULIC_SOLVER_H
+#define HYDRAULIC_SOLVER_H
+
+#include "Graph.h"
+#include "PipelineNetwork.h"
+#include <map>
+#include <vector>
+
+// Стационарный гидравлический расчет газовой сети: давления в станциях и потоки по трубам.
+// Труба: Q = C * E * (Tb/Pb)^a * ((P1^2 - P2^2) / (G^b * T * L * Z))^m * D^k
+// (Уэймут: m = 0.5, k = 2.667; Панхендл A: m = 0.5394, k = 2.6182; P - кПа, L - км, D - мм).
+// Станция с работающими цехами поднимает давление на выходе в свои трубы:
+// степень сжатия 1 + ratioPerShop * workingShops (не больше maxRatio),
+// давление нагнетания - не выше maxPressure.
+// Неизвестные - квадраты давлений в станциях без заданного давления и потоки по трубам;
+// уравнения - баланс станций и уравнения труб. Ньютон в форме глобального градиентного
+// метода: поправки потоков исключаются, на каждой итерации решается разреженная система
+// по давлениям: BiCGSTAB, предобусловленный прямым LU-разложением в порядке минимальной
+// степени (кольцевые сети; разложение переиспользуется, пока его хватает). Если заполнение
+// слишком велико (безмасштабные сети с хабами) - неполным LU(0), строки от дальних станций
+// к источникам: для сети-дерева оно точное. Станции, не связанные исправными трубами
+// ни с одной станцией заданного давления, не рассчитываются.
+class HydraulicSolver
+{
+public:
+    enum class Equation
+    {
+        Weymouth,
+        PanhandleA
+    };
+
+    struct Settings
+    {
+        Equation equation = Equation::Weymouth;
+        double efficiency = 0.92;        // коэффициент эффективности трубы E
+        double gasGravity = 0.6;         // относительная плотность газа G
+        double temperature = 288.15;     // температура газа, К
+        double compressibility = 0.9;    // коэффициент сжимаемости Z
+        double ratioPerShop = 0.1;       // прирост степени сжатия на работающий цех
+        double maxRatio = 1.7;
+        double maxPressure = 75.0;       // предельное давление нагнетания, бар
+        double tolerance = 1e-6;         // относительное изменение потоков и давлений за итерацию, небаланс станций
+        int maxIterations = 50;
+    };
+
+    struct StationState
+    {
+        int stationId;
+        double pressure;     // бар (абс.)
+        double outletPressure; // после компримирования, бар
+        double injection;    // закачка станции заданного давления (м³/час), иначе 0
+    };
+
+    struct PipeState
+    {
+        int pipeId;
+        int fromStation;
+        int toStation;
+        double flow;           // м³/час, > 0 - по направлению трубы
+        double inletPressure;  // бар
+        double outletPressure; // бар
+    };
+
+    struct Result
+    {
+        bool converged = false;
+        bool feasible = true;     // нигде давление не упало до нуля
+        int iterations = 0;
+        int linearIterations = 0;
+        double residual = 0.0;    // наибольший небаланс в станции, м³/час
+        double minPressure = 0.0; // бар
+        std::vector<StationState> stations; // по возрастанию ID
+        std::vector<PipeState> pipes;
+        std::vector<int> unresolvedStations; // нет исправного пути до станции заданного давления
+    };
+
+    // Коэффициент C трубы в законе Q = C * (P1² - P2²)^m (м³/час, давления в кПа)
+    static double flowCoefficient(const Pipe &pipe, const Settings &settings);
+
+    // Степень сжатия станции по числу работающих цехов
+    static double compressionRatio(const CompressorStation &station, const Settings &settings);
+
+    // sourcePressure - станции с заданным давлением (бар), demand - отбор газа (м³/час,
+    // отрицательный - закачка). Трубы в ремонте газ не проводят.
+    static Result solve(const Graph &graph,
+                        const PipelineNetwork &network,
+                        const std::map<int, double> &sourcePressure,
+                        const std::map<int, double> &demand,
+                        const Settings &settings);
+    static Result solve(const Graph &graph,
+                        const PipelineNetwork &network,
+                        const std::map<int, double> &sourcePressure,
+                        const std::map<int, double> &demand)
+    {
+        return solve(graph, network, sourcePressure, demand, Settings());
+    }
+};
+
+#endif
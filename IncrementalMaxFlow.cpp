@@ -0,0 +1,121 @@
+#include "IncrementalMaxFlow.h"
+#include <limits>
+#include <cmath>
+
+using namespace std;
+
+double IncrementalMaxFlow::reset(const Graph &graph, const PipelineNetwork &network, int source, int target)
+{
+    NetworkCalculator::buildStationGraph(flat, graph, network, true);
+    workspace.prepare(flat);
+
+    graphVersion = graph.getVersion();
+    sourceStation = source;
+    targetStation = target;
+    sourceNode = flat.nodeOf(source);
+    targetNode = flat.nodeOf(target);
+
+    flowValue = NetworkCalculator::calculateMaxFlow(flat, workspace, source, target);
+    valid = true;
+    return flowValue;
+}
+
+bool IncrementalMaxFlow::isValidFor(const Graph &graph, int source, int target) const
+{
+    return valid && graphVersion == graph.getVersion() &&
+           sourceStation == source && targetStation == target;
+}
+
+void IncrementalMaxFlow::applyCapacity(int arc, double capacity)
+{
+    if (capacity < workspace.flow[arc])
+    {
+        // Снижение ниже текущего потока: избыток перенаправляется или снимается
+        flowValue -= NetworkCalculator::reduceArcFlow(flat, workspace, arc, capacity, sourceNode, targetNode);
+    }
+    else
+    {
+        // Рост (или снижение, не задевающее поток) - поток остается допустимым
+        workspace.setCapacity(arc, capacity);
+    }
+}
+
+double IncrementalMaxFlow::setPipeCapacity(int pipeId, double capacity)
+{
+    int arc = flat.arcOfPipe(pipeId);
+    if (!valid || arc < 0)
+    {
+        return flowValue;
+    }
+
+    applyCapacity(arc, capacity);
+    flowValue += NetworkCalculator::augmentFlow(
+        flat, workspace, sourceNode, targetNode, numeric_limits<double>::max());
+    return flowValue;
+}
+
+size_t IncrementalMaxFlow::refresh(const PipelineNetwork &network)
+{
+    if (!valid)
+    {
+        return 0;
+    }
+
+    const double eps = NetworkCalculator::FLOW_EPSILON;
+    size_t changed = 0;
+
+    for (int arc = 0; arc < flat.getArcCount(); arc++)
+    {
+        const FlatGraph::Arc &pipeArc = flat.arc(arc);
+        double capacity;
+        if (flat.isStationArc(arc))
+        {
+            // Станция без данных поток не ограничивает
+            const CompressorStation *station = network.getStationById(flat.stationAt(pipeArc.tail));
+            capacity = station ? NetworkCalculator::calculateStationCapacity(
+                                     station->getWorkingShops(), station->getStationClass())
+                               : numeric_limits<double>::max();
+        }
+        else if (pipeArc.forward && pipeArc.pipeId >= 0)
+        {
+            // Трубы, удаленной из сети, больше нет - ее пропускная способность 0
+            const Pipe *pipe = network.getPipeById(pipeArc.pipeId);
+            capacity = pipe ? NetworkCalculator::calculatePipeCapacity(
+                                  pipe->getLength(), pipe->getDiameter(), pipe->isUnderRepair())
+                            : 0.0;
+        }
+        else
+            continue;
+
+        if (fabs(capacity - workspace.capacity(flat, arc)) > eps * max(1.0, capacity))
+        {
+            applyCapacity(arc, capacity);
+            changed++;
+        }
+    }
+
+    // Одно доращивание на все изменения сразу
+    if (changed > 0)
+    {
+        flowValue += NetworkCalculator::augmentFlow(
+            flat, workspace, sourceNode, targetNode, numeric_limits<double>::max());
+    }
+
+    return changed;
+}
+
+double IncrementalMaxFlow::getPipeFlow(int pipeId) const
+{
+    int arc = flat.arcOfPipe(pipeId);
+    return valid && arc >= 0 ? workspace.flow[arc] : 0.0;
+}
+
+void IncrementalMaxFlow::extractMinCut(MinCut &cut) const
+{
+    cut = MinCut();
+    if (valid && sourceNode >= 0 && targetNode >= 0 && sourceNode != targetNode)
+    {
+        // Последний поиск пути в augmentFlow был неудачным и пометил сторону источника
+        NetworkCalculator::extractMinCut(flat, workspace, cut);
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef INCREMENTAL_MAX_FLOW_H
+#define INCREMENTAL_MAX_FLOW_H
+
+#include "FlatGraph.h"
+#include "CalculationWorkspace.h"
+#include "NetworkCalculator.h"
+#include <cstdint>
+
+// Сохраняемое состояние максимального потока источник -> сток для одной версии топологии.
+// Изменения пропускной способности труб (ремонт, диаметр) и станций (работающие цеха)
+// применяются к уже найденному потоку: рост - доращиванием увеличивающими путями,
+// снижение - снятием избытка с дуги и повторным доращиванием. Полный пересчет нужен
+// только при смене топологии. Граф расщеплен по всем станциям, чтобы ограничение
+// могло появиться у любой из них без перестройки.
+class IncrementalMaxFlow
+{
+private:
+    FlatGraph flat;
+    CalculationWorkspace workspace;
+    uint64_t graphVersion = 0;
+    int sourceStation = -1;
+    int targetStation = -1;
+    int sourceNode = -1;
+    int targetNode = -1;
+    double flowValue = 0.0;
+    bool valid = false;
+
+    void applyCapacity(int arc, double capacity);
+
+public:
+    // Полный расчет и привязка к (источник, сток, версия графа)
+    double reset(const Graph &graph, const PipelineNetwork &network, int source, int target);
+
+    // Состояние относится к этой паре станций и этой версии топологии
+    bool isValidFor(const Graph &graph, int source, int target) const;
+    void invalidate() { valid = false; }
+
+    // Новая пропускная способность одной трубы; возвращает новую величину потока
+    double setPipeCapacity(int pipeId, double capacity);
+
+    // Перечитать пропускные способности всех труб и станций из сети и применить отличия.
+    // Возвращает число измененных труб и станций.
+    size_t refresh(const PipelineNetwork &network);
+
+    double getFlow() const { return flowValue; }
+    double getPipeFlow(int pipeId) const;
+    int getSourceStation() const { return sourceStation; }
+    int getTargetStation() const { return targetStation; }
+
+    // Минимальный разрез текущего потока
+    void extractMinCut(MinCut &cut) const;
+};
+
+#endif
@@ -0,0 +1,186 @@
+#include "KShortestPaths.h"
+#include "NetworkCalculator.h"
+#include "TaskScheduler.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <set>
+
+using namespace std;
+
+namespace
+{
+    struct Candidate
+    {
+        double length;
+        vector<int> arcs;  // дуги плоского графа от источника к стоку
+        size_t deviation;  // индекс узла, в котором маршрут отклонился от предка
+    };
+
+    struct LongerFirst
+    {
+        bool operator()(const Candidate &a, const Candidate &b) const
+        {
+            return a.length != b.length ? a.length > b.length : a.arcs > b.arcs;
+        }
+    };
+
+    // Дейкстра от узла spur до стока. Заблокированные дуги имеют пропускную
+    // способность 0 (изменения рабочей области), узлы корня маршрута заранее
+    // помечены расстоянием -1 и поэтому никогда не релаксируются.
+    bool spurDijkstra(const FlatGraph &graph, CalculationWorkspace &workspace,
+                      int spurNode, int target, vector<int> &arcs, double &length)
+    {
+        const double infinity = numeric_limits<double>::max();
+
+        auto &heap = workspace.heap;
+        auto byDistance = greater<pair<double, int>>();
+        heap.clear();
+        workspace.touch(spurNode, 0.0, -1);
+        heap.push_back({0.0, spurNode});
+
+        while (!heap.empty())
+        {
+            pop_heap(heap.begin(), heap.end(), byDistance);
+            auto [currentDist, u] = heap.back();
+            heap.pop_back();
+
+            if (currentDist > workspace.distance[u])
+                continue;
+            if (u == target)
+                break;
+
+            for (int a = graph.arcBegin(u); a < graph.arcEnd(u); a++)
+            {
+                const FlatGraph::Arc &arc = graph.arc(a);
+                if (!arc.forward || arc.length >= infinity ||
+                    workspace.capacity(graph, a) <= NetworkCalculator::FLOW_EPSILON)
+                    continue;
+
+                double newDist = currentDist + arc.length;
+                int v = arc.head;
+                if (!workspace.isTouched(v) || newDist < workspace.distance[v])
+                {
+                    workspace.touch(v, newDist, a);
+                    heap.push_back({newDist, v});
+                    push_heap(heap.begin(), heap.end(), byDistance);
+                }
+            }
+        }
+
+        arcs.clear();
+        if (!workspace.isTouched(target) || workspace.distance[target] < 0.0)
+            return false;
+
+        length = workspace.distance[target];
+        for (int v = target; v != spurNode; v = graph.arc(workspace.parentArc[v]).tail)
+        {
+            arcs.push_back(workspace.parentArc[v]);
+        }
+        reverse(arcs.begin(), arcs.end());
+        return true;
+    }
+}
+
+vector<KShortestPaths::Route> KShortestPaths::find(const FlatGraph &graph, int sourceStation, int targetStation, int k)
+{
+    vector<Route> routes;
+    int source = graph.nodeOf(sourceStation);
+    int target = graph.nodeOf(targetStation);
+    if (k <= 0 || source < 0 || target < 0 || source == target)
+    {
+        return routes;
+    }
+
+    vector<Candidate> accepted;
+    priority_queue<Candidate, vector<Candidate>, LongerFirst> candidates;
+    set<vector<int>> known; // маршруты, уже принятые или стоящие в куче
+
+    {
+        CalculationWorkspace &workspace = NetworkCalculator::threadWorkspace();
+        workspace.prepare(graph);
+        workspace.beginQuery();
+        Candidate first{0.0, {}, 0};
+        if (!spurDijkstra(graph, workspace, source, target, first.arcs, first.length))
+        {
+            return routes;
+        }
+        known.insert(first.arcs);
+        candidates.push(first);
+    }
+
+    vector<Candidate> spurs;
+    while (static_cast<int>(accepted.size()) < k && !candidates.empty())
+    {
+        accepted.push_back(candidates.top());
+        candidates.pop();
+        if (static_cast<int>(accepted.size()) == k)
+            break;
+
+        const Candidate &previous = accepted.back();
+        size_t first = previous.deviation;
+        size_t last = previous.arcs.size(); // узлы отклонения: first .. last-1
+        spurs.assign(last - first, Candidate{0.0, {}, 0});
+
+        TaskScheduler::instance().parallelFor(first, last, 1, [&](size_t i)
+                                              {
+            CalculationWorkspace &workspace = NetworkCalculator::threadWorkspace();
+            workspace.prepare(graph);
+            workspace.beginQuery();
+
+            // Запрещаем продолжения уже принятых маршрутов с тем же корнем
+            for (const Candidate &path : accepted)
+            {
+                if (path.arcs.size() > i && equal(path.arcs.begin(), path.arcs.begin() + i, previous.arcs.begin()))
+                {
+                    workspace.setCapacity(path.arcs[i], 0.0);
+                }
+            }
+
+            // Узлы корня (кроме узла отклонения) исключены - маршрут остается простым
+            double rootLength = 0.0;
+            for (size_t j = 0; j < i; j++)
+            {
+                const FlatGraph::Arc &arc = graph.arc(previous.arcs[j]);
+                workspace.touch(arc.tail, -1.0, -1);
+                rootLength += arc.length;
+            }
+
+            int spurNode = graph.arc(previous.arcs[i]).tail;
+            Candidate &spur = spurs[i - first];
+            double spurLength = 0.0;
+            if (spurDijkstra(graph, workspace, spurNode, target, spur.arcs, spurLength))
+            {
+                spur.arcs.insert(spur.arcs.begin(), previous.arcs.begin(), previous.arcs.begin() + i);
+                spur.length = rootLength + spurLength;
+                spur.deviation = i;
+            } });
+
+        // Кандидаты добавляются по порядку узлов отклонения - результат детерминирован
+        for (Candidate &spur : spurs)
+        {
+            if (!spur.arcs.empty() && known.insert(spur.arcs).second)
+            {
+                candidates.push(move(spur));
+            }
+        }
+    }
+
+    for (const Candidate &path : accepted)
+    {
+        Route route;
+        route.length = path.length;
+        route.bottleneck = numeric_limits<double>::max();
+        route.stations.push_back(sourceStation);
+        for (int a : path.arcs)
+        {
+            const FlatGraph::Arc &arc = graph.arc(a);
+            route.pipeIds.push_back(arc.pipeId);
+            route.stations.push_back(graph.stationAt(arc.head));
+            route.bottleneck = min(route.bottleneck, arc.capacity);
+        }
+        routes.push_back(route);
+    }
+    return routes;
+}
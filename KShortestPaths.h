@@ -0,0 +1,28 @@
+#ifndef K_SHORTEST_PATHS_H
+#define K_SHORTEST_PATHS_H
+
+#include "FlatGraph.h"
+#include <vector>
+
+// k кратчайших маршрутов без повторения станций (алгоритм Йена).
+// Отклонения (spur) от предыдущего маршрута считаются параллельно в пуле
+// TaskScheduler, у каждого потока своя рабочая область; кандидаты - в куче
+// с отсевом повторов. Отклонения ищутся только начиная с точки, где маршрут
+// сам отклонился от своего предка (оптимизация Лоулера).
+class KShortestPaths
+{
+public:
+    struct Route
+    {
+        std::vector<int> stations;
+        std::vector<int> pipeIds;
+        double length = 0.0;     // км
+        double bottleneck = 0.0; // минимальная пропускная способность трубы, м³/час
+    };
+
+    // Маршруты по возрастанию длины; меньше k, если других простых маршрутов нет.
+    // Трубы в ремонте не используются.
+    static std::vector<Route> find(const FlatGraph &graph, int sourceStation, int targetStation, int k);
+};
+
+#endif
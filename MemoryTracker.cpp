@@ -0,0 +1,237 @@
+#include "MemoryTracker.h"
+#include <mutex>
+#include <memory>
+#include <chrono>
+#include <algorithm>
+
+using namespace std;
+
+MemoryTracker::Counters MemoryTracker::counters[static_cast<size_t>(MemoryCategory::Count)];
+
+namespace
+{
+    constexpr size_t MAX_SCRATCH_TAGS = 64; // метки сверх предела не учитываются
+    constexpr int SERIAL_THREAD_SHIFT = 40; // номер замера: поток в старших битах
+
+    // Итоги замеров одного потока по меткам; читаются отчетом из другого потока
+    struct ThreadScratchStats
+    {
+        struct Entry
+        {
+            atomic<int64_t> runs{0};
+            atomic<int64_t> lastPeakBytes{0};
+            atomic<int64_t> maxPeakBytes{0};
+            atomic<int64_t> lastRunTime{0};
+        };
+
+        uint64_t index = 0;
+        uint64_t nextSerial = 0;
+        Entry entries[MAX_SCRATCH_TAGS];
+    };
+
+    // Регистрация меток и потоков - один раз на метку и на поток
+    mutex registryMutex;
+    vector<string> &tagNames()
+    {
+        static vector<string> names;
+        return names;
+    }
+    // Статистика завершившихся потоков остается в отчете
+    vector<unique_ptr<ThreadScratchStats>> &threadStats()
+    {
+        static vector<unique_ptr<ThreadScratchStats>> stats;
+        return stats;
+    }
+
+    thread_local ThreadScratchStats *localStats = nullptr;
+    thread_local MemoryTracker::ScratchScope *currentScope = nullptr;
+
+    ThreadScratchStats &threadScratchStats()
+    {
+        if (!localStats)
+        {
+            lock_guard<mutex> lock(registryMutex);
+            threadStats().push_back(make_unique<ThreadScratchStats>());
+            localStats = threadStats().back().get();
+            localStats->index = threadStats().size() - 1;
+        }
+        return *localStats;
+    }
+}
+
+void MemoryTracker::recordAllocation(MemoryCategory category, size_t bytes)
+{
+    Counters &counter = counters[static_cast<size_t>(category)];
+    int64_t live = counter.liveBytes.fetch_add(static_cast<int64_t>(bytes)) + static_cast<int64_t>(bytes);
+    counter.liveAllocations.fetch_add(1);
+    counter.totalAllocations.fetch_add(1);
+
+    int64_t peak = counter.peakBytes.load();
+    while (live > peak && !counter.peakBytes.compare_exchange_weak(peak, live))
+    {
+    }
+
+    if (category == MemoryCategory::Scratch)
+    {
+        for (ScratchScope *scope = currentScope; scope; scope = scope->parent)
+        {
+            scope->add(static_cast<int64_t>(bytes));
+        }
+    }
+}
+
+void MemoryTracker::recordDeallocation(MemoryCategory category, size_t bytes)
+{
+    Counters &counter = counters[static_cast<size_t>(category)];
+    counter.liveBytes.fetch_sub(static_cast<int64_t>(bytes));
+    counter.liveAllocations.fetch_sub(1);
+
+    if (category == MemoryCategory::Scratch)
+    {
+        for (ScratchScope *scope = currentScope; scope; scope = scope->parent)
+        {
+            scope->add(-static_cast<int64_t>(bytes));
+        }
+    }
+}
+
+MemoryCategoryStats MemoryTracker::getStats(MemoryCategory category)
+{
+    const Counters &counter = counters[static_cast<size_t>(category)];
+    MemoryCategoryStats stats;
+    stats.name = categoryName(category);
+    stats.liveBytes = counter.liveBytes.load();
+    stats.liveAllocations = counter.liveAllocations.load();
+    stats.totalAllocations = counter.totalAllocations.load();
+    stats.peakBytes = counter.peakBytes.load();
+    return stats;
+}
+
+vector<AlgorithmScratchStats> MemoryTracker::getAlgorithmStats()
+{
+    lock_guard<mutex> lock(registryMutex);
+    vector<AlgorithmScratchStats> result;
+    for (size_t tag = 0; tag < tagNames().size() && tag < MAX_SCRATCH_TAGS; tag++)
+    {
+        AlgorithmScratchStats stats;
+        stats.algorithm = tagNames()[tag];
+        int64_t lastRunTime = 0;
+        for (const auto &thread : threadStats())
+        {
+            const ThreadScratchStats::Entry &entry = thread->entries[tag];
+            int64_t runs = entry.runs.load(memory_order_acquire);
+            if (runs == 0)
+                continue;
+            stats.runs += runs;
+            stats.maxPeakBytes = max(stats.maxPeakBytes, entry.maxPeakBytes.load(memory_order_relaxed));
+            if (entry.lastRunTime.load(memory_order_relaxed) >= lastRunTime)
+            {
+                lastRunTime = entry.lastRunTime.load(memory_order_relaxed);
+                stats.lastPeakBytes = entry.lastPeakBytes.load(memory_order_relaxed);
+            }
+        }
+        if (stats.runs > 0)
+        {
+            result.push_back(stats);
+        }
+    }
+    sort(result.begin(), result.end(), [](const AlgorithmScratchStats &a, const AlgorithmScratchStats &b)
+         { return a.algorithm < b.algorithm; });
+    return result;
+}
+
+string MemoryTracker::categoryName(MemoryCategory category)
+{
+    switch (category)
+    {
+    case MemoryCategory::Pipes:
+        return "pipes";
+    case MemoryCategory::Stations:
+        return "stations";
+    case MemoryCategory::Adjacency:
+        return "adjacency";
+    case MemoryCategory::Indexes:
+        return "indexes";
+    case MemoryCategory::Scratch:
+        return "scratch";
+    case MemoryCategory::Count:
+        break;
+    }
+    return "unknown";
+}
+
+MemoryTracker::ScratchTag::ScratchTag(const char *algorithm)
+{
+    lock_guard<mutex> lock(registryMutex);
+    id = tagNames().size();
+    tagNames().push_back(algorithm);
+}
+
+MemoryTracker::ScratchScope::ScratchScope(const ScratchTag &tag)
+    : tag(tag.getId()), parent(currentScope)
+{
+    ThreadScratchStats &stats = threadScratchStats();
+    serial = (stats.index << SERIAL_THREAD_SHIFT) | ++stats.nextSerial;
+    currentScope = this;
+}
+
+MemoryTracker::ScratchScope::~ScratchScope()
+{
+    currentScope = parent;
+    // Занятые запуском буферы рабочих областей освобождаются для внешних замеров
+    int64_t reusedBytes = reused.load(memory_order_relaxed);
+    for (ScratchScope *scope = parent; scope && reusedBytes > 0; scope = scope->parent)
+    {
+        scope->add(-reusedBytes);
+    }
+
+    if (tag >= MAX_SCRATCH_TAGS)
+    {
+        return;
+    }
+    ThreadScratchStats::Entry &entry = threadScratchStats().entries[tag];
+    int64_t peakBytes = peak.load(memory_order_relaxed);
+    entry.lastPeakBytes.store(peakBytes, memory_order_relaxed);
+    entry.maxPeakBytes.store(max(entry.maxPeakBytes.load(memory_order_relaxed), peakBytes), memory_order_relaxed);
+    entry.lastRunTime.store(chrono::steady_clock::now().time_since_epoch().count(), memory_order_relaxed);
+    entry.runs.fetch_add(1, memory_order_release);
+}
+
+void MemoryTracker::ScratchScope::add(int64_t delta)
+{
+    int64_t live = bytes.fetch_add(delta, memory_order_relaxed) + delta;
+    int64_t seen = peak.load(memory_order_relaxed);
+    while (live > seen && !peak.compare_exchange_weak(seen, live, memory_order_relaxed))
+    {
+    }
+}
+
+MemoryTracker::ScratchScope *MemoryTracker::ScratchScope::current()
+{
+    return currentScope;
+}
+
+void MemoryTracker::ScratchScope::reuse(uint64_t &notedSerial, int64_t bytes)
+{
+    ScratchScope *scope = currentScope;
+    if (!scope || bytes <= 0 || notedSerial == scope->serial)
+    {
+        return;
+    }
+    notedSerial = scope->serial;
+    for (ScratchScope *outer = scope; outer; outer = outer->parent)
+    {
+        outer->add(bytes);
+    }
+    scope->reused.fetch_add(bytes, memory_order_relaxed);
+}
+
+MemoryTracker::ScratchScope::Attach::Attach(ScratchScope *scope) : saved(currentScope)
+{
+    currentScope = scope;
+}
+
+MemoryTracker::ScratchScope::Attach::~Attach()
+{
+    currentScope = saved;
+}
@@ -0,0 +1,194 @@
+#ifndef MEMORY_TRACKER_H
+#define MEMORY_TRACKER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <new>
+#include <string>
+#include <vector>
+
+// Подсистемы, по которым ведется учет памяти
+enum class MemoryCategory
+{
+    Pipes,     // хранилище труб
+    Stations,  // хранилище станций
+    Adjacency, // списки смежности графа
+    Indexes,   // множества вершин и прочие индексы
+    Scratch,   // временные буферы алгоритмов
+    Count
+};
+
+// Статистика по одной подсистеме
+struct MemoryCategoryStats
+{
+    std::string name;
+    int64_t liveBytes = 0;
+    int64_t liveAllocations = 0;
+    int64_t totalAllocations = 0;
+    int64_t peakBytes = 0;
+};
+
+// Пиковое потребление временной памяти одним алгоритмом (по всем потокам)
+struct AlgorithmScratchStats
+{
+    std::string algorithm;
+    int64_t runs = 0;
+    int64_t lastPeakBytes = 0;
+    int64_t maxPeakBytes = 0;
+};
+
+// Сводный отчет о памяти сети
+struct MemoryReport
+{
+    std::vector<MemoryCategoryStats> categories;
+    std::vector<AlgorithmScratchStats> algorithms;
+    size_t pipeCount = 0;
+    size_t stationCount = 0;
+    size_t edgeCount = 0;
+    int64_t pipeNameBytes = 0; // строки имен вне SSO (оценка по capacity)
+    int64_t stationNameBytes = 0;
+};
+
+// Счетчики выделений памяти по подсистемам (общие для процесса)
+class MemoryTracker
+{
+private:
+    struct alignas(64) Counters
+    {
+        std::atomic<int64_t> liveBytes{0};
+        std::atomic<int64_t> liveAllocations{0};
+        std::atomic<int64_t> totalAllocations{0};
+        std::atomic<int64_t> peakBytes{0};
+    };
+
+    static Counters counters[static_cast<size_t>(MemoryCategory::Count)];
+
+public:
+    static void recordAllocation(MemoryCategory category, size_t bytes);
+    static void recordDeallocation(MemoryCategory category, size_t bytes);
+
+    static MemoryCategoryStats getStats(MemoryCategory category);
+    static std::vector<AlgorithmScratchStats> getAlgorithmStats();
+    static std::string categoryName(MemoryCategory category);
+
+    // Метка алгоритма для замеров: объявляется статической в месте замера,
+    // имя регистрируется один раз, дальше замер обходится без строк и общей блокировки
+    class ScratchTag
+    {
+    private:
+        size_t id;
+
+    public:
+        explicit ScratchTag(const char *algorithm);
+        size_t getId() const { return id; }
+    };
+
+    // Замер пика временной памяти одного запуска алгоритма. В пик входят выделения
+    // в вызывающем потоке и в задачах пула, поставленных внутри замера (TaskScheduler
+    // переносит замер в задачу), и уже выделенные буферы рабочих областей, занятые
+    // запуском (reuse): иначе повторный запуск на тех же буферах показал бы ноль.
+    // Вложенные замеры допускаются: выделение входит в пик каждого открытого замера.
+    // Итог пишется в статистику потока, закрывшего замер, без общей блокировки.
+    class ScratchScope
+    {
+    private:
+        size_t tag;
+        ScratchScope *parent;
+        uint64_t serial; // номер замера, уникальный в процессе
+        std::atomic<int64_t> bytes{0};
+        std::atomic<int64_t> peak{0};
+        std::atomic<int64_t> reused{0};
+
+        void add(int64_t delta);
+        friend class MemoryTracker;
+
+    public:
+        explicit ScratchScope(const ScratchTag &tag);
+        ~ScratchScope();
+
+        ScratchScope(const ScratchScope &) = delete;
+        ScratchScope &operator=(const ScratchScope &) = delete;
+
+        // Замер текущего потока (открытый в нем или перенесенный в задачу) или nullptr
+        static ScratchScope *current();
+
+        // Буферы прошлых запусков, занятые до конца текущего замера. notedSerial -
+        // номер замера, в котором буфер уже учтен: повторный prepare не удваивает пик
+        static void reuse(uint64_t &notedSerial, int64_t bytes);
+
+        // Байты уже выделенного буфера, которые займут count элементов
+        template <typename Vector>
+        static int64_t reusedBytes(const Vector &buffer, size_t count)
+        {
+            size_t used = buffer.capacity() < count ? buffer.capacity() : count;
+            return static_cast<int64_t>(used * sizeof(typename Vector::value_type));
+        }
+
+        // Задача пула выполняется внутри замера, открытого при ее постановке
+        class Attach
+        {
+        private:
+            ScratchScope *saved;
+
+        public:
+            explicit Attach(ScratchScope *scope);
+            ~Attach();
+
+            Attach(const Attach &) = delete;
+            Attach &operator=(const Attach &) = delete;
+        };
+    };
+};
+
+// Аллокатор для контейнеров STL, относящий память к подсистеме Category
+template <typename T, MemoryCategory Category>
+class TrackingAllocator
+{
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind
+    {
+        using other = TrackingAllocator<U, Category>;
+    };
+
+    TrackingAllocator() noexcept = default;
+
+    template <typename U>
+    TrackingAllocator(const TrackingAllocator<U, Category> &) noexcept {}
+
+    T *allocate(size_t count)
+    {
+        size_t bytes = count * sizeof(T);
+        T *memory = static_cast<T *>(::operator new(bytes));
+        MemoryTracker::recordAllocation(Category, bytes);
+        return memory;
+    }
+
+    void deallocate(T *memory, size_t count) noexcept
+    {
+        MemoryTracker::recordDeallocation(Category, count * sizeof(T));
+        ::operator delete(memory);
+    }
+
+    template <typename U>
+    bool operator==(const TrackingAllocator<U, Category> &) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const TrackingAllocator<U, Category> &) const noexcept { return false; }
+};
+
+// Временные контейнеры алгоритмов с учетом в категории Scratch
+template <typename T>
+using ScratchVector = std::vector<T, TrackingAllocator<T, MemoryCategory::Scratch>>;
+
+// Постоянные расчетные индексы (плоские графы и т.п.) с учетом в категории Indexes
+template <typename T>
+using IndexVector = std::vector<T, TrackingAllocator<T, MemoryCategory::Indexes>>;
+
+template <typename K, typename V>
+using ScratchMap = std::map<K, V, std::less<K>, TrackingAllocator<std::pair<const K, V>, MemoryCategory::Scratch>>;
+
+#endif
@@ -1,4 +1,5 @@
 #include "NetworkCalculator.h"
+#include "TaskScheduler.h"
 #include <cmath>
 #include <map>
 
@@ -12,6 +13,11 @@ const map<int, double> NetworkCalculator::DIAMETER_CAPACITY = {
     {1400, 55.0}  // 1400 мм - 55.0 млн м³/сутки
 };
 
+const map<int, double> NetworkCalculator::SHOP_CAPACITY = {
+    {1, 10.0}, // класс 1 - 10 млн м³/сутки на цех
+    {2, 20.0},
+    {3, 35.0}};
+
 double NetworkCalculator::calculatePipeCapacity(double length_km, int diameter_mm, bool isUnderRepair)
 {
     // Если труба в ремонте, производительность = 0
@@ -44,6 +50,24 @@ double NetworkCalculator::calculatePipeCapacity(double length_km, int diameter_m
     return capacity;
 }
 
+double NetworkCalculator::calculateStationCapacity(int workingShops, int stationClass)
+{
+    // Классы вне таблицы - по ближайшему табличному
+    auto it = SHOP_CAPACITY.upper_bound(stationClass);
+    if (it != SHOP_CAPACITY.begin())
+    {
+        --it;
+    }
+    double shopCapacity = it->second * 1e6 / 24.0;
+
+    // Все цеха остановлены - только обводная линия
+    if (workingShops <= 0)
+    {
+        return BYPASS_SHARE * shopCapacity;
+    }
+    return workingShops * shopCapacity;
+}
+
 double NetworkCalculator::calculateEdgeWeight(double length_km, bool isUnderRepair)
 {
     // Если труба в ремонте, вес = бесконечность
@@ -56,198 +80,386 @@ double NetworkCalculator::calculateEdgeWeight(double length_km, bool isUnderRepa
     return length_km;
 }
 
-vector<int> NetworkCalculator::findShortestPath(
-    const Graph &graph,
-    const PipelineNetwork &network,
+const FlatGraph &NetworkCalculator::cachedFlatGraph(const Graph &graph, const PipelineNetwork &network)
+{
+    thread_local FlatGraph cache;
+    if (!cache.isBuiltFrom(graph, network))
+    {
+        cache.build(graph, network);
+    }
+    return cache;
+}
+
+void NetworkCalculator::buildStationGraph(FlatGraph &flat, const Graph &graph, const PipelineNetwork &network, bool splitAll)
+{
+    const FlatGraph &base = cachedFlatGraph(graph, network);
+    int n = base.getNodeCount();
+
+    vector<double> nodeCapacity(n, -1.0);
+    for (int v = 0; v < n; v++)
+    {
+        const CompressorStation *station = network.getStationById(base.stationAt(v));
+        double capacity = station ? calculateStationCapacity(station->getWorkingShops(), station->getStationClass())
+                                  : INF;
+        if (splitAll)
+        {
+            nodeCapacity[v] = capacity;
+            continue;
+        }
+
+        // Ограничение сработает, только если трубы могут унести больше
+        double outgoing = 0.0;
+        for (int a = base.arcBegin(v); a < base.arcEnd(v); a++)
+        {
+            if (base.arc(a).forward)
+                outgoing += base.arc(a).capacity;
+        }
+        if (capacity < outgoing)
+        {
+            nodeCapacity[v] = capacity;
+        }
+    }
+
+    flat.buildSplit(base, nodeCapacity);
+}
+
+const FlatGraph &NetworkCalculator::cachedStationGraph(const Graph &graph, const PipelineNetwork &network, bool splitAll)
+{
+    thread_local FlatGraph cache[2];
+    FlatGraph &flat = cache[splitAll ? 1 : 0];
+    if (!flat.isBuiltFrom(graph, network))
+    {
+        buildStationGraph(flat, graph, network, splitAll);
+    }
+    return flat;
+}
+
+CalculationWorkspace &NetworkCalculator::threadWorkspace()
+{
+    thread_local CalculationWorkspace workspace;
+    return workspace;
+}
+
+bool NetworkCalculator::findShortestPath(
+    const FlatGraph &graph,
+    CalculationWorkspace &workspace,
     int sourceStation,
     int targetStation,
+    vector<int> &path,
     double &totalDistance)
 {
-    vector<int> path;
+    path.clear();
     totalDistance = 0.0;
 
-    // Проверка существования станций
-    if (!network.stationExists(sourceStation) || !network.stationExists(targetStation))
+    int source = graph.nodeOf(sourceStation);
+    int target = graph.nodeOf(targetStation);
+    if (source < 0 || target < 0)
     {
-        cout << "❌ Одна из указанных станций не существует!" << endl;
-        return path;
+        return false;
     }
 
-    // Получаем список всех вершин
-    set<int> vertices;
+    // Без циклов куча не нужна: достаточно одного прохода в топологическом порядке
+    if (graph.isAcyclic())
+    {
+        return findAcyclicPath(graph, workspace, sourceStation, targetStation, false, path, totalDistance);
+    }
 
-    // Для простоты используем список смежности из графа
-    // В реальности нужно получить все вершины из adjacencyList и vertexIds
+    workspace.beginQuery();
+    workspace.touch(source, 0.0, -1);
 
-    // Получаем все соединения
-    auto connections = graph.getConnectionsWithPipe();
+    // Очередь с приоритетом на массиве рабочей области (min-куча)
+    auto &heap = workspace.heap;
+    auto byDistance = greater<pair<double, int>>();
+    heap.clear();
+    heap.push_back({0.0, source});
 
-    if (connections.empty())
+    // Алгоритм Дейкстры
+    while (!heap.empty())
     {
-        cout << "❌ В сети нет соединений!" << endl;
-        return path;
-    }
+        pop_heap(heap.begin(), heap.end(), byDistance);
+        auto [currentDist, u] = heap.back();
+        heap.pop_back();
 
-    // Создаем граф для алгоритма Дейкстры
-    map<int, vector<pair<int, double>>> adjList;
-    map<int, double> dist;
-    map<int, int> prev;
+        if (currentDist > workspace.distance[u])
+            continue;
 
-    // Инициализация
-    for (const auto &conn : connections)
-    {
-        int u = conn.first;
-        int v = conn.second.first;
-        int pipeId = conn.second.second;
+        if (u == target)
+            break;
 
-        const Pipe *pipe = network.getPipeById(pipeId);
-        if (pipe)
+        for (int a = graph.arcBegin(u); a < graph.arcEnd(u); a++)
         {
-            double weight = calculateEdgeWeight(pipe->getLength(), pipe->isUnderRepair());
-            adjList[u].push_back({v, weight});
+            const FlatGraph::Arc &arc = graph.arc(a);
+            // Обратные дуги и трубы в ремонте (вес INF) не проходимы
+            if (!arc.forward || arc.length >= INF)
+                continue;
+
+            double newDist = currentDist + arc.length;
+            int v = arc.head;
+            if (!workspace.isTouched(v) || newDist < workspace.distance[v])
+            {
+                workspace.touch(v, newDist, a);
+                heap.push_back({newDist, v});
+                push_heap(heap.begin(), heap.end(), byDistance);
+            }
         }
+    }
 
-        // Добавляем вершины в карту расстояний
-        dist[u] = INF;
-        dist[v] = INF;
-        prev[u] = -1;
-        prev[v] = -1;
+    if (!workspace.isTouched(target))
+    {
+        return false;
     }
 
-    // Инициализация источника
-    dist[sourceStation] = 0;
+    // Восстанавливаем путь от цели к источнику по дугам-родителям
+    totalDistance = workspace.distance[target];
+    for (int v = target; v != source; v = graph.arc(workspace.parentArc[v]).tail)
+    {
+        path.push_back(graph.stationAt(v));
+    }
+    path.push_back(sourceStation);
+    reverse(path.begin(), path.end());
+    return true;
+}
 
-    // Очередь с приоритетом для алгоритма Дейкстры
-    priority_queue<pair<double, int>, vector<pair<double, int>>, greater<pair<double, int>>> pq;
-    pq.push({0, sourceStation});
+bool NetworkCalculator::findAcyclicPath(
+    const FlatGraph &graph,
+    CalculationWorkspace &workspace,
+    int sourceStation,
+    int targetStation,
+    bool longest,
+    vector<int> &path,
+    double &totalDistance)
+{
+    path.clear();
+    totalDistance = 0.0;
 
-    // Алгоритм Дейкстры
-    while (!pq.empty())
+    int source = graph.nodeOf(sourceStation);
+    int target = graph.nodeOf(targetStation);
+    if (!graph.isAcyclic() || source < 0 || target < 0)
     {
-        auto [currentDist, u] = pq.top();
-        pq.pop();
+        return false;
+    }
 
-        if (currentDist > dist[u])
-            continue;
+    workspace.beginQuery();
+    workspace.touch(source, 0.0, -1);
 
-        if (u == targetStation)
-            break;
+    // Узлы между источником и стоком в топологическом порядке: к моменту обработки
+    // узла все входящие в него дуги уже релаксированы
+    int first = graph.topologicalIndex(source);
+    int last = graph.topologicalIndex(target);
+    for (int position = first; position < last; position++)
+    {
+        int u = graph.topologicalNode(position);
+        if (!workspace.isTouched(u))
+            continue;
 
-        for (const auto &[v, weight] : adjList[u])
+        double currentDist = workspace.distance[u];
+        for (int a = graph.arcBegin(u); a < graph.arcEnd(u); a++)
         {
-            double newDist = dist[u] + weight;
-            if (newDist < dist[v])
+            const FlatGraph::Arc &arc = graph.arc(a);
+            if (!arc.forward || arc.length >= INF)
+                continue;
+
+            double newDist = currentDist + arc.length;
+            int v = arc.head;
+            if (!workspace.isTouched(v) || (longest ? newDist > workspace.distance[v] : newDist < workspace.distance[v]))
             {
-                dist[v] = newDist;
-                prev[v] = u;
-                pq.push({newDist, v});
+                workspace.touch(v, newDist, a);
             }
         }
     }
 
-    // Восстанавливаем путь
-    if (dist[targetStation] < INF)
+    if (!workspace.isTouched(target))
+    {
+        return false;
+    }
+
+    totalDistance = workspace.distance[target];
+    for (int v = target; v != source; v = graph.arc(workspace.parentArc[v]).tail)
     {
-        totalDistance = dist[targetStation];
+        path.push_back(graph.stationAt(v));
+    }
+    path.push_back(sourceStation);
+    reverse(path.begin(), path.end());
+    return true;
+}
+
+bool NetworkCalculator::findLongestPath(
+    const FlatGraph &graph,
+    CalculationWorkspace &workspace,
+    int sourceStation,
+    int targetStation,
+    vector<int> &path,
+    double &totalDistance)
+{
+    return findAcyclicPath(graph, workspace, sourceStation, targetStation, true, path, totalDistance);
+}
 
-        // Восстановление пути от цели к источнику
-        int current = targetStation;
-        while (current != -1)
+void NetworkCalculator::findReachableStations(
+    const FlatGraph &graph,
+    CalculationWorkspace &workspace,
+    int sourceStation,
+    vector<int> &stations)
+{
+    stations.clear();
+
+    int source = graph.nodeOf(sourceStation);
+    if (source < 0)
+    {
+        return;
+    }
+
+    if (graph.isAcyclic())
+    {
+        workspace.beginQuery();
+        workspace.touch(source, 0.0, -1);
+
+        auto relax = [&](int u)
         {
-            path.push_back(current);
-            current = prev[current];
-        }
+            for (int a = graph.arcBegin(u); a < graph.arcEnd(u); a++)
+            {
+                const FlatGraph::Arc &arc = graph.arc(a);
+                if (arc.forward && arc.length < INF && !workspace.isTouched(arc.head))
+                    workspace.touch(arc.head, 0.0, a);
+            }
+        };
 
-        // Переворачиваем путь
-        reverse(path.begin(), path.end());
+        // Достижимое лежит в топологическом порядке после источника
+        for (int position = graph.topologicalIndex(source); position < graph.getNodeCount(); position++)
+        {
+            int u = graph.topologicalNode(position);
+            if (workspace.isTouched(u))
+            {
+                relax(u);
+                stations.push_back(graph.stationAt(u));
+            }
+        }
     }
     else
     {
-        cout << "❌ Путь между станциями " << sourceStation
-             << " и " << targetStation << " не найден!" << endl;
+        FrontierBfs::Options options;
+        options.parallel = true;
+        workspace.bfs.run(graph, source, options);
+        stations.reserve(workspace.bfs.getVisitedCount());
+        for (int v = 0; v < graph.getNodeCount(); v++)
+        {
+            if (workspace.bfs.isVisited(v))
+                stations.push_back(graph.stationAt(v));
+        }
     }
 
-    return path;
+    sort(stations.begin(), stations.end());
 }
 
-double NetworkCalculator::calculateMaxFlow(
-    const Graph &graph,
-    const PipelineNetwork &network,
+bool NetworkCalculator::findWidestPath(
+    const FlatGraph &graph,
+    CalculationWorkspace &workspace,
     int sourceStation,
-    int targetStation)
+    int targetStation,
+    vector<int> &path,
+    double &bottleneck)
 {
-    // Проверка существования станций
-    if (!network.stationExists(sourceStation) || !network.stationExists(targetStation))
+    path.clear();
+    bottleneck = 0.0;
+
+    int source = graph.nodeOf(sourceStation);
+    int target = graph.nodeOf(targetStation);
+    if (source < 0 || target < 0)
     {
-        cout << "❌ Одна из указанных станций не существует!" << endl;
-        return 0.0;
+        return false;
     }
 
-    // Получаем все соединения
-    auto connections = graph.getConnectionsWithPipe();
+    workspace.beginQuery();
+    workspace.touch(source, INF, -1);
 
-    if (connections.empty())
+    // Max-куча по ширине пути; distance хранит лучшую найденную ширину
+    auto &heap = workspace.heap;
+    auto byWidth = less<pair<double, int>>();
+    heap.clear();
+    heap.push_back({INF, source});
+
+    while (!heap.empty())
     {
-        cout << "❌ В сети нет соединений!" << endl;
-        return 0.0;
-    }
+        pop_heap(heap.begin(), heap.end(), byWidth);
+        auto [currentWidth, u] = heap.back();
+        heap.pop_back();
 
-    // Создаем граф для алгоритма Форда-Фалкерсона
-    map<int, map<int, double>> capacity;
-    map<int, map<int, double>> flow;
+        if (currentWidth < workspace.distance[u])
+            continue;
 
-    // Инициализация графа пропускных способностей
-    for (const auto &conn : connections)
-    {
-        int u = conn.first;
-        int v = conn.second.first;
-        int pipeId = conn.second.second;
+        if (u == target)
+            break;
 
-        const Pipe *pipe = network.getPipeById(pipeId);
-        if (pipe)
+        for (int a = graph.arcBegin(u); a < graph.arcEnd(u); a++)
         {
-            double cap = calculatePipeCapacity(
-                pipe->getLength(),
-                pipe->getDiameter(),
-                pipe->isUnderRepair());
-            capacity[u][v] = cap;
-            flow[u][v] = 0.0;
-
-            // Добавляем обратное ребро с нулевой пропускной способностью
-            capacity[v][u] = 0.0;
-            flow[v][u] = 0.0;
+            const FlatGraph::Arc &arc = graph.arc(a);
+            if (!arc.forward || arc.capacity <= FLOW_EPSILON)
+                continue;
+
+            double newWidth = min(currentWidth, arc.capacity);
+            int v = arc.head;
+            if (!workspace.isTouched(v) || newWidth > workspace.distance[v])
+            {
+                workspace.touch(v, newWidth, a);
+                heap.push_back({newWidth, v});
+                push_heap(heap.begin(), heap.end(), byWidth);
+            }
         }
     }
 
-    // Алгоритм Форда-Фалкерсона
-    double maxFlow = 0.0;
+    if (!workspace.isTouched(target) || source == target)
+    {
+        return false;
+    }
 
-    while (true)
+    bottleneck = workspace.distance[target];
+    for (int v = target; v != source; v = graph.arc(workspace.parentArc[v]).tail)
     {
-        // Поиск увеличивающего пути с помощью BFS
-        map<int, int> parent;
-        queue<int> q;
-        q.push(sourceStation);
-        parent[sourceStation] = -1;
+        path.push_back(graph.stationAt(v));
+    }
+    path.push_back(sourceStation);
+    reverse(path.begin(), path.end());
+    return true;
+}
 
-        bool foundPath = false;
+double NetworkCalculator::augmentFlow(
+    const FlatGraph &graph,
+    CalculationWorkspace &workspace,
+    int sourceNode,
+    int targetNode,
+    double limit)
+{
+    if (sourceNode < 0 || targetNode < 0 || sourceNode == targetNode)
+    {
+        return 0.0;
+    }
 
-        while (!q.empty() && !foundPath)
-        {
-            int u = q.front();
-            q.pop();
+    auto &queue = workspace.queue;
+    double addedFlow = 0.0;
+
+    while (limit - addedFlow > FLOW_EPSILON)
+    {
+        // Поиск увеличивающего пути с помощью BFS (очередь - массив рабочей области)
+        workspace.beginQuery();
+        workspace.touch(sourceNode, 0.0, -1);
+        queue.clear();
+        queue.push_back(sourceNode);
 
-            for (const auto &[v, cap] : capacity[u])
+        bool foundPath = false;
+        for (size_t head = 0; head < queue.size() && !foundPath; head++)
+        {
+            int u = queue[head];
+            for (int a = graph.arcBegin(u); a < graph.arcEnd(u); a++)
             {
-                if (parent.find(v) == parent.end() && cap > flow[u][v])
+                int v = graph.arc(a).head;
+                if (!workspace.isTouched(v) && workspace.residual(graph, a) > FLOW_EPSILON)
                 {
-                    parent[v] = u;
-                    if (v == targetStation)
+                    workspace.touch(v, 0.0, a);
+                    if (v == targetNode)
                     {
                         foundPath = true;
                         break;
                     }
-                    q.push(v);
+                    queue.push_back(v);
                 }
             }
         }
@@ -257,27 +469,673 @@ double NetworkCalculator::calculateMaxFlow(
             break;
 
         // Находим минимальную остаточную пропускную способность
-        double pathFlow = INF;
-        for (int v = targetStation; v != sourceStation; v = parent[v])
+        double pathFlow = limit - addedFlow;
+        for (int v = targetNode; v != sourceNode; v = graph.arc(workspace.parentArc[v]).tail)
         {
-            int u = parent[v];
-            pathFlow = min(pathFlow, capacity[u][v] - flow[u][v]);
+            pathFlow = min(pathFlow, workspace.residual(graph, workspace.parentArc[v]));
         }
 
-        // Обновляем поток
-        for (int v = targetStation; v != sourceStation; v = parent[v])
+        // Обновляем поток (прямая и парная обратная дуга)
+        for (int v = targetNode; v != sourceNode; v = graph.arc(workspace.parentArc[v]).tail)
+        {
+            workspace.addFlow(graph, workspace.parentArc[v], pathFlow);
+        }
+
+        addedFlow += pathFlow;
+    }
+
+    return addedFlow;
+}
+
+double NetworkCalculator::reduceArcFlow(
+    const FlatGraph &graph,
+    CalculationWorkspace &workspace,
+    int arc,
+    double newCapacity,
+    int sourceNode,
+    int targetNode)
+{
+    workspace.setCapacity(arc, newCapacity);
+
+    double excess = workspace.flow[arc] - newCapacity;
+    if (excess <= FLOW_EPSILON)
+    {
+        return 0.0;
+    }
+
+    int u = graph.arc(arc).tail;
+    int v = graph.arc(arc).head;
+
+    // 1. Пробуем перенаправить избыток в обход дуги: u -> ... -> v
+    double rerouted = augmentFlow(graph, workspace, u, v, excess);
+    workspace.addFlow(graph, arc, -excess);
+
+    // 2. Остаток нельзя провести: в u образовался избыток, в v - недостача.
+    //    Возвращаем избыток от u к источнику и недостачу покрываем от стока,
+    //    поток s -> t уменьшается ровно на эту величину.
+    double cancelled = excess - rerouted;
+    if (cancelled > FLOW_EPSILON)
+    {
+        if (u != sourceNode)
         {
-            int u = parent[v];
-            flow[u][v] += pathFlow;
-            flow[v][u] -= pathFlow;
+            augmentFlow(graph, workspace, u, sourceNode, cancelled);
         }
+        if (v != targetNode)
+        {
+            augmentFlow(graph, workspace, targetNode, v, cancelled);
+        }
+        return cancelled;
+    }
 
-        maxFlow += pathFlow;
+    return 0.0;
+}
+
+double NetworkCalculator::calculateMaxFlow(
+    const FlatGraph &graph,
+    CalculationWorkspace &workspace,
+    int sourceStation,
+    int targetStation,
+    MinCut *cut)
+{
+    workspace.resetFlow();
+
+    int source = graph.nodeOf(sourceStation);
+    int target = graph.nodeOf(targetStation);
+    double maxFlow = augmentFlow(graph, workspace, source, target, INF);
+
+    if (cut)
+    {
+        *cut = MinCut();
+        if (source >= 0 && target >= 0 && source != target)
+        {
+            extractMinCut(graph, workspace, *cut);
+        }
     }
 
     return maxFlow;
 }
 
+double NetworkCalculator::calculateMinCostFlow(
+    const FlatGraph &graph,
+    CalculationWorkspace &workspace,
+    int sourceStation,
+    int targetStation,
+    double volume,
+    double &totalCost)
+{
+    workspace.resetFlow();
+    totalCost = 0.0;
+
+    int source = graph.nodeOf(sourceStation);
+    int target = graph.nodeOf(targetStation);
+    if (source < 0 || target < 0 || source == target || volume <= FLOW_EPSILON)
+    {
+        return 0.0;
+    }
+
+    // Длины труб неотрицательны, поэтому нулевые потенциалы допустимы
+    auto &potential = workspace.potential;
+    fill(potential.begin(), potential.begin() + graph.getNodeCount(), 0.0);
+
+    auto &heap = workspace.heap;
+    auto &settled = workspace.queue;
+    auto byDistance = greater<pair<double, int>>();
+    double delivered = 0.0;
+
+    while (volume - delivered > FLOW_EPSILON)
+    {
+        // Дейкстра по приведенным стоимостям length + p(u) - p(v) >= 0,
+        // останавливается на стоке
+        workspace.beginQuery();
+        workspace.touch(source, 0.0, -1);
+        heap.clear();
+        heap.push_back({0.0, source});
+        settled.clear();
+
+        bool reached = false;
+        while (!heap.empty())
+        {
+            pop_heap(heap.begin(), heap.end(), byDistance);
+            auto [currentDist, u] = heap.back();
+            heap.pop_back();
+
+            if (currentDist > workspace.distance[u])
+                continue;
+
+            settled.push_back(u);
+            if (u == target)
+            {
+                reached = true;
+                break;
+            }
+
+            for (int a = graph.arcBegin(u); a < graph.arcEnd(u); a++)
+            {
+                if (workspace.residual(graph, a) <= FLOW_EPSILON)
+                    continue;
+
+                const FlatGraph::Arc &arc = graph.arc(a);
+                int v = arc.head;
+                double reducedCost = max(0.0, arc.length + potential[u] - potential[v]);
+                double newDist = currentDist + reducedCost;
+                if (!workspace.isTouched(v) || newDist < workspace.distance[v])
+                {
+                    workspace.touch(v, newDist, a);
+                    heap.push_back({newDist, v});
+                    push_heap(heap.begin(), heap.end(), byDistance);
+                }
+            }
+        }
+
+        if (!reached)
+            break;
+
+        // Обновление потенциалов только для пройденных узлов: p(v) += d(v) - d(t).
+        // Для остальных узлов это эквивалентно общему сдвигу на d(t), который
+        // не меняет приведенных стоимостей.
+        double targetDist = workspace.distance[target];
+        for (int v : settled)
+        {
+            potential[v] += workspace.distance[v] - targetDist;
+        }
+
+        double pathFlow = volume - delivered;
+        double pathCost = 0.0;
+        for (int v = target; v != source; v = graph.arc(workspace.parentArc[v]).tail)
+        {
+            int a = workspace.parentArc[v];
+            pathFlow = min(pathFlow, workspace.residual(graph, a));
+            pathCost += graph.arc(a).length;
+        }
+
+        for (int v = target; v != source; v = graph.arc(workspace.parentArc[v]).tail)
+        {
+            workspace.addFlow(graph, workspace.parentArc[v], pathFlow);
+        }
+
+        delivered += pathFlow;
+        totalCost += pathFlow * pathCost;
+    }
+
+    return delivered;
+}
+
+void NetworkCalculator::buildDisjointGraph(FlatGraph &unit, const FlatGraph &graph, bool stationDisjoint)
+{
+    // Для независимости по станциям каждая станция пропускает одну единицу
+    vector<double> nodeCapacity(graph.getNodeCount(), stationDisjoint ? 1.0 : -1.0);
+    unit.buildSplit(graph, nodeCapacity, true);
+}
+
+vector<DisjointPath> NetworkCalculator::findDisjointPaths(
+    const FlatGraph &graph,
+    const FlatGraph &unit,
+    CalculationWorkspace &workspace,
+    int sourceStation,
+    int targetStation,
+    int k)
+{
+    vector<DisjointPath> paths;
+    if (k <= 0 || sourceStation == targetStation ||
+        unit.nodeOf(sourceStation) < 0 || unit.nodeOf(targetStation) < 0)
+    {
+        return paths;
+    }
+
+    // Из источника выходят все k маршрутов (в сток газ входит без ограничения)
+    workspace.prepare(unit);
+    int sourceNode = unit.nodeOf(sourceStation);
+    for (int a = unit.arcBegin(sourceNode); a < unit.arcEnd(sourceNode); a++)
+    {
+        if (unit.isStationArc(a))
+        {
+            workspace.setCapacity(a, k);
+        }
+    }
+
+    double totalLength = 0.0;
+    int found = static_cast<int>(lround(
+        calculateMinCostFlow(unit, workspace, sourceStation, targetStation, k, totalLength)));
+
+    // Разложение потока на маршруты: идем от источника по дугам с единичным потоком
+    int source = unit.nodeOf(sourceStation);
+    int target = unit.nodeOf(targetStation);
+    for (int p = 0; p < found; p++)
+    {
+        DisjointPath path;
+        path.bottleneck = INF;
+        path.stations.push_back(sourceStation);
+
+        int u = source;
+        while (u != target)
+        {
+            int next = -1;
+            for (int a = unit.arcBegin(u); a < unit.arcEnd(u); a++)
+            {
+                if (unit.arc(a).forward && workspace.flow[a] > 0.5)
+                {
+                    next = a;
+                    break;
+                }
+            }
+            if (next < 0)
+                break;
+
+            const FlatGraph::Arc &arc = unit.arc(next);
+            workspace.addFlow(unit, next, -1.0);
+            if (arc.pipeId >= 0)
+            {
+                path.pipeIds.push_back(arc.pipeId);
+                path.length += arc.length;
+                path.bottleneck = min(path.bottleneck, graph.arc(graph.arcOfPipe(arc.pipeId)).capacity);
+                path.stations.push_back(unit.stationAt(arc.head));
+            }
+            u = arc.head;
+        }
+
+        if (u == target)
+        {
+            paths.push_back(path);
+        }
+    }
+
+    stable_sort(paths.begin(), paths.end(), [](const DisjointPath &a, const DisjointPath &b)
+                { return a.length < b.length; });
+    return paths;
+}
+
+void NetworkCalculator::extractMinCut(
+    const FlatGraph &graph,
+    const CalculationWorkspace &workspace,
+    MinCut &cut)
+{
+    cut.pipes.clear();
+    cut.stations.clear();
+    cut.sourceSide.clear();
+    cut.capacity = 0.0;
+
+    // Сторона источника - узлы, до которых дошел последний поиск пути
+    for (int u = 0; u < graph.getNodeCount(); u++)
+    {
+        if (!workspace.isTouched(u))
+            continue;
+
+        if (graph.stationAt(u) >= 0)
+        {
+            cut.sourceSide.push_back(graph.stationAt(u));
+        }
+
+        // Дуги из стороны источника в сторону стока насыщены и образуют разрез
+        for (int a = graph.arcBegin(u); a < graph.arcEnd(u); a++)
+        {
+            const FlatGraph::Arc &arc = graph.arc(a);
+            if (!arc.forward || workspace.isTouched(arc.head))
+                continue;
+
+            double capacity = workspace.capacity(graph, a);
+            cut.capacity += capacity;
+            if (arc.pipeId >= 0 && capacity > 0.0)
+            {
+                cut.pipes.push_back({arc.pipeId, graph.stationAt(graph.splitInNode(arc.tail)),
+                                     graph.stationAt(arc.head), capacity});
+            }
+            else if (graph.isStationArc(a))
+            {
+                cut.stations.push_back({graph.stationAt(arc.tail), capacity});
+            }
+        }
+    }
+
+    sort(cut.sourceSide.begin(), cut.sourceSide.end());
+}
+
+vector<int> NetworkCalculator::findShortestPath(
+    const Graph &graph,
+    const PipelineNetwork &network,
+    int sourceStation,
+    int targetStation,
+    double &totalDistance)
+{
+    static const MemoryTracker::ScratchTag scratchTag("findShortestPath");
+    MemoryTracker::ScratchScope scratch(scratchTag);
+    vector<int> path;
+    totalDistance = 0.0;
+
+    // Проверка существования станций
+    if (!network.stationExists(sourceStation) || !network.stationExists(targetStation))
+    {
+        cout << "❌ Одна из указанных станций не существует!" << endl;
+        return path;
+    }
+
+    if (graph.isEmpty())
+    {
+        cout << "❌ В сети нет соединений!" << endl;
+        return path;
+    }
+
+    // Плоский граф строится один раз на версию сети, буферы берутся из рабочей области потока
+    const FlatGraph &flat = cachedFlatGraph(graph, network);
+    CalculationWorkspace &workspace = threadWorkspace();
+    workspace.prepare(flat);
+
+    if (!findShortestPath(flat, workspace, sourceStation, targetStation, path, totalDistance))
+    {
+        cout << "❌ Путь между станциями " << sourceStation
+             << " и " << targetStation << " не найден!" << endl;
+    }
+
+    return path;
+}
+
+vector<int> NetworkCalculator::findLongestPath(
+    const Graph &graph,
+    const PipelineNetwork &network,
+    int sourceStation,
+    int targetStation,
+    double &totalDistance)
+{
+    vector<int> path;
+    totalDistance = 0.0;
+
+    // Проверка существования станций
+    if (!network.stationExists(sourceStation) || !network.stationExists(targetStation))
+    {
+        cout << "❌ Одна из указанных станций не существует!" << endl;
+        return path;
+    }
+
+    if (graph.isEmpty())
+    {
+        cout << "❌ В сети нет соединений!" << endl;
+        return path;
+    }
+
+    const FlatGraph &flat = cachedFlatGraph(graph, network);
+    if (!flat.isAcyclic())
+    {
+        cout << "❌ В сети есть циклы - самый длинный путь не определен!" << endl;
+        return path;
+    }
+
+    CalculationWorkspace &workspace = threadWorkspace();
+    workspace.prepare(flat);
+
+    if (!findLongestPath(flat, workspace, sourceStation, targetStation, path, totalDistance))
+    {
+        cout << "❌ Путь между станциями " << sourceStation
+             << " и " << targetStation << " не найден!" << endl;
+    }
+
+    return path;
+}
+
+vector<int> NetworkCalculator::findReachableStations(
+    const Graph &graph,
+    const PipelineNetwork &network,
+    int sourceStation)
+{
+    vector<int> stations;
+    if (!network.stationExists(sourceStation))
+    {
+        cout << "❌ Станция " << sourceStation << " не существует!" << endl;
+        return stations;
+    }
+
+    const FlatGraph &flat = cachedFlatGraph(graph, network);
+    if (flat.nodeOf(sourceStation) < 0)
+    {
+        // Станция без соединений достижима только сама из себя
+        stations.push_back(sourceStation);
+        return stations;
+    }
+
+    CalculationWorkspace &workspace = threadWorkspace();
+    workspace.prepare(flat);
+    findReachableStations(flat, workspace, sourceStation, stations);
+    return stations;
+}
+
+vector<int> NetworkCalculator::findWidestPath(
+    const Graph &graph,
+    const PipelineNetwork &network,
+    int sourceStation,
+    int targetStation,
+    double &bottleneck)
+{
+    static const MemoryTracker::ScratchTag scratchTag("findWidestPath");
+    MemoryTracker::ScratchScope scratch(scratchTag);
+    vector<int> path;
+    bottleneck = 0.0;
+
+    // Проверка существования станций
+    if (!network.stationExists(sourceStation) || !network.stationExists(targetStation))
+    {
+        cout << "❌ Одна из указанных станций не существует!" << endl;
+        return path;
+    }
+
+    if (graph.isEmpty())
+    {
+        cout << "❌ В сети нет соединений!" << endl;
+        return path;
+    }
+
+    const FlatGraph &flat = cachedFlatGraph(graph, network);
+    CalculationWorkspace &workspace = threadWorkspace();
+    workspace.prepare(flat);
+
+    if (!findWidestPath(flat, workspace, sourceStation, targetStation, path, bottleneck))
+    {
+        cout << "❌ Путь между станциями " << sourceStation
+             << " и " << targetStation << " не найден!" << endl;
+    }
+
+    return path;
+}
+
+vector<DisjointPath> NetworkCalculator::findDisjointPaths(
+    const Graph &graph,
+    const PipelineNetwork &network,
+    int sourceStation,
+    int targetStation,
+    int k,
+    bool stationDisjoint)
+{
+    static const MemoryTracker::ScratchTag scratchTag("findDisjointPaths");
+    MemoryTracker::ScratchScope scratch(scratchTag);
+
+    // Проверка существования станций
+    if (!network.stationExists(sourceStation) || !network.stationExists(targetStation))
+    {
+        cout << "❌ Одна из указанных станций не существует!" << endl;
+        return {};
+    }
+
+    if (graph.isEmpty())
+    {
+        cout << "❌ В сети нет соединений!" << endl;
+        return {};
+    }
+
+    const FlatGraph &flat = cachedFlatGraph(graph, network);
+    FlatGraph unit;
+    buildDisjointGraph(unit, flat, stationDisjoint);
+    return findDisjointPaths(flat, unit, threadWorkspace(), sourceStation, targetStation, k);
+}
+
+double NetworkCalculator::calculateMaxFlow(
+    const Graph &graph,
+    const PipelineNetwork &network,
+    int sourceStation,
+    int targetStation,
+    MinCut *cut)
+{
+    static const MemoryTracker::ScratchTag scratchTag("calculateMaxFlow");
+    MemoryTracker::ScratchScope scratch(scratchTag);
+
+    // Проверка существования станций
+    if (!network.stationExists(sourceStation) || !network.stationExists(targetStation))
+    {
+        cout << "❌ Одна из указанных станций не существует!" << endl;
+        return 0.0;
+    }
+
+    if (graph.isEmpty())
+    {
+        cout << "❌ В сети нет соединений!" << endl;
+        return 0.0;
+    }
+
+    const FlatGraph &flat = cachedStationGraph(graph, network);
+    CalculationWorkspace &workspace = threadWorkspace();
+    workspace.prepare(flat);
+
+    return calculateMaxFlow(flat, workspace, sourceStation, targetStation, cut);
+}
+
+MinCostFlowResult NetworkCalculator::calculateMinCostFlow(
+    const Graph &graph,
+    const PipelineNetwork &network,
+    int sourceStation,
+    int targetStation,
+    double volume)
+{
+    static const MemoryTracker::ScratchTag scratchTag("calculateMinCostFlow");
+    MemoryTracker::ScratchScope scratch(scratchTag);
+
+    MinCostFlowResult result;
+    result.requested = volume;
+
+    const FlatGraph &flat = cachedStationGraph(graph, network);
+    CalculationWorkspace &workspace = threadWorkspace();
+    workspace.prepare(flat);
+
+    result.delivered = calculateMinCostFlow(flat, workspace, sourceStation, targetStation, volume, result.totalCost);
+
+    // Распределение по трубам: чистый поток по прямым дугам
+    for (int a : workspace.touchedArcs)
+    {
+        const FlatGraph::Arc &arc = flat.arc(a);
+        if (!arc.forward || arc.pipeId < 0 || workspace.flow[a] <= FLOW_EPSILON)
+            continue;
+        result.pipes.push_back({arc.pipeId, flat.stationAt(flat.splitInNode(arc.tail)), flat.stationAt(arc.head),
+                                workspace.flow[a], workspace.flow[a] * arc.length});
+    }
+    sort(result.pipes.begin(), result.pipes.end(), [](const PipeFlow &a, const PipeFlow &b)
+         { return a.pipeId < b.pipeId; });
+
+    return result;
+}
+
+SupplyDemandResult NetworkCalculator::calculateSupplyDemand(
+    const Graph &graph,
+    const PipelineNetwork &network,
+    const map<int, double> &supply,
+    const map<int, double> &demand)
+{
+    static const MemoryTracker::ScratchTag scratchTag("calculateSupplyDemand");
+    MemoryTracker::ScratchScope scratch(scratchTag);
+
+    SupplyDemandResult result;
+
+    // Плоский граф сети с ограничениями станций плюс два служебных узла; станции
+    // без соединений добавляются отдельными узлами (их заявки останутся непокрытыми)
+    FlatGraph flat;
+    buildStationGraph(flat, graph, network, false);
+
+    auto nodeFor = [&](int stationId)
+    {
+        int node = flat.nodeOf(stationId);
+        return node >= 0 ? node : flat.addNode(stationId);
+    };
+
+    int superSource = flat.addNode(-1);
+    int superSink = flat.addNode(-1);
+
+    for (const auto &entry : supply)
+    {
+        if (entry.second <= 0.0 || !network.stationExists(entry.first))
+            continue;
+        int node = nodeFor(entry.first);
+        flat.addArcPair(superSource, node, -1, entry.second, 0.0);
+        result.totalSupply += entry.second;
+    }
+
+    for (const auto &entry : demand)
+    {
+        if (entry.second <= 0.0 || !network.stationExists(entry.first))
+            continue;
+        int node = nodeFor(entry.first);
+        flat.addArcPair(node, superSink, -1, entry.second, 0.0);
+        result.totalDemand += entry.second;
+    }
+
+    flat.finalize();
+
+    CalculationWorkspace &workspace = threadWorkspace();
+    workspace.prepare(flat);
+    result.delivered = augmentFlow(flat, workspace, superSource, superSink, INF);
+
+    // Фактические объемы - потоки по служебным дугам
+    for (int a = flat.arcBegin(superSource); a < flat.arcEnd(superSource); a++)
+    {
+        const FlatGraph::Arc &arc = flat.arc(a);
+        if (!arc.forward)
+            continue;
+        int station = flat.stationAt(arc.head);
+        double actual = workspace.flow[a];
+        result.supplies.push_back({station, arc.capacity, actual, arc.capacity - actual});
+    }
+    for (int a = flat.arcBegin(superSink); a < flat.arcEnd(superSink); a++)
+    {
+        const FlatGraph::Arc &arc = flat.arc(a);
+        if (arc.forward)
+            continue;
+        // Обратная дуга суперстока: парная прямая идет от потребителя
+        int forward = arc.reverse;
+        int station = flat.stationAt(arc.head);
+        double required = flat.arc(forward).capacity;
+        double actual = workspace.flow[forward];
+        result.demands.push_back({station, required, actual, required - actual});
+    }
+
+    auto byStation = [](const StationBalance &a, const StationBalance &b)
+    { return a.stationId < b.stationId; };
+    sort(result.supplies.begin(), result.supplies.end(), byStation);
+    sort(result.demands.begin(), result.demands.end(), byStation);
+
+    result.feasible = result.totalDemand - result.delivered <= FLOW_EPSILON * max(1.0, result.totalDemand);
+    return result;
+}
+
+vector<vector<double>> NetworkCalculator::calculateMaxFlowMatrix(
+    const Graph &graph,
+    const PipelineNetwork &network,
+    const vector<int> &stations)
+{
+    size_t n = stations.size();
+    vector<vector<double>> matrix(n, vector<double>(n, 0.0));
+
+    // Общий плоский граф только читается; у каждого потока своя рабочая область
+    FlatGraph flat;
+    buildStationGraph(flat, graph, network, false);
+
+    // Каждая пара пишет только в свою ячейку, поэтому результат детерминирован
+    TaskScheduler::instance().parallelFor(0, n * n, 1, [&](size_t cell)
+                                          {
+        size_t i = cell / n;
+        size_t j = cell % n;
+        if (i != j)
+        {
+            CalculationWorkspace &workspace = threadWorkspace();
+            workspace.prepare(flat);
+            matrix[i][j] = calculateMaxFlow(flat, workspace, stations[i], stations[j]);
+        } });
+
+    return matrix;
+}
+
 void NetworkCalculator::displayPath(
     const vector<int> &path,
     const PipelineNetwork &network,
@@ -3,12 +3,88 @@
 
 #include "Graph.h"
 #include "PipelineNetwork.h"
+#include "FlatGraph.h"
+#include "CalculationWorkspace.h"
 #include <vector>
+#include <map>
 #include <queue>
 #include <limits>
 #include <algorithm>
 #include <iostream>
 
+// Труба минимального разреза
+struct CutPipe
+{
+    int pipeId;
+    int fromStation;
+    int toStation;
+    double capacity;
+};
+
+// Станция минимального разреза: поток ограничен ее работающими цехами
+struct CutStation
+{
+    int stationId;
+    double capacity;
+};
+
+// Минимальный s-t разрез: насыщенные трубы (и станции), отделяющие источник от стока
+struct MinCut
+{
+    std::vector<CutPipe> pipes;
+    std::vector<CutStation> stations;
+    std::vector<int> sourceSide; // станции, достижимые из источника в остаточной сети
+    double capacity = 0.0;       // равна величине максимального потока
+};
+
+// Поток по трубе в решении задачи минимальной стоимости
+struct PipeFlow
+{
+    int pipeId;
+    int fromStation;
+    int toStation;
+    double flow; // м³/час
+    double cost; // flow * длина
+};
+
+// Доставка заданного объема источник -> сток с минимальной стоимостью транспорта
+struct MinCostFlowResult
+{
+    double requested = 0.0;
+    double delivered = 0.0; // меньше requested, если объем больше максимального потока
+    double totalCost = 0.0; // сумма flow * длина по трубам (м³/час * км)
+    std::vector<PipeFlow> pipes;
+};
+
+// Один из взаимно независимых маршрутов между станциями
+struct DisjointPath
+{
+    std::vector<int> stations;
+    std::vector<int> pipeIds;
+    double length = 0.0;     // км
+    double bottleneck = 0.0; // минимальная пропускная способность трубы, м³/час
+};
+
+// Баланс станции в задаче "поставки - потребление" (м³/час)
+struct StationBalance
+{
+    int stationId;
+    double required;  // заявленная поставка или потребность
+    double actual;    // фактически закачано / получено
+    double shortfall; // required - actual
+};
+
+// Результат расчета распределения от нескольких источников к нескольким потребителям
+struct SupplyDemandResult
+{
+    bool feasible = false; // все потребности покрыты полностью
+    double totalSupply = 0.0;
+    double totalDemand = 0.0;
+    double delivered = 0.0;
+    std::vector<StationBalance> supplies;
+    std::vector<StationBalance> demands;
+};
+
 class NetworkCalculator
 {
 private:
@@ -16,6 +92,13 @@ private:
     // Данные из таблицы 1.1 https://www.turbinist.ru/5641-proektirovanie-i-ekspluataciya-mg.html
     static const std::map<int, double> DIAMETER_CAPACITY;
 
+    // Производительность одного цеха в зависимости от класса станции (млн м³/сутки)
+    static const std::map<int, double> SHOP_CAPACITY;
+
+    // Обводная линия станции без работающих цехов: доля производительности одного цеха
+    // ее класса (газ идет без компримирования, перепад давления на станции не покрывается)
+    static constexpr double BYPASS_SHARE = 0.5;
+
     // Поправочный коэффициент для перевода в целые числа
     static constexpr double CORRECTION_COEFFICIENT = 1000.0;
 
@@ -23,9 +106,17 @@ private:
     static constexpr double INF = std::numeric_limits<double>::max();
 
 public:
+    // Остаточная пропускная способность меньше этого значения считается нулевой
+    static constexpr double FLOW_EPSILON = 1e-9;
+
     // Рассчитать производительность трубы по формуле Q = k * sqrt(d^5 / l)
     static double calculatePipeCapacity(double length_km, int diameter_mm, bool isUnderRepair);
 
+    // Пропускная способность станции (м³/час): работающие цеха * производительность цеха
+    // ее класса. Станция без работающих цехов пропускает газ по обводной линии
+    // без компримирования: BYPASS_SHARE производительности одного цеха, не больше ее.
+    static double calculateStationCapacity(int workingShops, int stationClass);
+
     // Рассчитать вес ребра (в простейшем случае - длина)
     static double calculateEdgeWeight(double length_km, bool isUnderRepair);
 
@@ -37,12 +128,202 @@ public:
         int targetStation,
         double &totalDistance);
 
-    // Алгоритм Форда-Фалкерсона для расчета максимального потока
+    // Самый длинный путь (критическая цепочка транспорта); только для сети без циклов
+    static std::vector<int> findLongestPath(
+        const Graph &graph,
+        const PipelineNetwork &network,
+        int sourceStation,
+        int targetStation,
+        double &totalDistance);
+
+    // Станции, куда газ может попасть из sourceStation по исправным трубам (по возрастанию ID)
+    static std::vector<int> findReachableStations(
+        const Graph &graph,
+        const PipelineNetwork &network,
+        int sourceStation);
+
+    // Самый "широкий" путь: маршрут с наибольшей минимальной пропускной способностью трубы
+    static std::vector<int> findWidestPath(
+        const Graph &graph,
+        const PipelineNetwork &network,
+        int sourceStation,
+        int targetStation,
+        double &bottleneck);
+
+    // Алгоритм Форда-Фалкерсона для расчета максимального потока с учетом пропускной
+    // способности станций. Если cut не nullptr, в него записывается минимальный разрез
+    // из того же расчета.
     static double calculateMaxFlow(
         const Graph &graph,
         const PipelineNetwork &network,
         int sourceStation,
-        int targetStation);
+        int targetStation,
+        MinCut *cut = nullptr);
+
+    // Плоский граф для (graph, network), кэшируется в текущем потоке до изменения версий
+    static const FlatGraph &cachedFlatGraph(const Graph &graph, const PipelineNetwork &network);
+
+    // Плоский граф с ограничениями станций: станция расщепляется на вход (узел станции)
+    // и выход, газ, уходящий со станции в трубы, проходит дугу с ее пропускной
+    // способностью; поступающий в станцию-сток не ограничивается. Без splitAll
+    // расщепляются только станции, чье ограничение меньше суммы исходящих труб.
+    static void buildStationGraph(FlatGraph &flat, const Graph &graph, const PipelineNetwork &network, bool splitAll);
+
+    // То же, кэшируется в текущем потоке до изменения версий. Без splitAll граф годится,
+    // пока пропускная способность труб только уменьшается; расчетам, которые ее
+    // увеличивают, нужен splitAll - иначе нерасщепленная станция перестает ограничивать поток.
+    static const FlatGraph &cachedStationGraph(const Graph &graph, const PipelineNetwork &network, bool splitAll = false);
+
+    // Рабочая область текущего потока
+    static CalculationWorkspace &threadWorkspace();
+
+    // Дейкстра на плоском графе. Без вывода сообщений и без выделения памяти,
+    // если workspace подготовлен (prepare) и path уже имеет нужную емкость.
+    static bool findShortestPath(
+        const FlatGraph &graph,
+        CalculationWorkspace &workspace,
+        int sourceStation,
+        int targetStation,
+        std::vector<int> &path,
+        double &totalDistance);
+
+    // Для ацикличного графа (graph.isAcyclic()): кратчайший или самый длинный путь
+    // одним проходом по топологическому порядку от источника до стока, без кучи.
+    // findShortestPath выбирает этот путь сам; findLongestPath на графе с циклами
+    // возвращает false.
+    static bool findAcyclicPath(
+        const FlatGraph &graph,
+        CalculationWorkspace &workspace,
+        int sourceStation,
+        int targetStation,
+        bool longest,
+        std::vector<int> &path,
+        double &totalDistance);
+    static bool findLongestPath(
+        const FlatGraph &graph,
+        CalculationWorkspace &workspace,
+        int sourceStation,
+        int targetStation,
+        std::vector<int> &path,
+        double &totalDistance);
+
+    // Достижимые станции: проход по топологическому порядку для ацикличного графа,
+    // иначе обход в ширину. Трубы в ремонте не проходимы.
+    static void findReachableStations(
+        const FlatGraph &graph,
+        CalculationWorkspace &workspace,
+        int sourceStation,
+        std::vector<int> &stations);
+
+    // Модифицированный Дейкстра на плоском графе: вместо суммы длин максимизируется
+    // минимум пропускной способности на пути (трубы в ремонте не проходимы)
+    static bool findWidestPath(
+        const FlatGraph &graph,
+        CalculationWorkspace &workspace,
+        int sourceStation,
+        int targetStation,
+        std::vector<int> &path,
+        double &bottleneck);
+
+    // Эдмондс-Карп на плоском графе. Итоговый поток по дугам остается в workspace.flow
+    // до следующего расчета (для разреза и анализа чувствительности).
+    static double calculateMaxFlow(
+        const FlatGraph &graph,
+        CalculationWorkspace &workspace,
+        int sourceStation,
+        int targetStation,
+        MinCut *cut = nullptr);
+
+    // Поток минимальной стоимости (стоимость дуги - calculateEdgeWeight, т.е. длина):
+    // последовательные кратчайшие пути по приведенным стоимостям (потенциалы Джонсона)
+    // с двоичной кучей рабочей области. Доставляет не более volume; поток по дугам
+    // остается в workspace.flow. Возвращает доставленный объем, стоимость - в totalCost.
+    static double calculateMinCostFlow(
+        const FlatGraph &graph,
+        CalculationWorkspace &workspace,
+        int sourceStation,
+        int targetStation,
+        double volume,
+        double &totalCost);
+
+    // То же по графу и данным сети (с учетом станций), с распределением потока по трубам
+    static MinCostFlowResult calculateMinCostFlow(
+        const Graph &graph,
+        const PipelineNetwork &network,
+        int sourceStation,
+        int targetStation,
+        double volume);
+
+    // Граф для findDisjointPaths: каждая исправная труба - единица пропускной способности,
+    // при stationDisjoint каждая станция расщеплена и пропускает одну единицу.
+    // Строится один раз на серию запросов по одному плоскому графу.
+    static void buildDisjointGraph(FlatGraph &unit, const FlatGraph &graph, bool stationDisjoint);
+
+    // До k маршрутов без общих труб (и без общих промежуточных станций, если unit
+    // построен с stationDisjoint) с минимальной суммарной длиной: Суурбалле/Бхандари
+    // как поток минимальной стоимости величины k по графу unit. graph - исходный граф
+    // unit (пропускные способности труб для узких мест). Маршрутов меньше k, если
+    // столько независимых нет. Сортировка по длине.
+    static std::vector<DisjointPath> findDisjointPaths(
+        const FlatGraph &graph,
+        const FlatGraph &unit,
+        CalculationWorkspace &workspace,
+        int sourceStation,
+        int targetStation,
+        int k);
+
+    // То же по графу и данным сети, с сообщениями об ошибках
+    static std::vector<DisjointPath> findDisjointPaths(
+        const Graph &graph,
+        const PipelineNetwork &network,
+        int sourceStation,
+        int targetStation,
+        int k,
+        bool stationDisjoint);
+
+    // Минимальный разрез по остаточной сети после augmentFlow без ограничения:
+    // последний (неудачный) BFS уже пометил в workspace узлы стороны источника
+    static void extractMinCut(
+        const FlatGraph &graph,
+        const CalculationWorkspace &workspace,
+        MinCut &cut);
+
+    // Дополнить текущий поток workspace.flow увеличивающими путями между узлами
+    // плоского графа, не более чем на limit. Возвращает добавленную величину.
+    static double augmentFlow(
+        const FlatGraph &graph,
+        CalculationWorkspace &workspace,
+        int sourceNode,
+        int targetNode,
+        double limit);
+
+    // Уменьшить пропускную способность дуги до newCapacity при сохранении допустимого
+    // потока sourceNode -> targetNode: лишний поток перенаправляется в обход дуги,
+    // а то, что перенаправить нельзя, снимается с путей от источника и к стоку.
+    // Возвращает, на сколько уменьшилась величина потока (до повторного augmentFlow).
+    static double reduceArcFlow(
+        const FlatGraph &graph,
+        CalculationWorkspace &workspace,
+        int arc,
+        double newCapacity,
+        int sourceNode,
+        int targetNode);
+
+    // Распределение газа от нескольких источников к нескольким потребителям за один расчет:
+    // суперисток соединяется с источниками (дуги = поставки), потребители - со суперстоком
+    // (дуги = потребности), затем считается один максимальный поток.
+    static SupplyDemandResult calculateSupplyDemand(
+        const Graph &graph,
+        const PipelineNetwork &network,
+        const std::map<int, double> &supply,
+        const std::map<int, double> &demand);
+
+    // Матрица максимальных потоков между всеми парами станций.
+    // Пары считаются параллельно в пуле TaskScheduler; результат [i][j] - поток stations[i] -> stations[j]
+    static std::vector<std::vector<double>> calculateMaxFlowMatrix(
+        const Graph &graph,
+        const PipelineNetwork &network,
+        const std::vector<int> &stations);
 
     // Отобразить путь между станциями
     static void displayPath(
@@ -0,0 +1,207 @@
+#include "NetworkGenerator.h"
+#include <random>
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+namespace
+{
+    // Наполнение сети: станции, трубы и связи без диалогов и вывода
+    class Builder
+    {
+    private:
+        mt19937_64 rng;
+        const NetworkGenerator::Options &options;
+        int nextPipeId = 1;
+
+    public:
+        PipelineNetwork objects;
+        Graph topology;
+
+        Builder(const NetworkGenerator::Options &options)
+            : rng(options.seed), options(options)
+        {
+        }
+
+        int random(int low, int high)
+        {
+            return uniform_int_distribution<int>(low, high)(rng);
+        }
+
+        void addStations(int count)
+        {
+            for (int id = 1; id <= count; id++)
+            {
+                int total = random(1, 8);
+                int working = random(0, total);
+                objects.addStation(CompressorStation(id, "KS-" + to_string(id), total, working, random(1, 3)));
+                topology.addVertex(id);
+            }
+        }
+
+        bool connect(int from, int to, int diameter)
+        {
+            if (from == to || topology.getPipeId(from, to) != -1)
+            {
+                return false;
+            }
+
+            double length = random(5, 150);
+            bool underRepair = uniform_real_distribution<double>(0.0, 1.0)(rng) < options.repairProbability;
+            int pipeId = nextPipeId++;
+
+            objects.addPipe(Pipe(pipeId, "P-" + to_string(pipeId), length, diameter, underRepair, true));
+            topology.addConnection(from, to, pipeId, diameter);
+            return true;
+        }
+
+        int randomDiameter()
+        {
+            static const int diameters[] = {500, 700, 1000, 1400};
+            return diameters[random(0, 3)];
+        }
+    };
+
+    void buildTree(Builder &builder, int n)
+    {
+        // Случайное рекурсивное дерево: родитель - любая более ранняя станция
+        for (int id = 2; id <= n; id++)
+        {
+            builder.connect(builder.random(1, id - 1), id, builder.randomDiameter());
+        }
+    }
+
+    void buildGrid(Builder &builder, int n)
+    {
+        int side = max(1, static_cast<int>(ceil(sqrt(static_cast<double>(n)))));
+        for (int id = 1; id <= n; id++)
+        {
+            int row = (id - 1) / side;
+            int column = (id - 1) % side;
+            if (column + 1 < side && id + 1 <= n)
+            {
+                builder.connect(id, id + 1, builder.randomDiameter());
+            }
+            if (id + side <= n)
+            {
+                builder.connect(id, id + side, row % 4 == 0 ? 1400 : builder.randomDiameter());
+            }
+        }
+    }
+
+    void buildScaleFree(Builder &builder, int n, int attachments)
+    {
+        // Модель Барабаши-Альберт: конец случайной связи выбирается
+        // пропорционально степени станции
+        vector<int> endpoints;
+        if (n >= 2)
+        {
+            builder.connect(1, 2, 1400);
+            endpoints = {1, 2};
+        }
+
+        for (int id = 3; id <= n; id++)
+        {
+            int links = min(attachments, id - 1);
+            for (int k = 0; k < links; k++)
+            {
+                int target = endpoints[builder.random(0, static_cast<int>(endpoints.size()) - 1)];
+                if (builder.connect(target, id, builder.randomDiameter()))
+                {
+                    endpoints.push_back(target);
+                    endpoints.push_back(id);
+                }
+            }
+        }
+    }
+
+    void buildTrunk(Builder &builder, int n, int lateralLength)
+    {
+        // Магистраль 1400 мм, от каждой станции магистрали - отвод меньшего диаметра
+        int groupSize = lateralLength + 1;
+        int trunkCount = max(1, n / groupSize);
+        for (int t = 1; t < trunkCount; t++)
+        {
+            builder.connect(t, t + 1, 1400);
+        }
+
+        int nextStation = trunkCount + 1;
+        for (int t = 1; t <= trunkCount && nextStation <= n; t++)
+        {
+            int previous = t;
+            int diameter = 1000;
+            int length = t == trunkCount ? n - nextStation + 1 : lateralLength;
+            for (int k = 0; k < length && nextStation <= n; k++)
+            {
+                builder.connect(previous, nextStation, diameter);
+                diameter = diameter == 1000 ? 700 : 500;
+                previous = nextStation++;
+            }
+        }
+    }
+}
+
+void NetworkGenerator::generate(GasNetwork &network, const Options &options)
+{
+    Builder builder(options);
+    int n = max(0, options.stationCount);
+
+    builder.addStations(n);
+
+    switch (options.topology)
+    {
+    case Topology::Tree:
+        buildTree(builder, n);
+        break;
+    case Topology::MeshedGrid:
+        buildGrid(builder, n);
+        break;
+    case Topology::ScaleFree:
+        buildScaleFree(builder, n, max(1, options.attachmentCount));
+        break;
+    case Topology::TrunkWithLaterals:
+        buildTrunk(builder, n, max(1, options.lateralLength));
+        break;
+    }
+
+    network.replaceNetwork(move(builder.objects), move(builder.topology));
+}
+
+void NetworkGenerator::generateToFiles(const string &filename, const Options &options)
+{
+    GasNetwork network;
+    generate(network, options);
+    network.saveNetworkToFile(filename);
+}
+
+bool NetworkGenerator::parseTopology(const string &name, Topology &topology)
+{
+    if (name == "tree")
+        topology = Topology::Tree;
+    else if (name == "grid")
+        topology = Topology::MeshedGrid;
+    else if (name == "scalefree")
+        topology = Topology::ScaleFree;
+    else if (name == "trunk")
+        topology = Topology::TrunkWithLaterals;
+    else
+        return false;
+    return true;
+}
+
+string NetworkGenerator::topologyName(Topology topology)
+{
+    switch (topology)
+    {
+    case Topology::Tree:
+        return "tree";
+    case Topology::MeshedGrid:
+        return "grid";
+    case Topology::ScaleFree:
+        return "scalefree";
+    case Topology::TrunkWithLaterals:
+        return "trunk";
+    }
+    return "unknown";
+}
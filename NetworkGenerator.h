@@ -0,0 +1,40 @@
+#ifndef NETWORK_GENERATOR_H
+#define NETWORK_GENERATOR_H
+
+#include "GasNetwork.h"
+#include <string>
+#include <cstdint>
+
+// Генератор синтетических газовых сетей для нагрузочных тестов и бенчмарков
+class NetworkGenerator
+{
+public:
+    enum class Topology
+    {
+        Tree,             // радиальная распределительная сеть (случайное дерево)
+        MeshedGrid,       // кольцевая сетка: связи вправо и вниз
+        ScaleFree,        // безмасштабная сеть (предпочтительное присоединение)
+        TrunkWithLaterals // магистраль с отводами
+    };
+
+    struct Options
+    {
+        Topology topology = Topology::Tree;
+        int stationCount = 1000;
+        uint64_t seed = 42;
+        double repairProbability = 0.02; // доля труб в ремонте
+        int lateralLength = 4;           // длина отвода для TrunkWithLaterals
+        int attachmentCount = 2;         // связей на новую станцию для ScaleFree
+    };
+
+    // Построить сеть в памяти (станции 1..N, трубы 1..M) и заменить ею содержимое network
+    static void generate(GasNetwork &network, const Options &options);
+
+    // Построить сеть и записать в формате <filename>_data.txt / <filename>_network.txt
+    static void generateToFiles(const std::string &filename, const Options &options);
+
+    static bool parseTopology(const std::string &name, Topology &topology);
+    static std::string topologyName(Topology topology);
+};
+
+#endif
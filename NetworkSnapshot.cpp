@@ -0,0 +1,24 @@
+#include "NetworkSnapshot.h"
+
+using namespace std;
+
+NetworkSnapshot::NetworkSnapshot(uint64_t version,
+                                 shared_ptr<const PipelineNetwork> pipelineNetwork,
+                                 shared_ptr<const Graph> graph)
+    : version(version), pipelineNetwork(move(pipelineNetwork)), graph(move(graph))
+{
+}
+
+uint64_t NetworkSnapshot::getVersion() const { return version; }
+const PipelineNetwork &NetworkSnapshot::getPipelineNetwork() const { return *pipelineNetwork; }
+const Graph &NetworkSnapshot::getGraph() const { return *graph; }
+
+shared_ptr<const PipelineNetwork> NetworkSnapshot::sharePipelineNetwork() const
+{
+    return pipelineNetwork;
+}
+
+shared_ptr<const Graph> NetworkSnapshot::shareGraph() const
+{
+    return graph;
+}
@@ -0,0 +1,33 @@
+#ifndef NETWORK_SNAPSHOT_H
+#define NETWORK_SNAPSHOT_H
+
+#include "PipelineNetwork.h"
+#include "Graph.h"
+#include <memory>
+#include <cstdint>
+
+// Неизменяемая версия сети: трубы, станции и топология на момент публикации.
+// Читатель держит shared_ptr на снимок, поэтому снимок живет, пока его кто-то
+// использует, а писатель тем временем публикует новые версии.
+class NetworkSnapshot
+{
+private:
+    uint64_t version;
+    std::shared_ptr<const PipelineNetwork> pipelineNetwork;
+    std::shared_ptr<const Graph> graph;
+
+public:
+    NetworkSnapshot(uint64_t version,
+                    std::shared_ptr<const PipelineNetwork> pipelineNetwork,
+                    std::shared_ptr<const Graph> graph);
+
+    uint64_t getVersion() const;
+    const PipelineNetwork &getPipelineNetwork() const;
+    const Graph &getGraph() const;
+
+    // Компоненты отдельно, чтобы следующая версия могла разделить неизмененную часть
+    std::shared_ptr<const PipelineNetwork> sharePipelineNetwork() const;
+    std::shared_ptr<const Graph> shareGraph() const;
+};
+
+#endif
@@ -0,0 +1,321 @@
+#ifndef PERSISTENT_MAP_H
+#define PERSISTENT_MAP_H
+
+#include "MemoryTracker.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Отображение ID -> объект с общими частями у копий (префиксное дерево по битам ключа).
+// Листья - фрагменты до 64 записей подряд идущих ключей, внутренние узлы - по 64 ребенка.
+// Копия отображения - это копия указателя на корень (O(1)); изменение копирует только
+// путь от корня до своего фрагмента, если узлы пути разделены с другими копиями.
+// Так снимок сети из миллионов труб публикуется без копирования неизмененных фрагментов.
+// Обход - по возрастанию ключа (отрицательные ключи - после неотрицательных).
+// Узел, которым владеет только эта копия (use_count == 1), изменяется на месте.
+template <typename Value, MemoryCategory Category>
+class PersistentMap
+{
+public:
+    using Entry = std::pair<int, Value>;
+    using EntryVector = std::vector<Entry, TrackingAllocator<Entry, Category>>;
+
+private:
+    static constexpr int CHUNK_BITS = 6;
+    static constexpr uint32_t CHUNK_SIZE = 1u << CHUNK_BITS;
+    static constexpr int MAX_HEIGHT = 5; // (5 + 1) * 6 бит покрывают 32-битный ключ
+
+    struct Node
+    {
+        std::vector<std::shared_ptr<Node>, TrackingAllocator<std::shared_ptr<Node>, Category>> children; // пусто у листа
+        EntryVector entries;                                                                           // записи листа по возрастанию ключа
+    };
+
+    std::shared_ptr<Node> root;
+    int height = 0; // число уровней внутренних узлов над листьями
+    size_t count = 0;
+
+    static uint32_t slotOf(int key, int level)
+    {
+        return (static_cast<uint32_t>(key) >> (level * CHUNK_BITS)) & (CHUNK_SIZE - 1);
+    }
+
+    static bool fits(int key, int height)
+    {
+        int bits = (height + 1) * CHUNK_BITS;
+        return bits >= 32 || (static_cast<uint32_t>(key) >> bits) == 0;
+    }
+
+    // Узел для изменения: создается или копируется, если его разделяют другие копии
+    static Node *detach(std::shared_ptr<Node> &slot, bool internal)
+    {
+        if (!slot)
+        {
+            slot = std::allocate_shared<Node>(TrackingAllocator<Node, Category>());
+            if (internal)
+                slot->children.resize(CHUNK_SIZE);
+        }
+        else if (slot.use_count() != 1)
+        {
+            slot = std::allocate_shared<Node>(TrackingAllocator<Node, Category>(), *slot);
+        }
+        else
+        {
+            // Последняя ссылка другой копии могла быть отпущена только что: ее чтения
+            // узла должны завершиться до наших записей
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return slot.get();
+    }
+
+    const Node *leafOf(int key) const
+    {
+        if (!root || !fits(key, height))
+            return nullptr;
+        const Node *node = root.get();
+        for (int level = height; level > 0 && node; level--)
+        {
+            node = node->children[slotOf(key, level)].get();
+        }
+        return node;
+    }
+
+    static typename EntryVector::const_iterator position(const EntryVector &entries, int key)
+    {
+        return std::lower_bound(entries.begin(), entries.end(), key,
+                                [](const Entry &entry, int k)
+                                { return static_cast<uint32_t>(entry.first) < static_cast<uint32_t>(k); });
+    }
+
+    // Лист ключа для изменения (путь от корня отделяется от других копий)
+    Node *mutableLeaf(int key)
+    {
+        while (!fits(key, height))
+        {
+            if (root)
+            {
+                std::shared_ptr<Node> grown = std::allocate_shared<Node>(TrackingAllocator<Node, Category>());
+                grown->children.resize(CHUNK_SIZE);
+                grown->children[0] = std::move(root);
+                root = std::move(grown);
+            }
+            height++;
+        }
+
+        std::shared_ptr<Node> *slot = &root;
+        for (int level = height; level > 0; level--)
+        {
+            Node *node = detach(*slot, true);
+            slot = &node->children[slotOf(key, level)];
+        }
+        return detach(*slot, false);
+    }
+
+public:
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Entry;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Entry *;
+        using reference = const Entry &;
+
+        const_iterator() = default;
+
+        reference operator*() const { return path[depth].node->entries[index]; }
+        pointer operator->() const { return &path[depth].node->entries[index]; }
+
+        const_iterator &operator++()
+        {
+            index++;
+            settle();
+            return *this;
+        }
+
+        const_iterator operator++(int)
+        {
+            const_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const const_iterator &other) const
+        {
+            if (depth != other.depth)
+                return false;
+            return depth < 0 || (path[depth].node == other.path[depth].node && index == other.index);
+        }
+        bool operator!=(const const_iterator &other) const { return !(*this == other); }
+
+    private:
+        friend class PersistentMap;
+
+        struct Frame
+        {
+            const Node *node;
+            uint32_t child; // следующий ребенок для обхода
+        };
+
+        std::array<Frame, MAX_HEIGHT + 1> path{};
+        int depth = -1; // -1 - конец
+        size_t index = 0;
+
+        explicit const_iterator(const Node *root)
+        {
+            if (root)
+            {
+                path[0] = {root, 0};
+                depth = 0;
+                settle();
+            }
+        }
+
+        // Спуск к ближайшей записи не раньше текущей позиции
+        void settle()
+        {
+            while (depth >= 0)
+            {
+                Frame &top = path[depth];
+                if (top.node->children.empty())
+                {
+                    if (index < top.node->entries.size())
+                        return;
+                    index = 0;
+                    if (--depth >= 0)
+                        path[depth].child++;
+                    continue;
+                }
+
+                while (top.child < CHUNK_SIZE && !top.node->children[top.child])
+                    top.child++;
+                if (top.child == CHUNK_SIZE)
+                {
+                    if (--depth >= 0)
+                        path[depth].child++;
+                    continue;
+                }
+                path[depth + 1] = {top.node->children[top.child].get(), 0};
+                depth++;
+                index = 0;
+            }
+        }
+    };
+
+    const_iterator begin() const { return const_iterator(root.get()); }
+    const_iterator end() const { return const_iterator(); }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    void clear()
+    {
+        root.reset();
+        height = 0;
+        count = 0;
+    }
+
+    const Value *find(int key) const
+    {
+        const Node *leaf = leafOf(key);
+        if (!leaf)
+            return nullptr;
+        auto it = position(leaf->entries, key);
+        return it != leaf->entries.end() && it->first == key ? &it->second : nullptr;
+    }
+
+    bool contains(int key) const { return find(key) != nullptr; }
+
+    // Объект для изменения (путь к нему отделяется от других копий) или nullptr
+    Value *findMutable(int key)
+    {
+        if (!find(key))
+            return nullptr;
+        Node *leaf = mutableLeaf(key);
+        auto it = position(leaf->entries, key);
+        return &leaf->entries[static_cast<size_t>(it - leaf->entries.begin())].second;
+    }
+
+    // Вставить или заменить; ссылка на объект в отображении
+    Value &set(int key, Value value)
+    {
+        Node *leaf = mutableLeaf(key);
+        size_t at = static_cast<size_t>(position(leaf->entries, key) - leaf->entries.begin());
+        if (at < leaf->entries.size() && leaf->entries[at].first == key)
+        {
+            leaf->entries[at].second = std::move(value);
+        }
+        else
+        {
+            leaf->entries.insert(leaf->entries.begin() + at, Entry(key, std::move(value)));
+            count++;
+        }
+        return leaf->entries[at].second;
+    }
+
+    bool erase(int key)
+    {
+        if (!find(key))
+            return false;
+
+        std::array<std::shared_ptr<Node> *, MAX_HEIGHT + 1> slots{};
+        slots[0] = &root;
+        for (int level = height, depth = 0; level > 0; level--, depth++)
+        {
+            Node *node = detach(*slots[depth], true);
+            slots[depth + 1] = &node->children[slotOf(key, level)];
+        }
+        Node *leaf = detach(*slots[height], false);
+        leaf->entries.erase(leaf->entries.begin() + (position(leaf->entries, key) - leaf->entries.begin()));
+        count--;
+
+        // Пустые узлы снизу вверх удаляются
+        for (int depth = height; depth >= 0; depth--)
+        {
+            const Node *node = slots[depth]->get();
+            bool empty = node->children.empty()
+                             ? node->entries.empty()
+                             : std::none_of(node->children.begin(), node->children.end(),
+                                            [](const std::shared_ptr<Node> &child)
+                                            { return static_cast<bool>(child); });
+            if (!empty)
+                break;
+            slots[depth]->reset();
+        }
+        if (!root)
+            height = 0;
+        return true;
+    }
+
+    // Фрагменты по возрастанию ключей: единицы работы для параллельного обхода
+    void chunks(std::vector<const EntryVector *> &result) const
+    {
+        result.clear();
+        if (!root)
+            return;
+        std::vector<const Node *> stack{root.get()};
+        while (!stack.empty())
+        {
+            const Node *node = stack.back();
+            stack.pop_back();
+            if (node->children.empty())
+            {
+                result.push_back(&node->entries);
+                continue;
+            }
+            for (size_t i = CHUNK_SIZE; i-- > 0;)
+            {
+                if (node->children[i])
+                    stack.push_back(node->children[i].get());
+            }
+        }
+    }
+};
+
+#endif
@@ -6,16 +6,22 @@
 
 using namespace std;
 
-int Pipe::nextId = 1;
+std::atomic<int> Pipe::nextId{1};
 
 Pipe::Pipe() : id(0), name(""), length(0.0), diameter(0), underRepair(false), isConnected(false) {}
 
 Pipe::Pipe(int id, const std::string &name, double length, int diameter, bool underRepair, bool isConnected)
     : id(id), name(name), length(length), diameter(diameter), underRepair(underRepair), isConnected(isConnected)
 {
-    if (id >= nextId)
+    reserveId(id);
+}
+
+void Pipe::reserveId(int usedId)
+{
+    // Атомарно поднимаем счетчик, чтобы параллельные загрузки не выдали повторный ID
+    int current = nextId.load();
+    while (usedId >= current && !nextId.compare_exchange_weak(current, usedId + 1))
     {
-        nextId = id + 1;
     }
 }
 
@@ -45,8 +51,7 @@ void Pipe::setIsConnected(bool connected) { this->isConnected = connected; }
 
 void Pipe::input()
 {
-    id = getNextId();
-    incrementId();
+    id = acquireId();
 
     cout << "\n════════════════════════════════════════" << endl;
     cout << "          CREATE NEW PIPE" << endl;
@@ -273,10 +278,7 @@ void Pipe::loadFromFile(ifstream &file)
     file >> isConnected;
     file.ignore();
 
-    if (id >= nextId)
-    {
-        nextId = id + 1;
-    }
+    reserveId(id);
 }
 
 bool Pipe::matchesName(const string &searchName) const
@@ -3,11 +3,12 @@
 
 #include <string>
 #include <vector>
+#include <atomic>
 
 class Pipe
 {
 private:
-    static int nextId;
+    static std::atomic<int> nextId;
     int id;
     std::string name;
     double length;
@@ -20,9 +21,11 @@ public:
     Pipe(int id, const std::string &name, double length, int diameter, bool underRepair = false, bool isConnected = false);
 
     // Статические методы для управления ID
-    static int getNextId() { return nextId; }
+    static int getNextId() { return nextId.load(); }
     static void incrementId() { nextId++; }
     static void resetId() { nextId = 1; }
+    static int acquireId() { return nextId.fetch_add(1); }
+    static void reserveId(int usedId);
     static bool isValidDiameter(int diameter);
 
     // Геттеры
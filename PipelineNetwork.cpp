@@ -1,5 +1,6 @@
 #include "PipelineNetwork.h"
 #include "utils.h"
+#include "TaskScheduler.h"
 #include <iostream>
 #include <algorithm>
 #include <fstream>
@@ -7,6 +8,8 @@
 
 using namespace std;
 
+atomic<uint64_t> PipelineNetwork::nextVersion{1};
+
 void PipelineNetwork::logAction(const string &action) const
 {
     ofstream logfile("logs.txt", ios::app);
@@ -17,11 +20,78 @@ void PipelineNetwork::logAction(const string &action) const
     }
 }
 
+namespace
+{
+    // Обход фрагментов блоками; блок - единица работы для пула потоков
+    template <typename Container, typename Object>
+    vector<int> collectIds(const Container &container,
+                           const function<bool(const Object &)> &predicate,
+                           size_t parallelThreshold)
+    {
+        vector<int> result;
+        if (container.size() < parallelThreshold)
+        {
+            for (const auto &pair : container)
+            {
+                if (predicate(pair.second))
+                {
+                    result.push_back(pair.first);
+                }
+            }
+            return result;
+        }
+
+        vector<const typename Container::EntryVector *> chunks;
+        container.chunks(chunks);
+        const size_t chunksPerBlock = 64;
+        size_t blockCount = (chunks.size() + chunksPerBlock - 1) / chunksPerBlock;
+        vector<vector<int>> partial(blockCount);
+
+        TaskScheduler::instance().parallelFor(0, blockCount, 1, [&](size_t block)
+                                              {
+            size_t firstChunk = block * chunksPerBlock;
+            size_t lastChunk = min(chunks.size(), firstChunk + chunksPerBlock);
+            for (size_t chunk = firstChunk; chunk < lastChunk; chunk++)
+            {
+                for (const auto &pair : *chunks[chunk])
+                {
+                    if (predicate(pair.second))
+                    {
+                        partial[block].push_back(pair.first);
+                    }
+                }
+            } });
+
+        size_t total = 0;
+        for (const auto &part : partial)
+        {
+            total += part.size();
+        }
+        result.reserve(total);
+        for (const auto &part : partial)
+        {
+            result.insert(result.end(), part.begin(), part.end());
+        }
+        return result;
+    }
+}
+
+vector<int> PipelineNetwork::collectPipeIds(const function<bool(const Pipe &)> &predicate) const
+{
+    return collectIds(pipes, predicate, PARALLEL_SEARCH_THRESHOLD);
+}
+
+vector<int> PipelineNetwork::collectStationIds(const function<bool(const CompressorStation &)> &predicate) const
+{
+    return collectIds(stations, predicate, PARALLEL_SEARCH_THRESHOLD);
+}
+
 void PipelineNetwork::addPipe()
 {
     Pipe pipe;
     pipe.input();
-    pipes[pipe.getId()] = pipe;
+    pipes.set(pipe.getId(), pipe);
+    touch();
     logAction("Added pipe with ID: " + to_string(pipe.getId()));
 }
 
@@ -29,10 +99,44 @@ void PipelineNetwork::addStation()
 {
     CompressorStation station;
     station.input();
-    stations[station.getId()] = station;
+    stations.set(station.getId(), station);
+    touch();
     logAction("Added station with ID: " + to_string(station.getId()));
 }
 
+void PipelineNetwork::addPipe(const Pipe &pipe)
+{
+    pipes.set(pipe.getId(), pipe);
+    touch();
+}
+
+void PipelineNetwork::addStation(const CompressorStation &station)
+{
+    stations.set(station.getId(), station);
+    touch();
+}
+
+void PipelineNetwork::estimateNameBytes(int64_t &pipeNameBytes, int64_t &stationNameBytes) const
+{
+    // Короткие строки (SSO) хранятся внутри объекта и уже учтены в размере узла
+    const size_t inlineCapacity = string().capacity();
+    pipeNameBytes = 0;
+    stationNameBytes = 0;
+
+    for (const auto &pair : pipes)
+    {
+        size_t length = pair.second.getName().size();
+        if (length > inlineCapacity)
+            pipeNameBytes += static_cast<int64_t>(length + 1);
+    }
+    for (const auto &pair : stations)
+    {
+        size_t length = pair.second.getName().size();
+        if (length > inlineCapacity)
+            stationNameBytes += static_cast<int64_t>(length + 1);
+    }
+}
+
 void PipelineNetwork::displayAllObjects() const
 {
     cout << "\n════════════════════════════════════════" << endl;
@@ -108,94 +212,59 @@ void PipelineNetwork::displayStations() const
 
 vector<int> PipelineNetwork::findPipesByName(const string &name) const
 {
-    vector<int> result;
-    for (const auto &pair : pipes)
-    {
-        if (pair.second.matchesName(name))
-        {
-            result.push_back(pair.first);
-        }
-    }
+    vector<int> result = collectPipeIds([&name](const Pipe &pipe)
+                                       { return pipe.matchesName(name); });
     logAction("Search pipes by name: '" + name + "' - found " + to_string(result.size()) + " results");
     return result;
 }
 
 vector<int> PipelineNetwork::findPipesByRepairStatus(bool status) const
 {
-    vector<int> result;
-    for (const auto &pair : pipes)
-    {
-        if (pair.second.isUnderRepair() == status)
-        {
-            result.push_back(pair.first);
-        }
-    }
+    vector<int> result = collectPipeIds([status](const Pipe &pipe)
+                                       { return pipe.isUnderRepair() == status; });
     logAction("Search pipes by repair status: " + to_string(status) + " - found " + to_string(result.size()) + " results");
     return result;
 }
 
 vector<int> PipelineNetwork::findPipesByDiameter(int diameter) const
 {
-    vector<int> result;
-    for (const auto &pair : pipes)
-    {
-        if (pair.second.getDiameter() == diameter)
-        {
-            result.push_back(pair.first);
-        }
-    }
+    vector<int> result = collectPipeIds([diameter](const Pipe &pipe)
+                                       { return pipe.getDiameter() == diameter; });
     logAction("Search pipes by diameter: " + to_string(diameter) + " - found " + to_string(result.size()) + " results");
     return result;
 }
 
 vector<int> PipelineNetwork::findPipesByAvailability(bool available) const
 {
-    vector<int> result;
-    for (const auto &pair : pipes)
-    {
-        if (pair.second.isAvailableForConnection() == available)
-        {
-            result.push_back(pair.first);
-        }
-    }
+    vector<int> result = collectPipeIds([available](const Pipe &pipe)
+                                       { return pipe.isAvailableForConnection() == available; });
     logAction("Search pipes by availability: " + to_string(available) + " - found " + to_string(result.size()) + " results");
     return result;
 }
 
 vector<int> PipelineNetwork::findStationsByName(const string &name) const
 {
-    vector<int> result;
-    for (const auto &pair : stations)
-    {
-        if (pair.second.matchesName(name))
-        {
-            result.push_back(pair.first);
-        }
-    }
+    vector<int> result = collectStationIds([&name](const CompressorStation &station)
+                                       { return station.matchesName(name); });
     logAction("Search stations by name: '" + name + "' - found " + to_string(result.size()) + " results");
     return result;
 }
 
 vector<int> PipelineNetwork::findStationsByUnusedPercentage(double percentage) const
 {
-    vector<int> result;
-    for (const auto &pair : stations)
-    {
-        if (pair.second.getUnusedPercentage() >= percentage)
-        {
-            result.push_back(pair.first);
-        }
-    }
+    vector<int> result = collectStationIds([percentage](const CompressorStation &station)
+                                       { return station.getUnusedPercentage() >= percentage; });
     logAction("Search stations by unused percentage: " + to_string(percentage) + "% - found " + to_string(result.size()) + " results");
     return result;
 }
 
 void PipelineNetwork::editPipe(int id)
 {
-    auto it = pipes.find(id);
-    if (it != pipes.end())
+    Pipe *pipe = pipes.findMutable(id);
+    if (pipe)
     {
-        it->second.edit();
+        pipe->edit();
+        touch();
         logAction("Edited pipe with ID: " + to_string(id));
     }
     else
@@ -206,10 +275,11 @@ void PipelineNetwork::editPipe(int id)
 
 void PipelineNetwork::editStation(int id)
 {
-    auto it = stations.find(id);
-    if (it != stations.end())
+    CompressorStation *station = stations.findMutable(id);
+    if (station)
     {
-        it->second.edit();
+        station->edit();
+        touch();
         logAction("Edited station with ID: " + to_string(id));
     }
     else
@@ -229,11 +299,12 @@ void PipelineNetwork::batchEditPipes(const vector<int> &pipeIds)
     cout << "Batch editing " << pipeIds.size() << " pipes:" << endl;
     for (int id : pipeIds)
     {
-        auto it = pipes.find(id);
-        if (it != pipes.end())
+        Pipe *pipe = pipes.findMutable(id);
+        if (pipe)
         {
             cout << "\nEditing pipe ID: " << id << endl;
-            it->second.edit();
+            pipe->edit();
+            touch();
         }
     }
     logAction("Batch edited " + to_string(pipeIds.size()) + " pipes");
@@ -243,6 +314,7 @@ void PipelineNetwork::deletePipe(int id)
 {
     if (pipes.erase(id))
     {
+        touch();
         cout << "✅ Pipe with ID " << id << " deleted successfully!" << endl;
         logAction("Deleted pipe with ID: " + to_string(id));
     }
@@ -256,6 +328,7 @@ void PipelineNetwork::deleteStation(int id)
 {
     if (stations.erase(id))
     {
+        touch();
         cout << "✅ Station with ID " << id << " deleted successfully!" << endl;
         logAction("Deleted station with ID: " + to_string(id));
     }
@@ -299,6 +372,7 @@ void PipelineNetwork::loadFromFile(const string &filename)
     {
         pipes.clear();
         stations.clear();
+        touch();
 
         string line;
         while (getline(file, line))
@@ -307,13 +381,13 @@ void PipelineNetwork::loadFromFile(const string &filename)
             {
                 Pipe pipe;
                 pipe.loadFromFile(file);
-                pipes[pipe.getId()] = pipe;
+                pipes.set(pipe.getId(), pipe);
             }
             else if (line == "Station")
             {
                 CompressorStation station;
                 station.loadFromFile(file);
-                stations[station.getId()] = station;
+                stations.set(station.getId(), station);
             }
         }
         file.close();
@@ -328,12 +402,12 @@ void PipelineNetwork::loadFromFile(const string &filename)
 
 bool PipelineNetwork::pipeExists(int id) const
 {
-    return pipes.find(id) != pipes.end();
+    return pipes.contains(id);
 }
 
 bool PipelineNetwork::stationExists(int id) const
 {
-    return stations.find(id) != stations.end();
+    return stations.contains(id);
 }
 
 void PipelineNetwork::displayPipeIds() const
@@ -374,42 +448,32 @@ void PipelineNetwork::displayStationIds() const
 
 Pipe *PipelineNetwork::getPipeById(int id)
 {
-    auto it = pipes.find(id);
-    if (it != pipes.end())
+    Pipe *pipe = pipes.findMutable(id);
+    if (pipe)
     {
-        return &it->second;
+        touch(); // объект могут изменить через указатель
     }
-    return nullptr;
+    return pipe;
 }
 
 const Pipe *PipelineNetwork::getPipeById(int id) const
 {
-    auto it = pipes.find(id);
-    if (it != pipes.end())
-    {
-        return &it->second;
-    }
-    return nullptr;
+    return pipes.find(id);
 }
 
 CompressorStation *PipelineNetwork::getStationById(int id)
 {
-    auto it = stations.find(id);
-    if (it != stations.end())
+    CompressorStation *station = stations.findMutable(id);
+    if (station)
     {
-        return &it->second;
+        touch(); // объект могут изменить через указатель
     }
-    return nullptr;
+    return station;
 }
 
 const CompressorStation *PipelineNetwork::getStationById(int id) const
 {
-    auto it = stations.find(id);
-    if (it != stations.end())
-    {
-        return &it->second;
-    }
-    return nullptr;
+    return stations.find(id);
 }
 
 vector<Pipe> PipelineNetwork::getAvailablePipesByDiameter(int diameter) const
@@ -427,10 +491,11 @@ vector<Pipe> PipelineNetwork::getAvailablePipesByDiameter(int diameter) const
 
 void PipelineNetwork::markPipeAsConnected(int pipeId, bool connected)
 {
-    auto it = pipes.find(pipeId);
-    if (it != pipes.end())
+    Pipe *pipe = pipes.findMutable(pipeId);
+    if (pipe)
     {
-        it->second.setIsConnected(connected);
+        pipe->setIsConnected(connected);
+        touch();
         logAction("Marked pipe ID " + to_string(pipeId) + " as " + (connected ? "connected" : "disconnected"));
     }
 }
\ No newline at end of file
@@ -3,24 +3,57 @@
 
 #include "Pipe.h"
 #include "CompressorStation.h"
+#include "MemoryTracker.h"
+#include "PersistentMap.h"
 #include <vector>
-#include <unordered_map>
 #include <fstream>
 #include <map>
+#include <functional>
+#include <atomic>
+#include <cstdint>
 
 class PipelineNetwork
 {
 private:
-    std::unordered_map<int, Pipe> pipes;
-    std::unordered_map<int, CompressorStation> stations;
+    // Копия сети (снимок) разделяет с оригиналом все фрагменты, кроме измененных после копирования
+    using PipeMap = PersistentMap<Pipe, MemoryCategory::Pipes>;
+    using StationMap = PersistentMap<CompressorStation, MemoryCategory::Stations>;
+
+    PipeMap pipes;
+    StationMap stations;
+
+    // Версия данных (аналогично Graph::getVersion) для кэшей расчетных структур
+    static std::atomic<uint64_t> nextVersion;
+    uint64_t version = nextVersion.fetch_add(1);
+    void touch() { version = nextVersion.fetch_add(1); }
+
+    // Начиная с этого размера поиск по коллекции идет параллельно
+    static const size_t PARALLEL_SEARCH_THRESHOLD = 16384;
 
     void logAction(const std::string &action) const;
 
+    // Отбор ID по условию. Большие коллекции обходятся по фрагментам параллельно,
+    // результаты склеиваются по возрастанию ID (не зависит от числа потоков)
+    std::vector<int> collectPipeIds(const std::function<bool(const Pipe &)> &predicate) const;
+    std::vector<int> collectStationIds(const std::function<bool(const CompressorStation &)> &predicate) const;
+
 public:
     // Основные методы
     void addPipe();
     void addStation();
 
+    // Добавление готовых объектов без диалога и без записи в журнал (массовый импорт)
+    void addPipe(const Pipe &pipe);
+    void addStation(const CompressorStation &station);
+    size_t getPipeCount() const { return pipes.size(); }
+    size_t getStationCount() const { return stations.size(); }
+
+    // Меняется при любом изменении, в том числе при выдаче неконстантного указателя на объект
+    uint64_t getVersion() const { return version; }
+
+    // Оценка памяти строк-имен, не поместившихся во внутренний буфер std::string
+    void estimateNameBytes(int64_t &pipeNameBytes, int64_t &stationNameBytes) const;
+
     // Методы отображения
     void displayAllObjects() const;
     void displayPipes() const;
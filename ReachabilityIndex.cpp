@@ -0,0 +1,354 @@
+#include "ReachabilityIndex.h"
+#include <algorithm>
+
+using namespace std;
+
+void ReachabilityIndex::build(const Graph &graph)
+{
+    static const MemoryTracker::ScratchTag scratchTag("ReachabilityIndex::build");
+    MemoryTracker::ScratchScope scratch(scratchTag);
+
+    vector<int> stations = graph.getVertices();
+    sort(stations.begin(), stations.end());
+    int n = static_cast<int>(stations.size());
+
+    ScratchMap<int, int> nodeOf;
+    for (int i = 0; i < n; i++)
+    {
+        nodeOf[stations[i]] = i;
+    }
+
+    // Ориентированный граф станций в CSR
+    auto connections = graph.getConnections();
+    ScratchVector<int> start(n + 1, 0);
+    for (const auto &conn : connections)
+    {
+        start[nodeOf[conn.first] + 1]++;
+    }
+    for (int v = 0; v < n; v++)
+    {
+        start[v + 1] += start[v];
+    }
+    ScratchVector<int> heads(start[n]);
+    ScratchVector<int> position(start.begin(), start.end() - 1);
+    for (const auto &conn : connections)
+    {
+        heads[position[nodeOf[conn.first]]++] = nodeOf[conn.second];
+    }
+
+    // Итеративный Тарьян. Компоненты получают номера в обратном топологическом
+    // порядке: ребра конденсации идут от больших номеров к меньшим.
+    ScratchVector<int> index(n, -1), low(n, 0), nextArc(n, 0), component(n, -1);
+    ScratchVector<int> callStack, sccStack;
+    ScratchVector<char> onStack(n, 0);
+    int timer = 0;
+    componentCount = 0;
+
+    for (int root = 0; root < n; root++)
+    {
+        if (index[root] >= 0)
+            continue;
+
+        index[root] = low[root] = timer++;
+        nextArc[root] = start[root];
+        callStack.push_back(root);
+        sccStack.push_back(root);
+        onStack[root] = 1;
+
+        while (!callStack.empty())
+        {
+            int u = callStack.back();
+            if (nextArc[u] < start[u + 1])
+            {
+                int v = heads[nextArc[u]++];
+                if (index[v] < 0)
+                {
+                    index[v] = low[v] = timer++;
+                    nextArc[v] = start[v];
+                    callStack.push_back(v);
+                    sccStack.push_back(v);
+                    onStack[v] = 1;
+                }
+                else if (onStack[v])
+                {
+                    low[u] = min(low[u], index[v]);
+                }
+                continue;
+            }
+
+            callStack.pop_back();
+            if (!callStack.empty())
+            {
+                int parent = callStack.back();
+                low[parent] = min(low[parent], low[u]);
+            }
+
+            if (low[u] == index[u])
+            {
+                int v;
+                do
+                {
+                    v = sccStack.back();
+                    sccStack.pop_back();
+                    onStack[v] = 0;
+                    component[v] = componentCount;
+                } while (v != u);
+                componentCount++;
+            }
+        }
+    }
+
+    componentOf.clear();
+    componentOf.reserve(n);
+    for (int v = 0; v < n; v++)
+    {
+        componentOf[stations[v]] = component[v];
+    }
+
+    // Ребра конденсации (с повторами - они не влияют на ответы)
+    condensedStart.assign(componentCount + 1, 0);
+    for (int u = 0; u < n; u++)
+    {
+        for (int i = start[u]; i < start[u + 1]; i++)
+        {
+            if (component[u] != component[heads[i]])
+                condensedStart[component[u] + 1]++;
+        }
+    }
+    for (int c = 0; c < componentCount; c++)
+    {
+        condensedStart[c + 1] += condensedStart[c];
+    }
+    condensedHeads.assign(condensedStart[componentCount], 0);
+    IndexVector<int> fill(condensedStart.begin(), condensedStart.end() - 1);
+    for (int u = 0; u < n; u++)
+    {
+        for (int i = start[u]; i < start[u + 1]; i++)
+        {
+            if (component[u] != component[heads[i]])
+                condensedHeads[fill[component[u]]++] = component[heads[i]];
+        }
+    }
+
+    bitsetMode = static_cast<size_t>(componentCount) <= BITSET_LIMIT;
+    closure.clear();
+    for (int k = 0; k < 2; k++)
+    {
+        labelLow[k].clear();
+        labelPost[k].clear();
+    }
+
+    if (bitsetMode)
+    {
+        // Запас по ширине строк - под новые станции при инкрементальных обновлениях
+        words = (static_cast<size_t>(componentCount) + 64) / 64 + 1;
+        closure.assign(words * componentCount, 0);
+
+        // Компоненты с меньшим номером обработаны раньше (они ниже по потоку)
+        for (int c = 0; c < componentCount; c++)
+        {
+            uint64_t *row = &closure[c * words];
+            row[c / 64] |= uint64_t(1) << (c % 64);
+            for (int i = condensedStart[c]; i < condensedStart[c + 1]; i++)
+            {
+                const uint64_t *successor = &closure[condensedHeads[i] * words];
+                for (size_t w = 0; w < words; w++)
+                    row[w] |= successor[w];
+            }
+        }
+    }
+    else
+    {
+        // Два обхода в глубину с разным порядком детей: post - номер в постпорядке,
+        // low - минимум post в поддереве достижимости. b достижима из a => интервал b
+        // вложен в интервал a.
+        ScratchVector<int> stack;
+        ScratchVector<int> cursor(componentCount);
+        for (int k = 0; k < 2; k++)
+        {
+            labelLow[k].assign(componentCount, -1);
+            labelPost[k].assign(componentCount, -1);
+            int post = 0;
+
+            // Корни - компоненты без входящих ребер, затем все остальные
+            ScratchVector<char> hasIncoming(componentCount, 0);
+            for (int head : condensedHeads)
+                hasIncoming[head] = 1;
+
+            for (int pass = 0; pass < 2; pass++)
+            {
+                for (int r = 0; r < componentCount; r++)
+                {
+                    int root = k == 0 ? r : componentCount - 1 - r;
+                    if (labelLow[k][root] >= 0 || (pass == 0 && hasIncoming[root]))
+                        continue;
+
+                    labelLow[k][root] = componentCount; // помечен как посещенный
+                    cursor[root] = 0;
+                    stack.push_back(root);
+                    while (!stack.empty())
+                    {
+                        int c = stack.back();
+                        int degree = condensedStart[c + 1] - condensedStart[c];
+                        if (cursor[c] < degree)
+                        {
+                            int offset = k == 0 ? cursor[c] : degree - 1 - cursor[c];
+                            cursor[c]++;
+                            int next = condensedHeads[condensedStart[c] + offset];
+                            if (labelLow[k][next] < 0)
+                            {
+                                labelLow[k][next] = componentCount;
+                                cursor[next] = 0;
+                                stack.push_back(next);
+                            }
+                            continue;
+                        }
+
+                        stack.pop_back();
+                        labelPost[k][c] = post;
+                        int lowest = post;
+                        for (int i = condensedStart[c]; i < condensedStart[c + 1]; i++)
+                        {
+                            lowest = min(lowest, labelLow[k][condensedHeads[i]]);
+                        }
+                        labelLow[k][c] = lowest;
+                        post++;
+                    }
+                }
+            }
+        }
+    }
+
+    graphVersion = graph.getVersion();
+    valid = true;
+}
+
+bool ReachabilityIndex::labelsAllow(int from, int to) const
+{
+    for (int k = 0; k < 2; k++)
+    {
+        if (labelLow[k][to] < labelLow[k][from] || labelPost[k][to] > labelPost[k][from])
+            return false;
+    }
+    return true;
+}
+
+bool ReachabilityIndex::searchWithLabels(int from, int to) const
+{
+    // Обход конденсации только по компонентам, чьи метки допускают достижение to
+    thread_local ScratchVector<uint32_t> seen;
+    thread_local uint32_t generation = 0;
+    if (seen.size() < static_cast<size_t>(componentCount))
+    {
+        seen.assign(componentCount, 0);
+        generation = 0;
+    }
+    if (++generation == 0)
+    {
+        std::fill(seen.begin(), seen.end(), 0);
+        generation = 1;
+    }
+
+    thread_local ScratchVector<int> stack;
+    stack.clear();
+    stack.push_back(from);
+    seen[from] = generation;
+    while (!stack.empty())
+    {
+        int c = stack.back();
+        stack.pop_back();
+        if (c == to)
+            return true;
+
+        for (int i = condensedStart[c]; i < condensedStart[c + 1]; i++)
+        {
+            int next = condensedHeads[i];
+            if (seen[next] != generation && labelsAllow(next, to))
+            {
+                seen[next] = generation;
+                stack.push_back(next);
+            }
+        }
+    }
+    return false;
+}
+
+bool ReachabilityIndex::reaches(int from, int to) const
+{
+    if (from == to)
+        return true;
+
+    auto fromIt = componentOf.find(from);
+    auto toIt = componentOf.find(to);
+    if (!valid || fromIt == componentOf.end() || toIt == componentOf.end())
+        return false;
+
+    int a = fromIt->second;
+    int b = toIt->second;
+    if (a == b)
+        return true;
+    if (bitsetMode)
+        return bit(a, b);
+    return labelsAllow(a, b) && searchWithLabels(a, b);
+}
+
+bool ReachabilityIndex::reaches(const Graph &graph, int from, int to)
+{
+    if (!isBuiltFrom(graph))
+    {
+        build(graph);
+    }
+    return reaches(from, to);
+}
+
+void ReachabilityIndex::addConnection(const Graph &graph, int fromStation, int toStation, uint64_t previousVersion)
+{
+    if (!valid || graphVersion != previousVersion || !bitsetMode)
+    {
+        // Индекс устарел или в режиме меток - перестроится при следующем запросе
+        valid = false;
+        return;
+    }
+
+    // Новые станции - новые одиночные компоненты, если хватает ширины строк
+    for (int station : {fromStation, toStation})
+    {
+        if (componentOf.count(station))
+            continue;
+        if (static_cast<size_t>(componentCount) >= words * 64)
+        {
+            valid = false;
+            return;
+        }
+        int c = componentCount++;
+        componentOf[station] = c;
+        closure.resize(words * componentCount, 0);
+        closure[c * words + c / 64] |= uint64_t(1) << (c % 64);
+    }
+
+    int a = componentOf[fromStation];
+    int b = componentOf[toStation];
+
+    // Ребро, замыкающее цикл, сливает компоненты - проще перестроить
+    if (bit(b, a) && a != b)
+    {
+        valid = false;
+        return;
+    }
+
+    if (!bit(a, b))
+    {
+        // Все, кто достигает a, теперь достигают и все, что достижимо из b
+        const uint64_t *target = &closure[b * words];
+        for (int c = 0; c < componentCount; c++)
+        {
+            if (!bit(c, a))
+                continue;
+            uint64_t *row = &closure[c * words];
+            for (size_t w = 0; w < words; w++)
+                row[w] |= target[w];
+        }
+    }
+
+    graphVersion = graph.getVersion();
+}
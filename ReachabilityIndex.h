@@ -0,0 +1,67 @@
+#ifndef REACHABILITY_INDEX_H
+#define REACHABILITY_INDEX_H
+
+#include "Graph.h"
+#include "MemoryTracker.h"
+#include <cstdint>
+#include <unordered_map>
+
+// Индекс достижимости "находится ли B ниже по потоку от A" по топологии Graph.
+// Строится по конденсации компонент сильной связности (итеративный Тарьян):
+//  - до BITSET_LIMIT компонент - транзитивное замыкание битовыми строками, запрос O(1);
+//  - для больших сетей - интервальные метки двух обходов в глубину (как в GRAIL):
+//    несовпадение интервалов сразу дает "нет", иначе обход с отсечением по меткам.
+// addConnection обновляет замыкание на месте, если ребро не замыкает новый цикл
+// (конденсация при этом не обновляется - битовым строкам она не нужна);
+// в остальных случаях индекс перестраивается при следующем запросе.
+class ReachabilityIndex
+{
+public:
+    static constexpr size_t BITSET_LIMIT = 8192;
+
+private:
+    std::unordered_map<int, int, std::hash<int>, std::equal_to<int>,
+                       TrackingAllocator<std::pair<const int, int>, MemoryCategory::Indexes>>
+        componentOf; // станция -> компонента
+    int componentCount = 0;
+
+    // Конденсация (CSR): ребра между компонентами
+    IndexVector<int> condensedStart;
+    IndexVector<int> condensedHeads;
+
+    // Режим битового замыкания: строка компоненты - words слов по 64 бита
+    bool bitsetMode = false;
+    size_t words = 0;
+    IndexVector<uint64_t> closure;
+
+    // Режим меток: [low, post] для двух порядков обхода
+    IndexVector<int> labelLow[2];
+    IndexVector<int> labelPost[2];
+
+    uint64_t graphVersion = 0;
+    bool valid = false;
+
+    bool bit(int from, int to) const { return (closure[from * words + to / 64] >> (to % 64)) & 1u; }
+    bool labelsAllow(int from, int to) const;
+    bool searchWithLabels(int from, int to) const;
+
+public:
+    void build(const Graph &graph);
+    bool isBuiltFrom(const Graph &graph) const { return valid && graphVersion == graph.getVersion(); }
+    // Версия графа, по которой построен индекс (0 - не построен)
+    uint64_t getGraphVersion() const { return valid ? graphVersion : 0; }
+
+    // Достижима ли станция to из from по направлению труб (перестраивает индекс при необходимости)
+    bool reaches(const Graph &graph, int from, int to);
+    // Запрос к уже построенному индексу (без проверки версии)
+    bool reaches(int from, int to) const;
+
+    // Сообщить о добавленном соединении. previousVersion - версия графа до добавления;
+    // если индекс соответствовал ей, он обновляется без полной перестройки.
+    void addConnection(const Graph &graph, int fromStation, int toStation, uint64_t previousVersion);
+
+    bool usesBitsets() const { return bitsetMode; }
+    int getComponentCount() const { return componentCount; }
+};
+
+#endif
@@ -0,0 +1,381 @@
+#include "ReliabilityAnalyzer.h"
+#include "NetworkCalculator.h"
+#include "TaskScheduler.h"
+#include "MemoryTracker.h"
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <cmath>
+
+using namespace std;
+
+namespace
+{
+    constexpr double HOURS_PER_YEAR = 8760.0;
+    constexpr size_t SAMPLE_GRAIN = 64;
+    constexpr size_t MAX_CHANGED_ARCS = 1024; // измененных дуг на трубу в таблице одиночных отказов
+
+    uint64_t mix(uint64_t z)
+    {
+        // Финализатор SplitMix64
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    // Счетчиковый генератор: i-е число сценария - функция (ключ, i), без общего состояния
+    class CounterRandom
+    {
+    private:
+        uint64_t key;
+        uint64_t counter = 0;
+
+    public:
+        CounterRandom(uint64_t seed, uint64_t sample) : key(mix(seed ^ mix(sample + 0x9E3779B97F4A7C15ULL))) {}
+
+        // Равномерно в [0, 1)
+        double next()
+        {
+            counter++;
+            return static_cast<double>(mix(key + counter * 0x9E3779B97F4A7C15ULL) >> 11) * 0x1.0p-53;
+        }
+    };
+
+    // Отказы труб [begin, end) с вероятностями probability[i] <= maxProbability:
+    // геометрические пропуски по maxProbability и прореживание - O(число отказов),
+    // а не O(число труб)
+    template <typename Fail>
+    void sampleFailures(CounterRandom &random, const ScratchVector<double> &probability,
+                        size_t begin, size_t end, double maxProbability, Fail fail)
+    {
+        if (maxProbability <= 0.0 || begin >= end)
+            return;
+        double logSurvival = log1p(-min(maxProbability, 1.0 - 1e-12));
+        double position = static_cast<double>(begin) - 1.0;
+        while (true)
+        {
+            position += 1.0 + floor(log1p(-random.next()) / logSurvival);
+            if (position >= static_cast<double>(end))
+                break;
+            size_t i = static_cast<size_t>(position);
+            if (random.next() * maxProbability < probability[i])
+                fail(i);
+        }
+    }
+
+    // Есть ли общий элемент в двух отсортированных списках
+    bool intersects(const ScratchVector<int> &a, const ScratchVector<int> &b)
+    {
+        size_t i = 0, j = 0;
+        while (i < a.size() && j < b.size())
+        {
+            if (a[i] == b[j])
+                return true;
+            if (a[i] < b[j])
+                i++;
+            else
+                j++;
+        }
+        return false;
+    }
+}
+
+double ReliabilityAnalyzer::unavailability(const Pipe &pipe, const Settings &settings)
+{
+    auto it = settings.pipeUnavailability.find(pipe.getId());
+    if (it != settings.pipeUnavailability.end())
+    {
+        return min(max(it->second, 0.0), 1.0);
+    }
+    double ratio = max(settings.failuresPerKmYear, 0.0) * max(pipe.getLength(), 0.0) *
+                   max(settings.repairHours, 0.0) / HOURS_PER_YEAR;
+    return ratio / (1.0 + ratio);
+}
+
+ReliabilityAnalyzer::Report ReliabilityAnalyzer::simulate(const FlatGraph &graph,
+                                                          const PipelineNetwork &network,
+                                                          int sourceStation,
+                                                          int targetStation,
+                                                          const Settings &settings)
+{
+    static const MemoryTracker::ScratchTag scratchTag("ReliabilityAnalyzer::simulate");
+    MemoryTracker::ScratchScope scratch(scratchTag);
+    const double unlimited = numeric_limits<double>::max();
+    const double eps = NetworkCalculator::FLOW_EPSILON;
+
+    Report report;
+    int source = graph.nodeOf(sourceStation);
+    int target = graph.nodeOf(targetStation);
+    if (source < 0 || target < 0 || source == target)
+    {
+        return report;
+    }
+
+    // Базовое решение без отказов
+    CalculationWorkspace &baseWorkspace = NetworkCalculator::threadWorkspace();
+    baseWorkspace.prepare(graph);
+    report.baseFlow = NetworkCalculator::calculateMaxFlow(graph, baseWorkspace, sourceStation, targetStation);
+    report.demand = settings.demand > 0.0 ? settings.demand : report.baseFlow;
+    report.samples = max(settings.samples, 0LL);
+
+    // Базовый поток по всем дугам (общий для потоков) и его ненулевые прямые дуги
+    ScratchVector<double> baseArcFlow(graph.getArcCount(), 0.0);
+    ScratchVector<pair<int, double>> baseFlow;
+    for (int arc : baseWorkspace.touchedArcs)
+    {
+        baseArcFlow[arc] = baseWorkspace.flow[arc];
+        if (graph.arc(arc).forward && fabs(baseWorkspace.flow[arc]) > eps)
+        {
+            baseFlow.push_back({arc, baseWorkspace.flow[arc]});
+        }
+    }
+
+    // Исправные трубы: сначала несущие поток [0, flowCount), затем остальные
+    ScratchVector<int> pipeArcs;
+    ScratchVector<double> probability;
+    size_t flowCount = 0;
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (int a = 0; a < graph.getArcCount(); a++)
+        {
+            const FlatGraph::Arc &arc = graph.arc(a);
+            if (!arc.forward || arc.pipeId < 0 || arc.capacity <= eps)
+                continue;
+            bool carries = baseWorkspace.flow[a] > eps;
+            if (carries != (pass == 0))
+                continue;
+            const Pipe *pipe = network.getPipeById(arc.pipeId);
+            pipeArcs.push_back(a);
+            probability.push_back(pipe ? unavailability(*pipe, settings) : 0.0);
+        }
+        if (pass == 0)
+            flowCount = pipeArcs.size();
+    }
+
+    // Вероятность, что первой (по порядку) отказавшей трубой с потоком будет j:
+    // firstFailure[j] - накопленная, нормированная на 1 - P0
+    ScratchVector<double> firstFailure(flowCount, 0.0);
+    double logSurvival = 0.0;
+    double flowMax = 0.0, otherMax = 0.0;
+    for (size_t i = 0; i < flowCount; i++)
+    {
+        logSurvival += log1p(-min(probability[i], 1.0));
+        firstFailure[i] = -expm1(logSurvival);
+        flowMax = max(flowMax, probability[i]);
+    }
+    for (size_t i = flowCount; i < pipeArcs.size(); i++)
+    {
+        otherMax = max(otherMax, probability[i]);
+    }
+    double weight = flowCount > 0 ? firstFailure[flowCount - 1] : 0.0;
+    report.failureProbability = weight;
+
+    // Потоки в разыгранных сценариях (условно: хотя бы одна труба с потоком отказала)
+    size_t sampleCount = weight > 0.0 ? static_cast<size_t>(report.samples) : 0;
+    ScratchVector<double> values(sampleCount, report.baseFlow);
+    atomic<long long> evaluated{0};
+
+    // Рабочая область потока: базовый поток как исходное состояние и обратно
+    auto warmUp = [&](CalculationWorkspace &workspace)
+    {
+        workspace.prepare(graph);
+        workspace.resetFlow();
+        for (const auto &entry : baseFlow)
+        {
+            workspace.setFlow(graph, entry.first, entry.second);
+        }
+        workspace.keepFlow();
+    };
+    auto cleanUp = [&](CalculationWorkspace &workspace)
+    {
+        // Рабочая область потока снова "чистая" для других расчетов
+        workspace.restoreFlow(baseArcFlow);
+        for (const auto &entry : baseFlow)
+        {
+            workspace.setFlow(graph, entry.first, 0.0);
+        }
+        workspace.resetFlow();
+        workspace.clearCapacityOverrides();
+    };
+
+    // Поток при отказе труб failed (первые flowFailures из них несут поток)
+    auto evaluate = [&](CalculationWorkspace &workspace, const ScratchVector<int> &failed,
+                        size_t flowFailures, long long &computed)
+    {
+        // Теплый старт от базового потока (возвращаются только дуги, измененные
+        // прошлым сценарием): все отказавшие трубы закрыты, поток с труб,
+        // которые его несли, перенаправляется в обход
+        workspace.restoreFlow(baseArcFlow);
+        workspace.clearCapacityOverrides();
+        for (int arc : failed)
+        {
+            workspace.setCapacity(arc, 0.0);
+        }
+        double lost = 0.0;
+        for (size_t k = 0; k < flowFailures; k++)
+        {
+            lost += NetworkCalculator::reduceArcFlow(graph, workspace, failed[k], 0.0, source, target);
+        }
+
+        // Все перенаправлено - поток остался базовым, он и так максимален
+        double value = report.baseFlow;
+        if (lost > eps * max(1.0, report.baseFlow))
+        {
+            value -= lost;
+            value += NetworkCalculator::augmentFlow(graph, workspace, source, target, unlimited);
+            computed++;
+        }
+        return max(0.0, min(value, report.baseFlow));
+    };
+
+    // Чаще всего отказывает ровно одна труба с потоком (и, может быть, трубы без
+    // потока): поток при одиночных отказах (как N-1) считается заранее, один раз
+    // на трубу, вместе с дугами, поток которых при этом изменился
+    bool singleTable = sampleCount > flowCount;
+    ScratchVector<double> singleFailure(singleTable ? flowCount : 0, report.baseFlow);
+    ScratchVector<ScratchVector<int>> changedArcs(singleFailure.size());
+    ScratchVector<char> changedKnown(singleFailure.size(), 0);
+    TaskScheduler::instance().parallelForRange(0, singleFailure.size(), 1, [&](size_t begin, size_t end)
+                                               {
+        CalculationWorkspace &workspace = NetworkCalculator::threadWorkspace();
+        warmUp(workspace);
+        ScratchVector<int> failed(1);
+        long long computed = 0;
+        for (size_t i = begin; i < end; i++)
+        {
+            failed[0] = pipeArcs[i];
+            singleFailure[i] = evaluate(workspace, failed, 1, computed);
+
+            // touchedArcs - дуги, поток которых мог отличаться от базового
+            ScratchVector<int> &changed = changedArcs[i];
+            for (int arc : workspace.touchedArcs)
+            {
+                if (graph.arc(arc).forward && fabs(workspace.flow[arc] - baseArcFlow[arc]) > eps)
+                    changed.push_back(arc);
+            }
+            sort(changed.begin(), changed.end());
+            changed.erase(unique(changed.begin(), changed.end()), changed.end());
+            changedKnown[i] = changed.size() <= MAX_CHANGED_ARCS;
+            if (!changedKnown[i])
+                ScratchVector<int>().swap(changed);
+        }
+        cleanUp(workspace);
+        evaluated += computed; });
+
+    // Ответ по таблице без расчета. Одна труба с потоком: поток не больше, чем при
+    // ее одиночном отказе, а решение одиночного отказа допустимо, если не идет по
+    // другим отказавшим трубам - тогда оно и есть ответ. Несколько: если каждая
+    // в одиночку перенаправляется полностью, изменения потока не пересекаются
+    // и не идут по отказавшим трубам, их сумма - допустимый базовый поток
+    auto lookUp = [&](const ScratchVector<int> &failed, const ScratchVector<size_t> &flowIndex, double &value)
+    {
+        if (!singleTable)
+            return false;
+        for (size_t k = 0; k < flowIndex.size(); k++)
+        {
+            size_t i = flowIndex[k];
+            if (!changedKnown[i])
+                return false;
+            if (flowIndex.size() > 1 && singleFailure[i] < report.baseFlow - eps * max(1.0, report.baseFlow))
+                return false;
+            for (size_t j = 0; j < failed.size(); j++)
+            {
+                if (j != k && binary_search(changedArcs[i].begin(), changedArcs[i].end(), failed[j]))
+                    return false;
+            }
+            for (size_t j = 0; j < k; j++)
+            {
+                if (intersects(changedArcs[i], changedArcs[flowIndex[j]]))
+                    return false;
+            }
+        }
+        value = flowIndex.size() == 1 ? singleFailure[flowIndex[0]] : report.baseFlow;
+        return true;
+    };
+
+    TaskScheduler::instance().parallelForRange(0, sampleCount, SAMPLE_GRAIN, [&](size_t begin, size_t end)
+                                               {
+        // Своя рабочая область; плоский граф общий и только читается
+        CalculationWorkspace &workspace = NetworkCalculator::threadWorkspace();
+        warmUp(workspace);
+        ScratchVector<int> failed;
+        ScratchVector<size_t> flowIndex;
+        long long computed = 0;
+
+        for (size_t s = begin; s < end; s++)
+        {
+            CounterRandom random(settings.seed, s);
+            failed.clear();
+            flowIndex.clear();
+
+            // Первая отказавшая труба с потоком - обратной функцией распределения,
+            // остальные - независимо
+            double u = random.next() * weight;
+            size_t first = static_cast<size_t>(upper_bound(firstFailure.begin(), firstFailure.end(), u) -
+                                               firstFailure.begin());
+            first = min(first, flowCount - 1);
+            failed.push_back(pipeArcs[first]);
+            flowIndex.push_back(first);
+            sampleFailures(random, probability, first + 1, flowCount, flowMax, [&](size_t i)
+                           {
+                failed.push_back(pipeArcs[i]);
+                flowIndex.push_back(i); });
+            sampleFailures(random, probability, flowCount, pipeArcs.size(), otherMax, [&](size_t i)
+                           { failed.push_back(pipeArcs[i]); });
+
+            double value;
+            values[s] = lookUp(failed, flowIndex, value) ? value : evaluate(workspace, failed, flowIndex.size(), computed);
+        }
+
+        cleanUp(workspace);
+        evaluated += computed; });
+
+    report.evaluatedSamples = evaluated.load();
+
+    // Смесь: P0 - базовый поток, (1 - P0) - разыгранные сценарии поровну
+    double baseUnserved = max(0.0, report.demand - report.baseFlow);
+    if (sampleCount == 0)
+    {
+        report.expectedFlow = report.baseFlow;
+        report.expectedUnserved = baseUnserved;
+        report.shortfallProbability = baseUnserved > eps * max(1.0, report.demand) ? 1.0 : 0.0;
+    }
+    else
+    {
+        double sum = 0.0, sumSquares = 0.0, unserved = 0.0;
+        size_t shortfalls = 0;
+        for (double value : values)
+        {
+            sum += value;
+            sumSquares += value * value;
+            double missing = max(0.0, report.demand - value);
+            unserved += missing;
+            if (missing > eps * max(1.0, report.demand))
+                shortfalls++;
+        }
+        double n = static_cast<double>(sampleCount);
+        double mean = sum / n;
+        double variance = sampleCount > 1 ? max(0.0, (sumSquares - n * mean * mean) / (n - 1.0)) : 0.0;
+        report.expectedFlow = (1.0 - weight) * report.baseFlow + weight * mean;
+        report.standardError = weight * sqrt(variance / n);
+        report.expectedUnserved = (1.0 - weight) * baseUnserved + weight * unserved / n;
+        report.shortfallProbability = (1.0 - weight) * (baseUnserved > eps * max(1.0, report.demand) ? 1.0 : 0.0) +
+                                      weight * static_cast<double>(shortfalls) / n;
+        sort(values.begin(), values.end());
+    }
+
+    // Базовый поток - наибольший возможный, поэтому масса P0 - в верхнем хвосте
+    for (double level : {1.0, 5.0, 10.0, 50.0})
+    {
+        double quantile = level / 100.0;
+        double flow = report.baseFlow;
+        if (sampleCount > 0 && quantile < weight)
+        {
+            size_t index = static_cast<size_t>(ceil(quantile / weight * static_cast<double>(sampleCount)));
+            flow = values[min(max<size_t>(index, 1), sampleCount) - 1];
+        }
+        report.percentiles.push_back({level, flow});
+    }
+
+    return report;
+}
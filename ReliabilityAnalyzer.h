@@ -0,0 +1,75 @@
+#ifndef RELIABILITY_ANALYZER_H
+#define RELIABILITY_ANALYZER_H
+
+#include "FlatGraph.h"
+#include "PipelineNetwork.h"
+#include <map>
+#include <vector>
+#include <cstdint>
+
+// Надежность поставки источник -> сток методом Монте-Карло: распределение
+// максимального потока при случайных отказах труб. Труба независимо от других
+// находится в отказе с вероятностью (коэффициентом неготовности) u = r / (1 + r),
+// r = частота отказов * длина * время восстановления.
+// Отказ трубы, не несущей поток в базовом решении, поток не меняет, пока вместе
+// с ним не откажет труба с потоком. Поэтому сценарии без отказов труб с потоком
+// (вероятность P0) не разыгрываются: их поток равен базовому. Разыгрываются только
+// сценарии "хотя бы одна труба с потоком отказала" с весом (1 - P0) каждый -
+// так ни один расчет не тратится впустую, а дисперсия оценки падает в 1 / (1 - P0) раз.
+// Поток при одиночном отказе каждой трубы с потоком считается один раз заранее;
+// сценарий, чьи отказы не задевают обходы друг друга, берется из этой таблицы.
+// Случайные числа - счетчиковый генератор от (seed, номер сценария): результат
+// не зависит от числа потоков и разбиения работы. Каждый сценарий считается с теплого
+// старта от базового потока в рабочей области своего потока.
+class ReliabilityAnalyzer
+{
+public:
+    struct Settings
+    {
+        long long samples = 100000;
+        double failuresPerKmYear = 2e-4; // частота отказов трубы на км в год
+        double repairHours = 72.0;       // среднее время восстановления, часы
+        std::map<int, double> pipeUnavailability; // ID трубы -> неготовность (вместо расчета)
+        double demand = 0.0;             // требуемая поставка, м³/час; 0 - базовый поток
+        uint64_t seed = 1;
+    };
+
+    struct Percentile
+    {
+        double level; // %
+        double flow;  // м³/час: с вероятностью level% поток не больше
+    };
+
+    struct Report
+    {
+        double baseFlow = 0.0;
+        double demand = 0.0;
+        long long samples = 0;
+        long long evaluatedSamples = 0;  // расчеты потока: отказы, которые не удалось перенаправить
+                                         // (одиночные отказы - один раз на трубу)
+        double failureProbability = 0.0; // хотя бы одна труба с потоком в отказе (1 - P0)
+        double expectedFlow = 0.0;
+        double standardError = 0.0;      // стандартная ошибка expectedFlow
+        double expectedUnserved = 0.0;   // средняя недопоставка, м³/час
+        double shortfallProbability = 0.0; // вероятность не покрыть demand
+        std::vector<Percentile> percentiles;
+    };
+
+    static Report simulate(const FlatGraph &graph,
+                           const PipelineNetwork &network,
+                           int sourceStation,
+                           int targetStation,
+                           const Settings &settings);
+    static Report simulate(const FlatGraph &graph,
+                           const PipelineNetwork &network,
+                           int sourceStation,
+                           int targetStation)
+    {
+        return simulate(graph, network, sourceStation, targetStation, Settings());
+    }
+
+    // Неготовность трубы по длине, частоте отказов и времени восстановления
+    static double unavailability(const Pipe &pipe, const Settings &settings);
+};
+
+#endif
@@ -0,0 +1,261 @@
+#include "SensitivityAnalyzer.h"
+#include "NetworkCalculator.h"
+#include "TaskScheduler.h"
+#include "MemoryTracker.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace
+{
+    // Шаги замены диаметра, мм
+    const int UPGRADE_DIAMETERS[] = {500, 700, 1000, 1400};
+}
+
+SensitivityAnalyzer::Report SensitivityAnalyzer::analyze(
+    const FlatGraph &graph,
+    const PipelineNetwork &network,
+    int sourceStation,
+    int targetStation)
+{
+    static const MemoryTracker::ScratchTag scratchTag("SensitivityAnalyzer::analyze");
+    MemoryTracker::ScratchScope scratch(scratchTag);
+    const double eps = NetworkCalculator::FLOW_EPSILON;
+
+    Report report;
+    int source = graph.nodeOf(sourceStation);
+    int target = graph.nodeOf(targetStation);
+    if (source < 0 || target < 0 || source == target)
+    {
+        return report;
+    }
+
+    // Базовое решение
+    CalculationWorkspace &baseWorkspace = NetworkCalculator::threadWorkspace();
+    baseWorkspace.prepare(graph);
+    report.baseFlow = NetworkCalculator::calculateMaxFlow(graph, baseWorkspace, sourceStation, targetStation);
+
+    int n = graph.getNodeCount();
+    ScratchVector<char> residual(graph.getArcCount(), 0);
+    for (int a = 0; a < graph.getArcCount(); a++)
+    {
+        residual[a] = baseWorkspace.residual(graph, a) > eps;
+    }
+
+    // Остаточная сеть: достижимые из источника и узлы, из которых достижим сток
+    ScratchVector<char> fromSource(n, 0), toTarget(n, 0);
+    ScratchVector<int> queue;
+    fromSource[source] = 1;
+    queue.push_back(source);
+    for (size_t head = 0; head < queue.size(); head++)
+    {
+        int u = queue[head];
+        for (int a = graph.arcBegin(u); a < graph.arcEnd(u); a++)
+        {
+            int v = graph.arc(a).head;
+            if (residual[a] && !fromSource[v])
+            {
+                fromSource[v] = 1;
+                queue.push_back(v);
+            }
+        }
+    }
+    queue.clear();
+    toTarget[target] = 1;
+    queue.push_back(target);
+    for (size_t head = 0; head < queue.size(); head++)
+    {
+        // Входящие дуги узла - парные к исходящим
+        int v = queue[head];
+        for (int a = graph.arcBegin(v); a < graph.arcEnd(v); a++)
+        {
+            int u = graph.arc(a).head;
+            if (residual[graph.arc(a).reverse] && !toTarget[u])
+            {
+                toTarget[u] = 1;
+                queue.push_back(u);
+            }
+        }
+    }
+
+    // Итеративный Тарьян по дугам остаточной сети
+    ScratchVector<int> index(n, -1), low(n, 0), nextArc(n, 0), component(n, -1);
+    ScratchVector<int> callStack, sccStack;
+    ScratchVector<char> onStack(n, 0);
+    int timer = 0, componentCount = 0;
+    for (int root = 0; root < n; root++)
+    {
+        if (index[root] >= 0)
+            continue;
+
+        index[root] = low[root] = timer++;
+        nextArc[root] = graph.arcBegin(root);
+        callStack.push_back(root);
+        sccStack.push_back(root);
+        onStack[root] = 1;
+
+        while (!callStack.empty())
+        {
+            int u = callStack.back();
+            if (nextArc[u] < graph.arcEnd(u))
+            {
+                int a = nextArc[u]++;
+                if (!residual[a])
+                    continue;
+                int v = graph.arc(a).head;
+                if (index[v] < 0)
+                {
+                    index[v] = low[v] = timer++;
+                    nextArc[v] = graph.arcBegin(v);
+                    callStack.push_back(v);
+                    sccStack.push_back(v);
+                    onStack[v] = 1;
+                }
+                else if (onStack[v])
+                {
+                    low[u] = min(low[u], index[v]);
+                }
+                continue;
+            }
+
+            callStack.pop_back();
+            if (!callStack.empty())
+            {
+                int parent = callStack.back();
+                low[parent] = min(low[parent], low[u]);
+            }
+
+            if (low[u] == index[u])
+            {
+                int v;
+                do
+                {
+                    v = sccStack.back();
+                    sccStack.pop_back();
+                    onStack[v] = 0;
+                    component[v] = componentCount;
+                } while (v != u);
+                componentCount++;
+            }
+        }
+    }
+
+    // Трубы минимальных разрезов и станции каждого разреза
+    ScratchVector<int> cutArcs;
+    for (int a = 0; a < graph.getArcCount(); a++)
+    {
+        const FlatGraph::Arc &arc = graph.arc(a);
+        if (!arc.forward || arc.capacity <= eps)
+            continue;
+        if (arc.pipeId >= 0)
+            report.pipeCount++;
+
+        bool saturated = !residual[a] && baseWorkspace.flow[a] > eps;
+        if (!saturated || component[arc.tail] == component[arc.head])
+            continue;
+        bool critical = fromSource[arc.tail] && toTarget[arc.head];
+        if (arc.pipeId >= 0)
+        {
+            cutArcs.push_back(a);
+            report.minCutPipes++;
+            if (critical)
+                report.criticalPipes++;
+        }
+        else if (critical && graph.isStationArc(a))
+        {
+            report.limitingStations.push_back(graph.stationAt(arc.tail));
+        }
+    }
+    sort(report.limitingStations.begin(), report.limitingStations.end());
+
+    report.ranking.resize(cutArcs.size());
+    for (size_t i = 0; i < cutArcs.size(); i++)
+    {
+        const FlatGraph::Arc &arc = graph.arc(cutArcs[i]);
+        const Pipe *pipe = network.getPipeById(arc.pipeId);
+        PipeSensitivity &entry = report.ranking[i];
+        entry.pipeId = arc.pipeId;
+        entry.fromStation = graph.stationAt(graph.splitInNode(arc.tail));
+        entry.toStation = graph.stationAt(arc.head);
+        entry.diameter = pipe ? pipe->getDiameter() : 0;
+        entry.capacity = arc.capacity;
+        entry.flow = baseWorkspace.flow[cutArcs[i]];
+        entry.onEveryMinCut = fromSource[arc.tail] && toTarget[arc.head];
+        entry.marginalValue = entry.onEveryMinCut ? 1.0 : 0.0;
+        for (int diameter : UPGRADE_DIAMETERS)
+        {
+            if (pipe && diameter > entry.diameter)
+            {
+                double capacity = NetworkCalculator::calculatePipeCapacity(pipe->getLength(), diameter, false);
+                entry.upgrades.push_back({diameter, max(capacity, entry.capacity), 0.0});
+            }
+        }
+    }
+
+    // Копия базового потока: с него стартует расчет каждой трубы
+    ScratchVector<double> baseArcFlow(graph.getArcCount(), 0.0);
+    ScratchVector<pair<int, double>> baseFlow;
+    for (int arc : baseWorkspace.touchedArcs)
+    {
+        baseArcFlow[arc] = baseWorkspace.flow[arc];
+        if (graph.arc(arc).forward && fabs(baseWorkspace.flow[arc]) > eps)
+        {
+            baseFlow.push_back({arc, baseWorkspace.flow[arc]});
+        }
+    }
+
+    // Прирост по шагам диаметра - только у труб каждого разреза: у остальных после
+    // расширения одной трубы увеличивающего пути нет. Поток доращивается не больше
+    // чем на добавленную пропускную способность шага (наклон не больше 1)
+    TaskScheduler::instance().parallelForRange(0, cutArcs.size(), 1, [&](size_t begin, size_t end)
+                                               {
+        CalculationWorkspace &workspace = NetworkCalculator::threadWorkspace();
+        workspace.prepare(graph);
+        workspace.resetFlow();
+        for (const auto &entry : baseFlow)
+        {
+            workspace.setFlow(graph, entry.first, entry.second);
+        }
+        workspace.keepFlow();
+
+        for (size_t i = begin; i < end; i++)
+        {
+            PipeSensitivity &entry = report.ranking[i];
+            if (!entry.onEveryMinCut)
+                continue;
+
+            double gain = 0.0;
+            double capacity = entry.capacity;
+            for (Upgrade &upgrade : entry.upgrades)
+            {
+                workspace.setCapacity(cutArcs[i], upgrade.capacity);
+                gain += NetworkCalculator::augmentFlow(graph, workspace, source, target, upgrade.capacity - capacity);
+                capacity = upgrade.capacity;
+                upgrade.gain = gain;
+            }
+            workspace.restoreFlow(baseArcFlow);
+            workspace.clearCapacityOverrides();
+        }
+
+        // Рабочая область потока снова "чистая" для других расчетов
+        for (const auto &entry : baseFlow)
+        {
+            workspace.setFlow(graph, entry.first, 0.0);
+        }
+        workspace.resetFlow(); });
+
+    // Рейтинг: по убыванию прироста от наибольшего диаметра, затем трубы каждого
+    // разреза, при равенстве - по ID
+    auto bestGain = [](const PipeSensitivity &entry)
+    { return entry.upgrades.empty() ? 0.0 : entry.upgrades.back().gain; };
+    stable_sort(report.ranking.begin(), report.ranking.end(), [&](const PipeSensitivity &a, const PipeSensitivity &b)
+                {
+        if (bestGain(a) != bestGain(b))
+            return bestGain(a) > bestGain(b);
+        if (a.onEveryMinCut != b.onEveryMinCut)
+            return a.onEveryMinCut;
+        return a.pipeId < b.pipeId; });
+
+    return report;
+}
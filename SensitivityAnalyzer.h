@@ -0,0 +1,60 @@
+#ifndef SENSITIVITY_ANALYZER_H
+#define SENSITIVITY_ANALYZER_H
+
+#include "FlatGraph.h"
+#include "PipelineNetwork.h"
+#include <vector>
+#include <cstddef>
+
+// Чувствительность максимального потока источник -> сток к пропускной способности труб
+// по одной решенной остаточной сети, без пересчета потока для каждой трубы.
+// Поток как функция пропускной способности одной трубы - min(C0, C1 + c): он растет
+// с наклоном 1, пока труба входит в каждый минимальный разрез (в остаточной сети
+// есть пути источник -> начало трубы и конец трубы -> сток), затем не меняется.
+// Труба входит хотя бы в один минимальный разрез, если она насыщена и ее концы
+// в разных компонентах сильной связности остаточной сети; такую трубу имеет
+// смысл расширять только вместе с другими трубами разреза.
+// Прирост от замены диаметра считается только для труб каждого разреза: теплый старт
+// от базового потока, доращивание по шагам 500 -> 700 -> 1000 -> 1400.
+// Граф - с расщеплением всех станций (buildStationGraph с splitAll): после расширения
+// трубы ограничить поток может любая станция выше по течению.
+class SensitivityAnalyzer
+{
+public:
+    struct Upgrade
+    {
+        int diameter;     // мм после замены
+        double capacity;  // м³/час после замены
+        double gain;      // прирост максимального потока, м³/час
+    };
+
+    struct PipeSensitivity
+    {
+        int pipeId;
+        int fromStation;
+        int toStation;
+        int diameter;
+        double capacity;      // м³/час
+        double flow;          // в базовом решении
+        bool onEveryMinCut;   // прирост пропускной способности сразу увеличивает поток
+        double marginalValue; // прирост потока на 1 м³/час пропускной способности (1 или 0)
+        std::vector<Upgrade> upgrades; // на каждый больший диаметр, прирост от исходного
+    };
+
+    struct Report
+    {
+        double baseFlow = 0.0;
+        size_t pipeCount = 0;          // исправные трубы графа
+        size_t minCutPipes = 0;        // трубы хотя бы одного минимального разреза
+        size_t criticalPipes = 0;      // трубы каждого минимального разреза
+        std::vector<int> limitingStations; // станции каждого минимального разреза (пропускная способность цехов)
+        std::vector<PipeSensitivity> ranking; // трубы минимальных разрезов по убыванию прироста
+    };
+
+    static Report analyze(const FlatGraph &graph,
+                          const PipelineNetwork &network,
+                          int sourceStation,
+                          int targetStation);
+};
+
+#endif
@@ -0,0 +1,274 @@
+#include "TaskScheduler.h"
+#include "MemoryTracker.h"
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+
+using namespace std;
+
+namespace
+{
+    // Какой пул и какой рабочий поток выполняет текущий код
+    thread_local const TaskScheduler *currentScheduler = nullptr;
+    thread_local size_t currentIndex = 0;
+}
+
+TaskScheduler::TaskGroup::TaskGroup(TaskScheduler &scheduler)
+    : scheduler(scheduler),
+      pending(make_shared<atomic<size_t>>(0)),
+      errorMutex(make_shared<mutex>()),
+      firstError(make_shared<exception_ptr>())
+{
+}
+
+TaskScheduler::TaskGroup::~TaskGroup()
+{
+    // Задачи ссылаются на данные вызывающего кода, поэтому дожидаемся их всегда
+    while (pending->load() > 0)
+    {
+        if (!scheduler.tryRunOne(scheduler.currentWorkerIndex()))
+        {
+            this_thread::yield();
+        }
+    }
+}
+
+void TaskScheduler::TaskGroup::run(Task task)
+{
+    if (scheduler.workers.empty())
+    {
+        task();
+        return;
+    }
+
+    pending->fetch_add(1);
+    auto counter = pending;
+    auto lock = errorMutex;
+    auto error = firstError;
+    // Временная память задачи входит в замер, открытый при ее постановке
+    MemoryTracker::ScratchScope *scope = MemoryTracker::ScratchScope::current();
+    scheduler.submit([task = move(task), counter, lock, error, scope]()
+                     {
+                         MemoryTracker::ScratchScope::Attach attach(scope);
+                         try
+                         {
+                             task();
+                         }
+                         catch (...)
+                         {
+                             lock_guard<mutex> guard(*lock);
+                             if (!*error)
+                             {
+                                 *error = current_exception();
+                             }
+                         }
+                         counter->fetch_sub(1); });
+}
+
+void TaskScheduler::TaskGroup::wait()
+{
+    // Ожидающий поток помогает выполнять задачи вместо простоя
+    while (pending->load() > 0)
+    {
+        if (!scheduler.tryRunOne(scheduler.currentWorkerIndex()))
+        {
+            this_thread::yield();
+        }
+    }
+
+    if (*firstError)
+    {
+        exception_ptr error = *firstError;
+        *firstError = nullptr;
+        rethrow_exception(error);
+    }
+}
+
+TaskScheduler::TaskScheduler(size_t workerCount)
+{
+    start(workerCount);
+}
+
+TaskScheduler::~TaskScheduler()
+{
+    stop();
+}
+
+size_t TaskScheduler::defaultWorkerCount()
+{
+    const char *env = getenv("GAS_NETWORK_THREADS");
+    if (env)
+    {
+        try
+        {
+            int count = stoi(env);
+            if (count >= 0)
+            {
+                return min(static_cast<size_t>(count), maxWorkerCount());
+            }
+        }
+        catch (...)
+        {
+        }
+    }
+
+    unsigned int hardware = thread::hardware_concurrency();
+    // Один поток - это вызывающий, отдельные рабочие потоки ему не нужны
+    return hardware > 1 ? hardware : 0;
+}
+
+TaskScheduler &TaskScheduler::instance()
+{
+    static TaskScheduler scheduler(defaultWorkerCount());
+    return scheduler;
+}
+
+size_t TaskScheduler::maxWorkerCount()
+{
+    unsigned int hardware = thread::hardware_concurrency();
+    // 0 - число ядер неизвестно, считается одно
+    return MAX_WORKERS_PER_CORE * max(hardware, 1u);
+}
+
+void TaskScheduler::setWorkerCount(size_t workerCount)
+{
+    workerCount = min(workerCount, maxWorkerCount());
+    if (workerCount == workers.size())
+    {
+        return;
+    }
+    stop();
+    start(workerCount);
+}
+
+void TaskScheduler::start(size_t workerCount)
+{
+    stopping = false;
+    queues.clear();
+    // Последняя очередь принадлежит внешним потокам
+    for (size_t i = 0; i <= workerCount; i++)
+    {
+        queues.push_back(make_unique<WorkerQueue>());
+    }
+    for (size_t i = 0; i < workerCount; i++)
+    {
+        workers.emplace_back(&TaskScheduler::workerLoop, this, i);
+    }
+}
+
+void TaskScheduler::stop()
+{
+    {
+        lock_guard<mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+
+    for (thread &worker : workers)
+    {
+        worker.join();
+    }
+    workers.clear();
+
+    // Оставшиеся задачи выполняем в текущем потоке, чтобы группы не зависли
+    for (size_t i = 0; i < queues.size(); i++)
+    {
+        Task task;
+        while (popTask(i, true, task))
+        {
+            task();
+        }
+    }
+}
+
+size_t TaskScheduler::currentWorkerIndex() const
+{
+    return currentScheduler == this ? currentIndex : workers.size();
+}
+
+void TaskScheduler::submit(Task task)
+{
+    size_t index = currentWorkerIndex();
+    if (index >= workers.size())
+    {
+        // Внешний поток раздает задачи по кругу, чтобы сразу занять все очереди
+        index = nextQueue.fetch_add(1) % queues.size();
+    }
+
+    {
+        lock_guard<mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(move(task));
+    }
+
+    {
+        lock_guard<mutex> lock(sleepMutex);
+        queuedTasks.fetch_add(1);
+    }
+    wakeUp.notify_one();
+}
+
+bool TaskScheduler::popTask(size_t queueIndex, bool fromBack, Task &task)
+{
+    WorkerQueue &queue = *queues[queueIndex];
+    lock_guard<mutex> lock(queue.mutex);
+    if (queue.tasks.empty())
+    {
+        return false;
+    }
+
+    if (fromBack)
+    {
+        task = move(queue.tasks.back());
+        queue.tasks.pop_back();
+    }
+    else
+    {
+        task = move(queue.tasks.front());
+        queue.tasks.pop_front();
+    }
+    queuedTasks.fetch_sub(1);
+    return true;
+}
+
+bool TaskScheduler::tryRunOne(size_t preferredQueue)
+{
+    Task task;
+
+    // Сначала своя очередь (с конца - лучше для кэша), затем кража у соседей (с начала)
+    bool found = preferredQueue < queues.size() && popTask(preferredQueue, true, task);
+    for (size_t offset = 1; !found && offset <= queues.size(); offset++)
+    {
+        size_t victim = (preferredQueue + offset) % queues.size();
+        found = popTask(victim, false, task);
+    }
+
+    if (!found)
+    {
+        return false;
+    }
+
+    task();
+    return true;
+}
+
+void TaskScheduler::workerLoop(size_t index)
+{
+    currentScheduler = this;
+    currentIndex = index;
+
+    while (true)
+    {
+        if (tryRunOne(index))
+        {
+            continue;
+        }
+
+        unique_lock<mutex> lock(sleepMutex);
+        wakeUp.wait(lock, [this]()
+                    { return stopping.load() || queuedTasks.load() > 0; });
+        if (stopping && queuedTasks.load() == 0)
+        {
+            return;
+        }
+    }
+}
@@ -0,0 +1,143 @@
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <exception>
+#include <cstddef>
+
+// Пул потоков с перехватом задач (work stealing).
+// У каждого рабочего потока своя очередь: владелец берет задачи с конца,
+// остальные потоки крадут с начала. Поток, ожидающий группу задач,
+// сам выполняет задачи, поэтому вложенный параллелизм не приводит к взаимоблокировке.
+class TaskScheduler
+{
+public:
+    using Task = std::function<void()>;
+
+    // Группа задач: run() добавляет задачу, wait() дожидается всех задач группы
+    class TaskGroup
+    {
+    private:
+        TaskScheduler &scheduler;
+        std::shared_ptr<std::atomic<size_t>> pending;
+        std::shared_ptr<std::mutex> errorMutex;
+        std::shared_ptr<std::exception_ptr> firstError;
+
+    public:
+        explicit TaskGroup(TaskScheduler &scheduler);
+        ~TaskGroup();
+
+        TaskGroup(const TaskGroup &) = delete;
+        TaskGroup &operator=(const TaskGroup &) = delete;
+
+        void run(Task task);
+        void wait();
+    };
+
+private:
+    struct WorkerQueue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> workers;
+    std::mutex sleepMutex;
+    std::condition_variable wakeUp;
+    std::atomic<size_t> queuedTasks{0};
+    std::atomic<size_t> nextQueue{0};
+    std::atomic<bool> stopping{false};
+
+    void start(size_t workerCount);
+    void stop();
+    void workerLoop(size_t index);
+    void submit(Task task);
+    bool tryRunOne(size_t preferredQueue);
+    bool popTask(size_t queueIndex, bool fromBack, Task &task);
+
+    static size_t defaultWorkerCount();
+
+public:
+    explicit TaskScheduler(size_t workerCount);
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler &) = delete;
+    TaskScheduler &operator=(const TaskScheduler &) = delete;
+
+    // Общий пул для калькуляторов. Размер по умолчанию - число ядер
+    // или значение переменной окружения GAS_NETWORK_THREADS.
+    static TaskScheduler &instance();
+
+    // Наибольшее число рабочих потоков: MAX_WORKERS_PER_CORE на каждое ядро.
+    // Больше потоков только делят те же ядра и тратят память на очереди и стеки.
+    static constexpr size_t MAX_WORKERS_PER_CORE = 4;
+    static size_t maxWorkerCount();
+
+    // Перезапуск пула с другим числом потоков (0 - выполнять всё в вызывающем потоке).
+    // Число больше maxWorkerCount() ограничивается им.
+    // Нельзя вызывать, пока в пуле выполняются задачи.
+    void setWorkerCount(size_t workerCount);
+    size_t getWorkerCount() const { return workers.size(); }
+
+    // Параллельный цикл по [begin, end) блоками по grain элементов.
+    // body(i) должен писать результат только в ячейку i, тогда порядок
+    // результатов не зависит от числа потоков.
+    template <typename Body>
+    void parallelFor(size_t begin, size_t end, size_t grain, Body body);
+
+    // Параллельный цикл по блокам: body(blockBegin, blockEnd)
+    template <typename Body>
+    void parallelForRange(size_t begin, size_t end, size_t grain, Body body);
+
+    // Номер текущего рабочего потока (0..workerCount-1) или workerCount для внешних потоков
+    size_t currentWorkerIndex() const;
+};
+
+template <typename Body>
+void TaskScheduler::parallelForRange(size_t begin, size_t end, size_t grain, Body body)
+{
+    if (begin >= end)
+    {
+        return;
+    }
+    if (grain == 0)
+    {
+        grain = 1;
+    }
+
+    if (workers.empty() || end - begin <= grain)
+    {
+        body(begin, end);
+        return;
+    }
+
+    TaskGroup group(*this);
+    for (size_t blockBegin = begin; blockBegin < end; blockBegin += grain)
+    {
+        size_t blockEnd = blockBegin + grain < end ? blockBegin + grain : end;
+        group.run([&body, blockBegin, blockEnd]()
+                  { body(blockBegin, blockEnd); });
+    }
+    group.wait();
+}
+
+template <typename Body>
+void TaskScheduler::parallelFor(size_t begin, size_t end, size_t grain, Body body)
+{
+    parallelForRange(begin, end, grain, [&body](size_t blockBegin, size_t blockEnd)
+                     {
+                         for (size_t i = blockBegin; i < blockEnd; i++)
+                         {
+                             body(i);
+                         } });
+}
+
+#endif
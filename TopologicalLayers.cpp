@@ -0,0 +1,102 @@
+#include "TopologicalLayers.h"
+#include "TaskScheduler.h"
+#include <algorithm>
+#include <atomic>
+
+using namespace std;
+
+void TopologicalLayers::build(const FlatGraph &graph, bool parallel)
+{
+    static const MemoryTracker::ScratchTag scratchTag("TopologicalLayers::build");
+    MemoryTracker::ScratchScope scratch(scratchTag);
+
+    int n = graph.getNodeCount();
+    levelOf.assign(n, -1);
+    order.clear();
+    order.reserve(n);
+    levelStart.assign(1, 0);
+
+    ScratchVector<atomic<int>> inDegree(n);
+    for (atomic<int> &degree : inDegree)
+    {
+        degree.store(0, memory_order_relaxed);
+    }
+    for (int a = 0; a < graph.getArcCount(); a++)
+    {
+        const FlatGraph::Arc &arc = graph.arc(a);
+        if (arc.forward)
+            inDegree[arc.head].fetch_add(1, memory_order_relaxed);
+    }
+
+    for (int v = 0; v < n; v++)
+    {
+        if (inDegree[v].load(memory_order_relaxed) == 0)
+            order.push_back(v);
+    }
+
+    TaskScheduler &scheduler = TaskScheduler::instance();
+    vector<ScratchVector<int>> blockNext;
+
+    // Снять уровень [begin, end) позиций order: узлы с обнулившейся степенью - в out
+    auto release = [&](size_t begin, size_t end, ScratchVector<int> &out)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            int u = order[i];
+            for (int a = graph.arcBegin(u); a < graph.arcEnd(u); a++)
+            {
+                const FlatGraph::Arc &arc = graph.arc(a);
+                if (arc.forward && inDegree[arc.head].fetch_sub(1, memory_order_relaxed) == 1)
+                    out.push_back(arc.head);
+            }
+        }
+    };
+
+    int level = 0;
+    size_t begin = 0;
+    while (begin < order.size())
+    {
+        size_t end = order.size();
+        for (size_t i = begin; i < end; i++)
+        {
+            levelOf[order[i]] = level;
+        }
+        levelStart.push_back(static_cast<int>(end));
+
+        size_t size = end - begin;
+        if (!parallel || scheduler.getWorkerCount() == 0 || size < PARALLEL_THRESHOLD)
+        {
+            ScratchVector<int> next;
+            release(begin, end, next);
+            sort(next.begin(), next.end());
+            order.insert(order.end(), next.begin(), next.end());
+        }
+        else
+        {
+            size_t grain = max<size_t>(512, size / (scheduler.getWorkerCount() * 4));
+            size_t blocks = (size + grain - 1) / grain;
+            if (blockNext.size() < blocks)
+            {
+                blockNext.resize(blocks);
+            }
+
+            // order не растет, пока уровень обрабатывается: следующий уровень
+            // собирается в блочных буферах и дописывается после group.wait()
+            scheduler.parallelForRange(begin, end, grain, [&](size_t blockBegin, size_t blockEnd)
+                                       {
+                                           ScratchVector<int> &out = blockNext[(blockBegin - begin) / grain];
+                                           out.clear();
+                                           release(blockBegin, blockEnd, out); });
+
+            size_t nextBegin = order.size();
+            for (size_t b = 0; b < blocks; b++)
+            {
+                order.insert(order.end(), blockNext[b].begin(), blockNext[b].end());
+            }
+            sort(order.begin() + nextBegin, order.end());
+        }
+
+        begin = end;
+        level++;
+    }
+}
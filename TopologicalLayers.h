@@ -0,0 +1,40 @@
+#ifndef TOPOLOGICAL_LAYERS_H
+#define TOPOLOGICAL_LAYERS_H
+
+#include "FlatGraph.h"
+#include "MemoryTracker.h"
+
+// Послойная топологическая сортировка (Кан по уровням): уровень станции -
+// длина самой длинной цепочки труб от станций без входящих труб (истоков).
+// Все станции уровня k зависят только от станций уровней < k, поэтому уровни -
+// это очередность этапов (подъем давления, расчеты вниз по потоку), а станции
+// одного уровня можно обрабатывать параллельно.
+// Уровень считается параллельно: фронт делится на блоки, входящие степени -
+// атомарные счетчики; узел попадает в следующий уровень у потока, который
+// обнулил его степень. Внутри уровня узлы упорядочены по номеру, так что
+// результат не зависит от числа потоков.
+// Станции на циклах и ниже них по потоку уровня не получают (-1).
+class TopologicalLayers
+{
+public:
+    static constexpr size_t PARALLEL_THRESHOLD = 2048; // меньший уровень обрабатывается в одном потоке
+
+private:
+    IndexVector<int> levelOf;    // узел -> уровень или -1
+    IndexVector<int> order;      // узлы по уровням
+    IndexVector<int> levelStart; // узлы уровня k - order[levelStart[k], levelStart[k + 1])
+
+public:
+    void build(const FlatGraph &graph, bool parallel = true);
+
+    int getLevelCount() const { return static_cast<int>(levelStart.size()) - 1; }
+    int level(int node) const { return levelOf[node]; }
+    int levelBegin(int level) const { return levelStart[level]; }
+    int levelEnd(int level) const { return levelStart[level + 1]; }
+    int nodeAt(int position) const { return order[position]; }
+
+    // Узлы без уровня: на циклах или ниже них по потоку
+    int getUnlayeredCount() const { return static_cast<int>(levelOf.size() - order.size()); }
+};
+
+#endif
@@ -0,0 +1,440 @@
+#include "TransientSimulator.h"
+#include "NetworkCalculator.h"
+#include "TaskScheduler.h"
+#include "MemoryTracker.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace
+{
+    constexpr double GAS_CONSTANT = 8.314462;   // Дж/(моль·К)
+    constexpr double AIR_MOLAR_MASS = 0.028964; // кг/моль
+    constexpr double BASE_TEMPERATURE = 288.15; // К
+    constexpr double BASE_PRESSURE = 101325.0;  // Па
+    constexpr double PA_PER_BAR = 1e5;
+    constexpr double KPA_PER_PA = 1e-3;
+    constexpr double SECONDS_PER_HOUR = 3600.0;
+    constexpr double PRESSURE_FLOOR = 1e3; // Па, защита знаменателя трения
+    constexpr size_t NODE_GRAIN = 16384;
+    constexpr size_t STATION_GRAIN = 2048;
+}
+
+TransientSimulator::Result TransientSimulator::simulate(const Graph &graph,
+                                                        const PipelineNetwork &network,
+                                                        const Scenario &scenario,
+                                                        const Settings &settings)
+{
+    static const MemoryTracker::ScratchTag scratchTag("TransientSimulator::simulate");
+    MemoryTracker::ScratchScope scratch(scratchTag);
+    Result result;
+
+    // Начальное состояние - стационарный режим по Уэймуту
+    HydraulicSolver::Settings gas = settings.gas;
+    gas.equation = HydraulicSolver::Equation::Weymouth;
+    HydraulicSolver::Result steady = HydraulicSolver::solve(graph, network, scenario.sourcePressure, scenario.demand, gas);
+    result.unresolvedStations = steady.unresolvedStations;
+    if (!steady.converged || !steady.feasible || steady.stations.empty())
+    {
+        return result;
+    }
+
+    const FlatGraph &flat = NetworkCalculator::cachedFlatGraph(graph, network);
+    int n = flat.getNodeCount();
+    TaskScheduler &scheduler = TaskScheduler::instance();
+
+    double molarMass = AIR_MOLAR_MASS * gas.gasGravity;
+    double soundSquare = gas.compressibility * GAS_CONSTANT * gas.temperature / molarMass; // c², м²/с²
+    double baseDensity = BASE_PRESSURE * molarMass / (GAS_CONSTANT * BASE_TEMPERATURE);  // кг/м³ при стандартных условиях
+    double massPerFlow = baseDensity / SECONDS_PER_HOUR;                                 // (кг/с) на м³/час
+    double minPressure = settings.minPressure * PA_PER_BAR;
+
+    // Станции: рассчитываемые - достигнутые в стационарном расчете
+    ScratchVector<char> active(n, 0), fixed(n, 0), tripped(n, 0);
+    ScratchVector<double> stationPressure(n, 0.0), baseRatio(n, 1.0), ratio(n, 1.0), demandMass(n, 0.0);
+    ScratchVector<int> activeStations;
+    for (const HydraulicSolver::StationState &state : steady.stations)
+    {
+        int v = flat.nodeOf(state.stationId);
+        active[v] = 1;
+        stationPressure[v] = state.pressure * PA_PER_BAR;
+        if (state.outletPressure > state.pressure)
+            baseRatio[v] = state.outletPressure / state.pressure; // с учетом предела нагнетания
+        activeStations.push_back(v);
+    }
+    for (const auto &entry : scenario.sourcePressure)
+    {
+        int v = flat.nodeOf(entry.first);
+        if (v >= 0 && active[v] && entry.second > 0.0)
+            fixed[v] = 1;
+    }
+    for (const auto &entry : scenario.demand)
+    {
+        int v = flat.nodeOf(entry.first);
+        if (v >= 0 && active[v])
+            demandMass[v] += entry.second * massPerFlow;
+    }
+
+    ScratchMap<int, const HydraulicSolver::PipeState *> steadyPipe;
+    for (const HydraulicSolver::PipeState &state : steady.pipes)
+    {
+        steadyPipe[state.pipeId] = &state;
+    }
+
+    // Трубы между рассчитываемыми станциями (и в ремонте - как перекрытые)
+    ScratchVector<int> pipeIds, pipeTail, pipeHead, segmentCount, nodeBegin;
+    ScratchVector<double> area, diameters, segment, lambda;
+    ScratchVector<char> open;
+    ScratchMap<int, int> pipeIndex;
+    int cursor = 1; // узел 0 - заглушка: у первого узла трубы есть "предыдущий" расход
+    double minSegment = 0.0;
+    for (int a = 0; a < flat.getArcCount(); a++)
+    {
+        const FlatGraph::Arc &arc = flat.arc(a);
+        if (!arc.forward || arc.pipeId < 0 || arc.tail == arc.head || !active[arc.tail] || !active[arc.head])
+            continue;
+        const Pipe *pipe = network.getPipeById(arc.pipeId);
+        if (!pipe)
+            continue;
+
+        double length = max(pipe->getLength(), 1e-3) * 1000.0;
+        double diameter = pipe->getDiameter() / 1000.0;
+        int segments = max(1, static_cast<int>(ceil(pipe->getLength() / settings.segmentLength)));
+        double pipeArea = M_PI * diameter * diameter / 4.0;
+
+        // λ, при котором стационарный расход совпадает с уравнением Уэймута
+        double coefficient = HydraulicSolver::flowCoefficient(*pipe, gas) * KPA_PER_PA;
+        double match = SECONDS_PER_HOUR * pipeArea / (baseDensity * coefficient);
+
+        pipeIndex[arc.pipeId] = static_cast<int>(pipeIds.size());
+        pipeIds.push_back(arc.pipeId);
+        pipeTail.push_back(arc.tail);
+        pipeHead.push_back(arc.head);
+        segmentCount.push_back(segments);
+        nodeBegin.push_back(cursor);
+        area.push_back(pipeArea);
+        diameters.push_back(diameter);
+        segment.push_back(length / segments);
+        lambda.push_back(diameter / (soundSquare * length) * match * match);
+        open.push_back(!pipe->isUnderRepair() && steadyPipe.count(arc.pipeId));
+        cursor += segments + 1;
+        minSegment = minSegment == 0.0 ? length / segments : min(minSegment, length / segments);
+    }
+    size_t pipeCount = pipeIds.size();
+    size_t nodeCount = static_cast<size_t>(cursor) + 1; // и заглушка в конце
+    result.segments = cursor - 1 - static_cast<int>(pipeCount);
+
+    // Шаг по времени: Курант, целое число шагов на интервал вывода
+    double interval = max(settings.outputInterval, 1e-6) * SECONDS_PER_HOUR;
+    double duration = max(settings.duration, 0.0) * SECONDS_PER_HOUR;
+    double maxStep = pipeCount > 0 ? settings.courant * minSegment / sqrt(soundSquare) : interval;
+    long long stepsPerOutput = max<long long>(1, static_cast<long long>(ceil(interval / maxStep)));
+    double dt = interval / stepsPerOutput;
+    long long outputs = static_cast<long long>(ceil(duration / interval - 1e-9));
+    result.timeStep = dt;
+
+    // Состояние и коэффициенты схемы по узлам (SoA); на последнем узле трубы
+    // расход-заглушка с нулевыми коэффициентами
+    ScratchVector<double> pressure(nodeCount, PRESSURE_FLOOR), flux(nodeCount, 0.0);
+    ScratchVector<double> gradFactor(nodeCount, 0.0), frictionFactor(nodeCount, 0.0);
+    ScratchVector<double> storeFactor(nodeCount, 0.0), packWeight(nodeCount, 0.0);
+    for (size_t k = 0; k < pipeCount; k++)
+    {
+        int first = nodeBegin[k];
+        int segments = segmentCount[k];
+        double dx = segment[k];
+
+        double inlet, outlet, massFlux;
+        auto found = steadyPipe.find(pipeIds[k]);
+        if (open[k])
+        {
+            inlet = found->second->inletPressure * PA_PER_BAR;
+            outlet = found->second->outletPressure * PA_PER_BAR;
+            massFlux = found->second->flow * massPerFlow / area[k];
+        }
+        else
+        {
+            inlet = outlet = min(stationPressure[pipeTail[k]], stationPressure[pipeHead[k]]);
+            massFlux = 0.0;
+        }
+
+        for (int i = 0; i <= segments; i++)
+        {
+            int j = first + i;
+            double share = static_cast<double>(i) / segments;
+            pressure[j] = sqrt(max(inlet * inlet - (inlet * inlet - outlet * outlet) * share, 0.0));
+            packWeight[j] = area[k] * dx * (i == 0 || i == segments ? 0.5 : 1.0);
+            if (i < segments)
+            {
+                flux[j] = massFlux;
+                gradFactor[j] = dt / dx;
+                frictionFactor[j] = dt * lambda[k] * soundSquare / (2.0 * diameters[k]);
+            }
+            if (i > 0 && i < segments)
+                storeFactor[j] = dt * soundSquare / dx;
+        }
+    }
+
+    // Трубы станций: k - исходящая, ~k - входящая
+    ScratchVector<int> adjacencyStart(n + 1, 0), adjacency;
+    for (size_t k = 0; k < pipeCount; k++)
+    {
+        adjacencyStart[pipeTail[k] + 1]++;
+        adjacencyStart[pipeHead[k] + 1]++;
+    }
+    for (int v = 0; v < n; v++)
+        adjacencyStart[v + 1] += adjacencyStart[v];
+    adjacency.resize(adjacencyStart[n]);
+    {
+        ScratchVector<int> fill(adjacencyStart.begin(), adjacencyStart.end() - 1);
+        for (size_t k = 0; k < pipeCount; k++)
+        {
+            adjacency[fill[pipeTail[k]]++] = static_cast<int>(k);
+            adjacency[fill[pipeHead[k]]++] = ~static_cast<int>(k);
+        }
+    }
+
+    // Объемы полуотрезков у станций и компримирование - после каждого события.
+    // Событие не создает и не уничтожает газ: масса станции - полуотрезки ее открытых
+    // труб под их текущим давлением (у вновь открытой трубы - давление ее конца),
+    // давление станции пересчитывается на новый объем и степень сжатия
+    ScratchVector<double> volumeIn(n, 0.0), volumeOut(n, 0.0);
+    auto refresh = [&](bool conserve)
+    {
+        for (int v : activeStations)
+        {
+            double mass = 0.0;
+            volumeIn[v] = volumeOut[v] = 0.0;
+            for (int q = adjacencyStart[v]; q < adjacencyStart[v + 1]; q++)
+            {
+                int code = adjacency[q];
+                int k = code >= 0 ? code : ~code;
+                if (!open[k])
+                    continue;
+                double half = area[k] * segment[k] / 2.0;
+                if (code >= 0)
+                {
+                    volumeOut[v] += half;
+                    mass += half * pressure[nodeBegin[k]];
+                }
+                else
+                {
+                    volumeIn[v] += half;
+                    mass += half * pressure[nodeBegin[k] + segmentCount[k]];
+                }
+            }
+            ratio[v] = tripped[v] ? 1.0 : baseRatio[v];
+
+            double volume = volumeIn[v] + ratio[v] * volumeOut[v];
+            if (!conserve || volume <= 0.0)
+                continue;
+            if (!fixed[v])
+                stationPressure[v] = mass / volume;
+            double outlet = stationPressure[v] * ratio[v];
+            for (int q = adjacencyStart[v]; q < adjacencyStart[v + 1]; q++)
+            {
+                int code = adjacency[q];
+                int k = code >= 0 ? code : ~code;
+                if (!open[k])
+                    continue;
+                if (code >= 0)
+                    pressure[nodeBegin[k]] = outlet;
+                else
+                    pressure[nodeBegin[k] + segmentCount[k]] = stationPressure[v];
+            }
+        }
+        // Концы перекрытой трубы - самостоятельные полуотрезки без притока извне
+        for (size_t k = 0; k < pipeCount; k++)
+        {
+            double factor = open[k] ? 0.0 : 2.0 * dt * soundSquare / segment[k];
+            storeFactor[nodeBegin[k]] = factor;
+            storeFactor[nodeBegin[k] + segmentCount[k]] = factor;
+        }
+    };
+    refresh(false);
+
+    ScratchVector<double> injectionMass(n, 0.0), servedMass(n, 0.0), unservedMass(n, 0.0);
+    auto updateStation = [&](size_t i)
+    {
+        int v = activeStations[i];
+        double inflow = 0.0, outflow = 0.0;
+        for (int q = adjacencyStart[v]; q < adjacencyStart[v + 1]; q++)
+        {
+            int code = adjacency[q];
+            int k = code >= 0 ? code : ~code;
+            if (!open[k])
+                continue;
+            if (code >= 0)
+                outflow += area[k] * flux[nodeBegin[k]];
+            else
+                inflow += area[k] * flux[nodeBegin[k] + segmentCount[k] - 1];
+        }
+
+        double p = stationPressure[v];
+        double served = demandMass[v];
+        double unserved = 0.0;
+        if (fixed[v])
+        {
+            injectionMass[v] = outflow - inflow + served;
+        }
+        else if (volumeIn[v] + volumeOut[v] <= 0.0)
+        {
+            unserved = served; // станция отрезана от всех труб
+            served = 0.0;
+        }
+        else
+        {
+            // Полуотрезки входящих труб - под давлением станции, исходящих - под давлением нагнетания
+            double factor = dt * soundSquare;
+            double volume = volumeIn[v] + ratio[v] * volumeOut[v];
+            double mass = volume * p + factor * (inflow - outflow - served);
+            double lowest = volume * minPressure;
+            if (mass < lowest && served > 0.0)
+            {
+                // Давление ниже допустимого - отбор ограничивается
+                unserved = min(served, (lowest - mass) / factor);
+                served -= unserved;
+                mass += factor * unserved;
+            }
+            p = mass / volume;
+            stationPressure[v] = p;
+        }
+        servedMass[v] = served;
+        unservedMass[v] = unserved;
+
+        double outlet = p * ratio[v];
+        for (int q = adjacencyStart[v]; q < adjacencyStart[v + 1]; q++)
+        {
+            int code = adjacency[q];
+            int k = code >= 0 ? code : ~code;
+            if (!open[k])
+                continue;
+            if (code >= 0)
+                pressure[nodeBegin[k]] = outlet;
+            else
+                pressure[nodeBegin[k] + segmentCount[k]] = p;
+        }
+    };
+
+    // Шаг: расходы по перепадам давлений (трение неявно), давления по балансу отрезков,
+    // затем станции. Проходы по узлам без ветвлений - векторизуются компилятором.
+    double *p = pressure.data();
+    double *phi = flux.data();
+    const double *grad = gradFactor.data();
+    const double *friction = frictionFactor.data();
+    const double *store = storeFactor.data();
+    auto step = [&]()
+    {
+        scheduler.parallelForRange(1, nodeCount - 1, NODE_GRAIN, [&](size_t begin, size_t end)
+                                   {
+                                       for (size_t j = begin; j < end; j++)
+                                       {
+                                           double average = fmax(0.5 * (p[j] + p[j + 1]), PRESSURE_FLOOR);
+                                           double drive = phi[j] - grad[j] * (p[j + 1] - p[j]);
+                                           phi[j] = drive / (1.0 + friction[j] * fabs(phi[j]) / average);
+                                       } });
+        scheduler.parallelForRange(1, nodeCount - 1, NODE_GRAIN, [&](size_t begin, size_t end)
+                                   {
+                                       for (size_t j = begin; j < end; j++)
+                                           p[j] -= store[j] * (phi[j] - phi[j - 1]); });
+        scheduler.parallelFor(0, activeStations.size(), STATION_GRAIN, updateStation);
+    };
+
+    for (int id : scenario.monitoredStations)
+    {
+        int v = flat.nodeOf(id);
+        if (v >= 0 && active[v])
+            result.monitoredStations.push_back(id);
+    }
+
+    auto record = [&](double time)
+    {
+        Sample sample;
+        sample.time = time / SECONDS_PER_HOUR;
+        double mass = 0.0;
+        for (size_t j = 1; j + 1 < nodeCount; j++)
+            mass += p[j] * packWeight[j];
+        sample.linePack = mass / soundSquare / baseDensity / 1e6;
+
+        double injection = 0.0, delivered = 0.0, unserved = 0.0;
+        double lowest = stationPressure[activeStations[0]];
+        for (int v : activeStations)
+        {
+            injection += injectionMass[v];
+            delivered += servedMass[v];
+            unserved += unservedMass[v];
+            lowest = min(lowest, stationPressure[v]);
+        }
+        sample.injection = injection / massPerFlow;
+        sample.delivered = delivered / massPerFlow;
+        sample.unserved = unserved / massPerFlow;
+        sample.minPressure = lowest / PA_PER_BAR;
+        for (int id : result.monitoredStations)
+            sample.pressures.push_back(stationPressure[flat.nodeOf(id)] / PA_PER_BAR);
+        result.samples.push_back(sample);
+    };
+
+    // Нулевой момент: расходы станций по начальному состоянию
+    for (int v : activeStations)
+    {
+        servedMass[v] = demandMass[v];
+    }
+    for (const HydraulicSolver::StationState &state : steady.stations)
+    {
+        int v = flat.nodeOf(state.stationId);
+        if (fixed[v])
+            injectionMass[v] = state.injection * massPerFlow;
+    }
+    record(0.0);
+
+    vector<Event> events = scenario.events;
+    stable_sort(events.begin(), events.end(), [](const Event &a, const Event &b)
+                { return a.time < b.time; });
+    size_t nextEvent = 0;
+
+    for (long long output = 1; output <= outputs; output++)
+    {
+        for (long long s = 0; s < stepsPerOutput; s++)
+        {
+            double time = static_cast<double>(result.steps) * dt;
+            bool changed = false;
+            while (nextEvent < events.size() && events[nextEvent].time * SECONDS_PER_HOUR <= time + 1e-9)
+            {
+                const Event &event = events[nextEvent++];
+                bool isPipeEvent = event.type == EventType::PipeRepair || event.type == EventType::PipeReturn;
+                if (isPipeEvent)
+                {
+                    auto found = pipeIndex.find(event.id);
+                    if (found == pipeIndex.end())
+                        continue;
+                    open[found->second] = event.type == EventType::PipeReturn;
+                    changed = true;
+                    result.appliedEvents++;
+                    continue;
+                }
+
+                int v = flat.nodeOf(event.id);
+                if (v < 0 || !active[v])
+                    continue;
+                if (event.type == EventType::DemandChange)
+                    demandMass[v] = event.value * massPerFlow;
+                else
+                {
+                    tripped[v] = event.type == EventType::CompressorTrip;
+                    changed = true;
+                }
+                result.appliedEvents++;
+            }
+            if (changed)
+                refresh(true);
+
+            step();
+            result.steps++;
+        }
+        record(static_cast<double>(result.steps) * dt);
+    }
+
+    result.started = true;
+    return result;
+}
@@ -0,0 +1,99 @@
+#ifndef TRANSIENT_SIMULATOR_H
+#define TRANSIENT_SIMULATOR_H
+
+#include "Graph.h"
+#include "PipelineNetwork.h"
+#include "HydraulicSolver.h"
+#include <map>
+#include <vector>
+
+// Нестационарный расчет газовой сети: изменение давлений и запаса газа в трубах
+// после отключения компрессоров, вывода труб в ремонт и изменения отборов.
+// Изотермические уравнения газовой динамики в трубе:
+//   dp/dt + c² dφ/dx = 0,   dφ/dt + dp/dx = -λ c² φ|φ| / (2 D p),
+// φ - массовый расход на единицу площади, c - скорость звука в газе.
+// Каждая труба делится по длине на отрезки не длиннее segmentLength; давления - в узлах,
+// расходы - на отрезках (разнесенная сетка), явная схема с неявным трением,
+// шаг по времени - из условия Куранта. Состояние хранится массивами по всем узлам сети
+// (SoA): шаг - два векторизуемых прохода по массивам, поделенных между потоками,
+// и баланс масс в станциях. Коэффициент трения λ каждой трубы подобран так,
+// что стационарный режим совпадает с уравнением Уэймута HydraulicSolver; начальное
+// состояние - его стационарный расчет. Компрессоры работают с постоянной степенью сжатия
+// стационарного режима (нагнетание = степень * давление станции): такая станция
+// не раскачивает волны давления, в отличие от идеального регулятора нагнетания.
+// Останов и пуск компрессора, вывод трубы в ремонт и ее возврат сохраняют массу газа
+// станции: давление пересчитывается на новый объем ее полуотрезков и степень сжатия.
+class TransientSimulator
+{
+public:
+    enum class EventType
+    {
+        CompressorTrip,    // цеха станции останавливаются
+        CompressorRestart, // станция снова компримирует со стационарной степенью сжатия
+        PipeRepair,        // труба перекрывается с обоих концов, газ в ней остается
+        PipeReturn,        // труба снова открыта
+        DemandChange       // новый отбор станции, м³/час
+    };
+
+    struct Event
+    {
+        double time; // часы от начала расчета
+        EventType type;
+        int id;      // ID станции или трубы
+        double value = 0.0;
+    };
+
+    struct Scenario
+    {
+        std::map<int, double> sourcePressure; // бар
+        std::map<int, double> demand;         // м³/час
+        std::vector<Event> events;
+        std::vector<int> monitoredStations;   // станции, давления которых попадают во временной ряд
+    };
+
+    struct Settings
+    {
+        HydraulicSolver::Settings gas;  // свойства газа и компрессоров (уравнение - всегда Уэймута)
+        double segmentLength = 10.0;    // км
+        double courant = 0.8;           // доля шага по условию Куранта
+        double duration = 24.0;         // часы
+        double outputInterval = 0.25;   // часы
+        double minPressure = 1.0;       // бар; ниже отбор станции ограничивается
+    };
+
+    struct Sample
+    {
+        double time;        // часы
+        double linePack;    // запас газа в трубах, млн м³
+        double injection;   // закачка станций заданного давления, м³/час
+        double delivered;   // отбор потребителей, м³/час
+        double unserved;    // недопоставка из-за падения давления, м³/час
+        double minPressure; // бар, по рассчитываемым станциям
+        std::vector<double> pressures; // бар, в порядке monitoredStations
+    };
+
+    struct Result
+    {
+        bool started = false;  // стационарный расчет для начального состояния сошелся
+        int segments = 0;
+        double timeStep = 0.0; // с
+        long long steps = 0;
+        int appliedEvents = 0;
+        std::vector<int> monitoredStations; // найденные среди рассчитываемых
+        std::vector<int> unresolvedStations;
+        std::vector<Sample> samples;
+    };
+
+    static Result simulate(const Graph &graph,
+                           const PipelineNetwork &network,
+                           const Scenario &scenario,
+                           const Settings &settings);
+    static Result simulate(const Graph &graph,
+                           const PipelineNetwork &network,
+                           const Scenario &scenario)
+    {
+        return simulate(graph, network, scenario, Settings());
+    }
+};
+
+#endif
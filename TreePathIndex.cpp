@@ -0,0 +1,137 @@
+#include "TreePathIndex.h"
+#include <algorithm>
+#include <limits>
+
+using namespace std;
+
+void TreePathIndex::build(const IndexVector<int> &parent, const IndexVector<double> &weight)
+{
+    int n = static_cast<int>(parent.size());
+
+    // Порядок обхода от корней, чтобы глубина родителя была известна раньше
+    IndexVector<int> childStart(n + 1, 0);
+    for (int v = 0; v < n; v++)
+    {
+        if (parent[v] >= 0)
+            childStart[parent[v] + 1]++;
+    }
+    for (int v = 0; v < n; v++)
+    {
+        childStart[v + 1] += childStart[v];
+    }
+    IndexVector<int> children(childStart[n]);
+    IndexVector<int> position(childStart.begin(), childStart.end() - 1);
+    for (int v = 0; v < n; v++)
+    {
+        if (parent[v] >= 0)
+            children[position[parent[v]]++] = v;
+    }
+
+    depth.assign(n, 0);
+    root.assign(n, 0);
+    IndexVector<int> order;
+    order.reserve(n);
+    for (int v = 0; v < n; v++)
+    {
+        if (parent[v] < 0)
+        {
+            root[v] = v;
+            order.push_back(v);
+        }
+    }
+    for (size_t head = 0; head < order.size(); head++)
+    {
+        int u = order[head];
+        for (int i = childStart[u]; i < childStart[u + 1]; i++)
+        {
+            int v = children[i];
+            depth[v] = depth[u] + 1;
+            root[v] = root[u];
+            order.push_back(v);
+        }
+    }
+
+    int levels = 1;
+    while ((1 << levels) < n)
+        levels++;
+
+    ancestor.assign(levels, IndexVector<int>(n, 0));
+    ancestorMin.assign(levels, IndexVector<double>(n, numeric_limits<double>::max()));
+    for (int v = 0; v < n; v++)
+    {
+        ancestor[0][v] = parent[v] >= 0 ? parent[v] : v;
+        if (parent[v] >= 0)
+            ancestorMin[0][v] = weight[v];
+    }
+    for (int k = 1; k < levels; k++)
+    {
+        for (int v = 0; v < n; v++)
+        {
+            int middle = ancestor[k - 1][v];
+            ancestor[k][v] = ancestor[k - 1][middle];
+            ancestorMin[k][v] = min(ancestorMin[k - 1][v], ancestorMin[k - 1][middle]);
+        }
+    }
+}
+
+int TreePathIndex::lowestCommonAncestor(int a, int b) const
+{
+    if (root[a] != root[b])
+        return -1;
+
+    if (depth[a] < depth[b])
+        swap(a, b);
+
+    int levels = static_cast<int>(ancestor.size());
+    for (int k = levels - 1; k >= 0; k--)
+    {
+        if (depth[a] - (1 << k) >= depth[b])
+            a = ancestor[k][a];
+    }
+    if (a == b)
+        return a;
+
+    for (int k = levels - 1; k >= 0; k--)
+    {
+        if (ancestor[k][a] != ancestor[k][b])
+        {
+            a = ancestor[k][a];
+            b = ancestor[k][b];
+        }
+    }
+    return ancestor[0][a];
+}
+
+double TreePathIndex::pathMinimum(int a, int b) const
+{
+    if (root[a] != root[b])
+        return 0.0;
+
+    // Поднимаем оба узла до общего предка, собирая минимум
+    double result = numeric_limits<double>::max();
+    if (depth[a] < depth[b])
+        swap(a, b);
+
+    int levels = static_cast<int>(ancestor.size());
+    for (int k = levels - 1; k >= 0; k--)
+    {
+        if (depth[a] - (1 << k) >= depth[b])
+        {
+            result = min(result, ancestorMin[k][a]);
+            a = ancestor[k][a];
+        }
+    }
+    if (a == b)
+        return result;
+
+    for (int k = levels - 1; k >= 0; k--)
+    {
+        if (ancestor[k][a] != ancestor[k][b])
+        {
+            result = min(result, min(ancestorMin[k][a], ancestorMin[k][b]));
+            a = ancestor[k][a];
+            b = ancestor[k][b];
+        }
+    }
+    return min(result, min(ancestorMin[0][a], ancestorMin[0][b]));
+}
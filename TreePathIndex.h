@@ -0,0 +1,34 @@
+#ifndef TREE_PATH_INDEX_H
+#define TREE_PATH_INDEX_H
+
+#include "MemoryTracker.h"
+#include <vector>
+
+// Запросы "минимальный вес ребра на пути между вершинами" для леса,
+// заданного массивом родителей. Двоичные подъемы: O(n log n) памяти,
+// O(log n) на запрос.
+class TreePathIndex
+{
+private:
+    IndexVector<int> depth;
+    IndexVector<int> root;
+    std::vector<IndexVector<int>> ancestor;     // предок на 2^k уровней выше
+    std::vector<IndexVector<double>> ancestorMin; // минимум ребер до него
+
+public:
+    // parent[v] = -1 для корней; weight[v] - вес ребра v - parent[v]
+    void build(const IndexVector<int> &parent, const IndexVector<double> &weight);
+
+    bool sameTree(int a, int b) const { return root[a] == root[b]; }
+    int getDepth(int v) const { return depth[v]; }
+    int getParent(int v) const { return depth[v] > 0 ? ancestor[0][v] : -1; }
+
+    // Общий предок или -1 для вершин разных деревьев
+    int lowestCommonAncestor(int a, int b) const;
+
+    // Минимальный вес на пути a - b; 0 для вершин разных деревьев,
+    // максимальное double для a == b
+    double pathMinimum(int a, int b) const;
+};
+
+#endif
@@ -0,0 +1,271 @@
+// Бенчмарк основных операций сети на синтетических сетях от 1 тыс. до 1 млн станций.
+// Отдельный исполняемый файл, цель benchmark в CMakeLists.txt корня:
+//   cmake -S . -B build && cmake --build build --target benchmark
+// Размеры - 1 тыс., 10 тыс., ... до --max-stations (по умолчанию 100 тыс., 1 млн - с
+// --max-stations 1000000). До 1 млн станций замеряются загрузка, сохранение, потоки,
+// обходы, чувствительность и поиск; гидравлика, переходный режим и надежность -
+// только до HEAVY_MAX_STATIONS (100 тыс.): на миллионе станций они считаются минутами.
+//
+//   benchmark [--max-stations N] [--topology tree|grid|scalefree|trunk|all] [--threads N] [--min-time S]
+//   benchmark generate <topology> <stations> <filename> [seed]
+
+#include "../GasNetwork.h"
+#include "../NetworkGenerator.h"
+#include "../FrontierBfs.h"
+#include "../TopologicalLayers.h"
+#include "../ReliabilityAnalyzer.h"
+#include "../SensitivityAnalyzer.h"
+#include "../TaskScheduler.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <cstdio>
+#include <sys/resource.h>
+
+using namespace std;
+
+namespace
+{
+    ostream report(cout.rdbuf());
+
+    // Глушит вывод операций (сообщения калькуляторов, загрузки) на время замера
+    class QuietOutput
+    {
+    private:
+        streambuf *saved;
+        stringbuf sink;
+
+    public:
+        QuietOutput() : saved(cout.rdbuf(&sink)) {}
+        ~QuietOutput() { cout.rdbuf(saved); }
+    };
+
+    double peakMemoryMb()
+    {
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+        return usage.ru_maxrss / (1024.0 * 1024.0); // байты
+#else
+        return usage.ru_maxrss / 1024.0; // килобайты
+#endif
+    }
+
+    double minTimeSeconds = 0.5;
+
+    // Наибольший размер сети для гидравлики, переходного режима и надежности
+    const int HEAVY_MAX_STATIONS = 100000;
+
+    // Повторяет операцию, пока не наберется minTimeSeconds (минимум один раз)
+    void measure(const string &name, const function<void()> &operation)
+    {
+        using clock = chrono::steady_clock;
+        size_t iterations = 0;
+        double elapsed = 0.0;
+        auto start = clock::now();
+        {
+            QuietOutput quiet;
+            do
+            {
+                operation();
+                iterations++;
+                elapsed = chrono::duration<double>(clock::now() - start).count();
+            } while (elapsed < minTimeSeconds);
+        }
+
+        report << "  " << left << setw(28) << name << right
+               << setw(14) << fixed << setprecision(2) << iterations / elapsed << " ops/s"
+               << setw(12) << setprecision(3) << elapsed * 1000.0 / iterations << " ms/op"
+               << setw(10) << setprecision(1) << peakMemoryMb() << " MB peak" << endl;
+    }
+
+    void runSuite(NetworkGenerator::Topology topology, int stations)
+    {
+        report << "\n" << NetworkGenerator::topologyName(topology) << ", " << stations << " stations" << endl;
+
+        GasNetwork network;
+        NetworkGenerator::Options options;
+        options.topology = topology;
+        options.stationCount = stations;
+
+        auto start = chrono::steady_clock::now();
+        {
+            QuietOutput quiet;
+            NetworkGenerator::generate(network, options);
+        }
+        double generateSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        shared_ptr<const NetworkSnapshot> pinned = network.snapshot();
+        const Graph &graph = pinned->getGraph();
+        const PipelineNetwork &objects = pinned->getPipelineNetwork();
+        report << "  generated " << graph.getEdgeCount() << " pipes in "
+               << fixed << setprecision(3) << generateSeconds << " s, "
+               << setprecision(1) << peakMemoryMb() << " MB peak" << endl;
+
+        MemoryReport memory = network.memoryReport();
+        const MemoryCategoryStats &pipeBytes = memory.categories[static_cast<size_t>(MemoryCategory::Pipes)];
+        const MemoryCategoryStats &stationBytes = memory.categories[static_cast<size_t>(MemoryCategory::Stations)];
+        const MemoryCategoryStats &edgeBytes = memory.categories[static_cast<size_t>(MemoryCategory::Adjacency)];
+        report << "  bytes per pipe " << (pipeBytes.liveBytes + memory.pipeNameBytes) / max<size_t>(1, memory.pipeCount)
+               << ", per station " << (stationBytes.liveBytes + memory.stationNameBytes) / max<size_t>(1, memory.stationCount)
+               << ", per edge " << edgeBytes.liveBytes / max<size_t>(1, memory.edgeCount)
+               << " (live, incl. snapshot)" << endl;
+
+        mt19937 rng(7);
+        uniform_int_distribution<int> station(1, stations);
+
+        measure("findShortestPath", [&]()
+                {
+            double distance = 0.0;
+            NetworkCalculator::findShortestPath(graph, objects, 1, station(rng), distance); });
+        measure("calculateMaxFlow", [&]()
+                { NetworkCalculator::calculateMaxFlow(graph, objects, 1, station(rng)); });
+        const FlatGraph &flat = NetworkCalculator::cachedFlatGraph(graph, objects);
+        FrontierBfs bfs;
+        FrontierBfs::Options sweep;
+        sweep.direction = FrontierBfs::Direction::Both;
+        measure("frontierBfs (full sweep)", [&]()
+                { bfs.run(flat, flat.nodeOf(1), sweep); });
+        sweep.parallel = true;
+        measure("frontierBfs (parallel)", [&]()
+                { bfs.run(flat, flat.nodeOf(1), sweep); });
+        measure("labelComponents", [&]()
+                { bfs.labelComponents(flat, true, true); });
+        measure("topologicalSort", [&]()
+                { graph.topologicalSort(); });
+        TopologicalLayers layers;
+        measure("topologicalLayers", [&]()
+                { layers.build(flat); });
+        const FlatGraph &stationGraph = NetworkCalculator::cachedStationGraph(graph, objects);
+        if (stations <= HEAVY_MAX_STATIONS)
+        {
+            // Разложение якобиана сетки из миллиона станций - минуты на замер
+            map<int, double> sourcePressure{{1, 70.0}};
+            measure("hydraulicSolve", [&]()
+                    { HydraulicSolver::solve(graph, objects, sourcePressure, {{station(rng), 1000.0}}); });
+
+            // Час работы сети с отключением компрессора станции-источника
+            TransientSimulator::Scenario scenario;
+            scenario.sourcePressure = sourcePressure;
+            scenario.demand[station(rng)] = 1000.0;
+            scenario.events.push_back({0.25, TransientSimulator::EventType::CompressorTrip, 1});
+            TransientSimulator::Settings settings;
+            settings.duration = 1.0;
+            measure("transientSimulate (1 h)", [&]()
+                    { TransientSimulator::simulate(graph, objects, scenario, settings); });
+
+            // Отказы труб методом Монте-Карло, источник -> случайная станция
+            ReliabilityAnalyzer::Settings reliability;
+            reliability.samples = 2000;
+            measure("reliabilitySimulate (2000)", [&]()
+                    { ReliabilityAnalyzer::simulate(stationGraph, objects, 1, station(rng), reliability); });
+        }
+        const FlatGraph &splitGraph = NetworkCalculator::cachedStationGraph(graph, objects, true);
+        measure("sensitivityAnalyze", [&]()
+                { SensitivityAnalyzer::analyze(splitGraph, objects, 1, station(rng)); });
+        measure("hasCycle", [&]()
+                { graph.hasCycle(); });
+        measure("findPipesByName", [&]()
+                { objects.findPipesByName("P-1"); });
+        measure("findPipesByDiameter", [&]()
+                { objects.findPipesByDiameter(1000); });
+        measure("findPipesByRepairStatus", [&]()
+                { objects.findPipesByRepairStatus(true); });
+        measure("findPipesByAvailability", [&]()
+                { objects.findPipesByAvailability(true); });
+
+        const string filename = "bench_tmp";
+        measure("save (_data + _network)", [&]()
+                { network.saveNetworkToFile(filename); });
+        measure("load (_data + _network)", [&]()
+                {
+            network.loadFromFile(filename + "_data.txt");
+            network.loadNetworkFromFile(filename); });
+
+        for (const auto &algorithm : MemoryTracker::getAlgorithmStats())
+        {
+            report << "  peak scratch " << algorithm.algorithm << ": " << algorithm.maxPeakBytes << " B" << endl;
+        }
+
+        remove((filename + "_data.txt").c_str());
+        remove((filename + "_network.txt").c_str());
+    }
+
+    int usage()
+    {
+        cerr << "Usage:\n"
+             << "  benchmark [--max-stations N] [--topology tree|grid|scalefree|trunk|all] [--threads N] [--min-time S]\n"
+             << "  benchmark generate <tree|grid|scalefree|trunk> <stations> <filename> [seed]\n"
+             << "  --max-stations: largest network, default 100000 (1000000 for the full 1M run);\n"
+             << "  hydraulic, transient and reliability suites run up to " << HEAVY_MAX_STATIONS << " stations" << endl;
+        return 1;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    vector<string> args(argv + 1, argv + argc);
+
+    if (!args.empty() && args[0] == "generate")
+    {
+        NetworkGenerator::Options options;
+        if (args.size() < 4 || !NetworkGenerator::parseTopology(args[1], options.topology))
+        {
+            return usage();
+        }
+        options.stationCount = stoi(args[2]);
+        if (args.size() > 4)
+        {
+            options.seed = stoull(args[4]);
+        }
+        NetworkGenerator::generateToFiles(args[3], options);
+        return 0;
+    }
+
+    int maxStations = 100000;
+    string topologyArg = "all";
+    for (size_t i = 0; i + 1 < args.size(); i += 2)
+    {
+        if (args[i] == "--max-stations")
+            maxStations = stoi(args[i + 1]);
+        else if (args[i] == "--topology")
+            topologyArg = args[i + 1];
+        else if (args[i] == "--threads")
+            TaskScheduler::instance().setWorkerCount(stoi(args[i + 1]));
+        else if (args[i] == "--min-time")
+            minTimeSeconds = stod(args[i + 1]);
+        else
+            return usage();
+    }
+
+    vector<NetworkGenerator::Topology> topologies;
+    if (topologyArg == "all")
+    {
+        topologies = {NetworkGenerator::Topology::Tree,
+                      NetworkGenerator::Topology::MeshedGrid,
+                      NetworkGenerator::Topology::ScaleFree,
+                      NetworkGenerator::Topology::TrunkWithLaterals};
+    }
+    else
+    {
+        NetworkGenerator::Topology topology;
+        if (!NetworkGenerator::parseTopology(topologyArg, topology))
+        {
+            return usage();
+        }
+        topologies = {topology};
+    }
+
+    report << "Gas network benchmark, worker threads: " << TaskScheduler::instance().getWorkerCount() << endl;
+    for (auto topology : topologies)
+    {
+        for (int stations = 1000; stations <= maxStations; stations *= 10)
+        {
+            runSuite(topology, stations);
+        }
+    }
+    return 0;
+}
@@ -1,7 +1,9 @@
 #include "GasNetwork.h"
 #include "utils.h"
+#include "TaskScheduler.h"
 #include <iostream>
 #include <vector>
+#include <map>
 
 using namespace std;
 
@@ -27,6 +29,7 @@ void displayMainMenu()
     cout << "17. Save Data" << endl;
     cout << "18. Load Data" << endl;
     cout << "19. Network Status" << endl;
+    cout << "20. Advanced Analysis" << endl;
     cout << "0. Exit" << endl;
     cout << "--------------------------------" << endl;
     cout << "Choice: ";
@@ -43,12 +46,14 @@ void searchPipesMenu(GasNetwork &network)
     cout << "Choice: ";
 
     int choice = getIntegerInput("");
+    // Результаты поиска и объекты - из одной версии сети
+    shared_ptr<const PipelineNetwork> objects = network.getPipelineNetwork();
     switch (choice)
     {
     case 1:
     {
         string name = getStringInput("Enter pipe name to search: ");
-        vector<int> results = network.getPipelineNetwork().findPipesByName(name);
+        vector<int> results = objects->findPipesByName(name);
         if (results.empty())
         {
             cout << "No pipes found with name: " << name << endl;
@@ -58,7 +63,7 @@ void searchPipesMenu(GasNetwork &network)
             cout << "Found " << results.size() << " pipes:" << endl;
             for (int id : results)
             {
-                const Pipe *pipe = network.getPipelineNetwork().getPipeById(id);
+                const Pipe *pipe = objects->getPipeById(id);
                 if (pipe)
                 {
                     cout << "Pipe ID: " << id << ", Name: " << pipe->getName()
@@ -72,7 +77,7 @@ void searchPipesMenu(GasNetwork &network)
     {
         cout << "Search pipes: 1 - In repair, 0 - Not in repair: ";
         bool status = getIntegerInput("") == 1;
-        vector<int> results = network.getPipelineNetwork().findPipesByRepairStatus(status);
+        vector<int> results = objects->findPipesByRepairStatus(status);
         if (results.empty())
         {
             cout << "No pipes found with specified repair status." << endl;
@@ -82,7 +87,7 @@ void searchPipesMenu(GasNetwork &network)
             cout << "Found " << results.size() << " pipes:" << endl;
             for (int id : results)
             {
-                const Pipe *pipe = network.getPipelineNetwork().getPipeById(id);
+                const Pipe *pipe = objects->getPipeById(id);
                 if (pipe)
                 {
                     cout << "Pipe ID: " << id << ", Status: "
@@ -96,7 +101,7 @@ void searchPipesMenu(GasNetwork &network)
     {
         cout << "Enter diameter to search (500, 700, 1000, 1400): ";
         int diameter = getIntegerInput("");
-        vector<int> results = network.getPipelineNetwork().findPipesByDiameter(diameter);
+        vector<int> results = objects->findPipesByDiameter(diameter);
         if (results.empty())
         {
             cout << "No pipes found with diameter: " << diameter << " mm" << endl;
@@ -106,7 +111,7 @@ void searchPipesMenu(GasNetwork &network)
             cout << "Found " << results.size() << " pipes:" << endl;
             for (int id : results)
             {
-                const Pipe *pipe = network.getPipelineNetwork().getPipeById(id);
+                const Pipe *pipe = objects->getPipeById(id);
                 if (pipe)
                 {
                     cout << "Pipe ID: " << id << ", Name: " << pipe->getName()
@@ -120,7 +125,7 @@ void searchPipesMenu(GasNetwork &network)
     {
         cout << "Search pipes: 1 - Available, 0 - Not available: ";
         bool available = getIntegerInput("") == 1;
-        vector<int> results = network.getPipelineNetwork().findPipesByAvailability(available);
+        vector<int> results = objects->findPipesByAvailability(available);
         if (results.empty())
         {
             cout << "No pipes found with specified availability." << endl;
@@ -130,7 +135,7 @@ void searchPipesMenu(GasNetwork &network)
             cout << "Found " << results.size() << " pipes:" << endl;
             for (int id : results)
             {
-                const Pipe *pipe = network.getPipelineNetwork().getPipeById(id);
+                const Pipe *pipe = objects->getPipeById(id);
                 if (pipe)
                 {
                     cout << "Pipe ID: " << id << ", Available: "
@@ -156,12 +161,14 @@ void searchStationsMenu(GasNetwork &network)
     cout << "Choice: ";
 
     int choice = getIntegerInput("");
+    // Результаты поиска и объекты - из одной версии сети
+    shared_ptr<const PipelineNetwork> objects = network.getPipelineNetwork();
     switch (choice)
     {
     case 1:
     {
         string name = getStringInput("Enter station name to search: ");
-        vector<int> results = network.getPipelineNetwork().findStationsByName(name);
+        vector<int> results = objects->findStationsByName(name);
         if (results.empty())
         {
             cout << "No stations found with name: " << name << endl;
@@ -171,7 +178,7 @@ void searchStationsMenu(GasNetwork &network)
             cout << "Found " << results.size() << " stations:" << endl;
             for (int id : results)
             {
-                const CompressorStation *station = network.getPipelineNetwork().getStationById(id);
+                const CompressorStation *station = objects->getStationById(id);
                 if (station)
                 {
                     cout << "Station ID: " << id << ", Name: " << station->getName()
@@ -184,7 +191,7 @@ void searchStationsMenu(GasNetwork &network)
     case 2:
     {
         double percentage = getDoubleInput("Enter minimum unused percentage: ");
-        vector<int> results = network.getPipelineNetwork().findStationsByUnusedPercentage(percentage);
+        vector<int> results = objects->findStationsByUnusedPercentage(percentage);
         if (results.empty())
         {
             cout << "No stations found with unused percentage >= " << percentage << "%" << endl;
@@ -194,7 +201,7 @@ void searchStationsMenu(GasNetwork &network)
             cout << "Found " << results.size() << " stations:" << endl;
             for (int id : results)
             {
-                const CompressorStation *station = network.getPipelineNetwork().getStationById(id);
+                const CompressorStation *station = objects->getStationById(id);
                 if (station)
                 {
                     cout << "Station ID: " << id << ", Name: " << station->getName()
@@ -219,7 +226,7 @@ void connectStationsMenu(GasNetwork &network)
 
     // Показываем все станции
     cout << "\n--- ALL STATIONS ---" << endl;
-    network.getPipelineNetwork().displayStations();
+    network.getPipelineNetwork()->displayStations();
 
     // Запрашиваем ID станций
     int fromStation = getIntegerInput("\nEnter SOURCE station ID: ");
@@ -245,7 +252,7 @@ void connectStationsMenu(GasNetwork &network)
     }
 
     // Проверяем, нет ли уже соединения
-    if (network.getGraph().getPipeId(fromStation, toStation) != -1)
+    if (network.getGraph()->getPipeId(fromStation, toStation) != -1)
     {
         cout << "❌ Error: Connection already exists between these stations!" << endl;
         return;
@@ -283,7 +290,7 @@ void connectStationsMenu(GasNetwork &network)
 
     // Показываем доступные трубы этого диаметра
     cout << "\n--- AVAILABLE PIPES (" << diameter << " mm) ---" << endl;
-    auto availablePipes = network.getPipelineNetwork().getAvailablePipesByDiameter(diameter);
+    auto availablePipes = network.getPipelineNetwork()->getAvailablePipesByDiameter(diameter);
 
     if (availablePipes.empty())
     {
@@ -401,9 +408,10 @@ void disconnectStationsMenu(GasNetwork &network)
     cout << "════════════════════════════════════════" << endl;
 
     // Показываем текущие соединения
-    network.getGraph().display();
+    shared_ptr<const Graph> graph = network.getGraph();
+    graph->display();
 
-    if (network.getGraph().isEmpty())
+    if (graph->isEmpty())
     {
         cout << "No connections to disconnect." << endl;
         return;
@@ -424,7 +432,7 @@ void shortestPathMenu(GasNetwork &network)
     cout << "════════════════════════════════════════" << endl;
 
     // Показываем доступные станции
-    network.getPipelineNetwork().displayStationIds();
+    network.getPipelineNetwork()->displayStationIds();
 
     int sourceStation = getIntegerInput("\nВведите ID станции-источника: ");
     int targetStation = getIntegerInput("Введите ID станции-цели: ");
@@ -439,7 +447,7 @@ void maxFlowMenu(GasNetwork &network)
     cout << "════════════════════════════════════════" << endl;
 
     // Показываем доступные станции
-    network.getPipelineNetwork().displayStationIds();
+    network.getPipelineNetwork()->displayStationIds();
 
     int sourceStation = getIntegerInput("\nВведите ID станции-источника: ");
     int targetStation = getIntegerInput("Введите ID станции-цели: ");
@@ -447,6 +455,296 @@ void maxFlowMenu(GasNetwork &network)
     network.calculateMaxFlow(sourceStation, targetStation);
 }
 
+void analysisMenu(GasNetwork &network)
+{
+    cout << "\n=== ADVANCED ANALYSIS ===" << endl;
+    cout << "1. Max flow matrix (all station pairs)" << endl;
+    cout << "2. Set number of worker threads" << endl;
+    cout << "3. Memory report" << endl;
+    cout << "4. N-1 / N-2 contingency analysis" << endl;
+    cout << "5. Supply / demand feasibility (multiple sources and consumers)" << endl;
+    cout << "6. Min-cost flow (deliver volume at minimum transport cost)" << endl;
+    cout << "7. Pairwise max flow queries (flow-equivalent tree)" << endl;
+    cout << "8. Widest path (route with maximum bottleneck capacity)" << endl;
+    cout << "9. Pairwise bottleneck queries (maximum spanning forest)" << endl;
+    cout << "10. Independent (disjoint) routes between stations" << endl;
+    cout << "11. Redundancy audit from a source station" << endl;
+    cout << "12. Ranked alternative routes (k shortest paths)" << endl;
+    cout << "13. Critical (longest) transport chain (acyclic networks)" << endl;
+    cout << "14. Reachable stations from a station" << endl;
+    cout << "15. Critical elements (bridge pipes, articulation stations)" << endl;
+    cout << "16. Mandatory stations and failure impact (dominator tree)" << endl;
+    cout << "17. Is station B downstream of station A?" << endl;
+    cout << "18. Topological levels (stages)" << endl;
+    cout << "19. Steady-state pressures (hydraulic solver)" << endl;
+    cout << "20. Transient simulation (compressor trips, pipe repairs)" << endl;
+    cout << "21. Monte Carlo reliability (deliverable flow distribution)" << endl;
+    cout << "22. Max-flow sensitivity (pipe upgrade value)" << endl;
+    cout << "0. Back to main menu" << endl;
+    cout << "Choice: ";
+
+    int choice = getIntegerInput("");
+    switch (choice)
+    {
+    case 1:
+        network.calculateMaxFlowMatrix();
+        break;
+    case 2:
+    {
+        cout << "Рабочих потоков сейчас: " << TaskScheduler::instance().getWorkerCount() << endl;
+        size_t maxWorkers = TaskScheduler::maxWorkerCount();
+        int workers = getIntegerInput("Число рабочих потоков (0 - в одном потоке, не больше " + to_string(maxWorkers) + "): ");
+        if (workers < 0)
+        {
+            cout << "❌ Число рабочих потоков не может быть отрицательным!" << endl;
+            break;
+        }
+        if (static_cast<size_t>(workers) > maxWorkers)
+        {
+            cout << "⚠️  Ограничено до " << maxWorkers << " потоков (" << TaskScheduler::MAX_WORKERS_PER_CORE << " на ядро)" << endl;
+        }
+        TaskScheduler::instance().setWorkerCount(workers);
+        cout << "✅ Рабочих потоков: " << TaskScheduler::instance().getWorkerCount() << endl;
+        break;
+    }
+    case 3:
+        network.displayMemoryReport();
+        break;
+    case 4:
+    {
+        network.getPipelineNetwork()->displayStationIds();
+        int sourceStation = getIntegerInput("\nВведите ID станции-источника: ");
+        int targetStation = getIntegerInput("Введите ID станции-цели: ");
+        int depth = getIntegerInput("Глубина анализа (1 - N-1, 2 - N-2): ");
+        network.analyzeContingencies(sourceStation, targetStation, depth);
+        break;
+    }
+    case 5:
+    {
+        network.getPipelineNetwork()->displayStationIds();
+        map<int, double> supply;
+        map<int, double> demand;
+        int sources = getIntegerInput("\nЧисло станций-поставщиков: ");
+        for (int i = 0; i < sources; i++)
+        {
+            int id = getIntegerInput("ID станции-поставщика: ");
+            supply[id] += getDoubleInput("Поставка (м³/час): ");
+        }
+        int consumers = getIntegerInput("Число станций-потребителей: ");
+        for (int i = 0; i < consumers; i++)
+        {
+            int id = getIntegerInput("ID станции-потребителя: ");
+            demand[id] += getDoubleInput("Потребление (м³/час): ");
+        }
+        network.calculateSupplyDemand(supply, demand);
+        break;
+    }
+    case 6:
+    {
+        network.getPipelineNetwork()->displayStationIds();
+        int sourceStation = getIntegerInput("\nВведите ID станции-источника: ");
+        int targetStation = getIntegerInput("Введите ID станции-цели: ");
+        double volume = getDoubleInput("Объем доставки (м³/час): ");
+        network.calculateMinCostFlow(sourceStation, targetStation, volume);
+        break;
+    }
+    case 7:
+    {
+        network.getPipelineNetwork()->displayStationIds();
+        vector<pair<int, int>> pairs;
+        int count = getIntegerInput("\nЧисло пар станций: ");
+        for (int i = 0; i < count; i++)
+        {
+            int first = getIntegerInput("ID первой станции: ");
+            int second = getIntegerInput("ID второй станции: ");
+            pairs.push_back({first, second});
+        }
+        network.queryPairwiseMaxFlow(pairs);
+        break;
+    }
+    case 8:
+    {
+        network.getPipelineNetwork()->displayStationIds();
+        int sourceStation = getIntegerInput("\nВведите ID станции-источника: ");
+        int targetStation = getIntegerInput("Введите ID станции-цели: ");
+        network.calculateWidestPath(sourceStation, targetStation);
+        break;
+    }
+    case 9:
+    {
+        network.getPipelineNetwork()->displayStationIds();
+        vector<pair<int, int>> pairs;
+        int count = getIntegerInput("\nЧисло пар станций: ");
+        for (int i = 0; i < count; i++)
+        {
+            int first = getIntegerInput("ID первой станции: ");
+            int second = getIntegerInput("ID второй станции: ");
+            pairs.push_back({first, second});
+        }
+        network.queryPairwiseBottlenecks(pairs);
+        break;
+    }
+    case 10:
+    {
+        network.getPipelineNetwork()->displayStationIds();
+        int sourceStation = getIntegerInput("\nВведите ID станции-источника: ");
+        int targetStation = getIntegerInput("Введите ID станции-цели: ");
+        int k = getIntegerInput("Число маршрутов: ");
+        bool stationDisjoint = getIntegerInput("Без общих станций? (1 - да, 0 - только без общих труб): ") == 1;
+        network.calculateDisjointPaths(sourceStation, targetStation, k, stationDisjoint);
+        break;
+    }
+    case 11:
+    {
+        network.getPipelineNetwork()->displayStationIds();
+        int sourceStation = getIntegerInput("\nВведите ID станции-источника: ");
+        bool stationDisjoint = getIntegerInput("Без общих станций? (1 - да, 0 - только без общих труб): ") == 1;
+        network.auditRedundancy(sourceStation, stationDisjoint);
+        break;
+    }
+    case 12:
+    {
+        network.getPipelineNetwork()->displayStationIds();
+        int sourceStation = getIntegerInput("\nВведите ID станции-источника: ");
+        int targetStation = getIntegerInput("Введите ID станции-цели: ");
+        int k = getIntegerInput("Число маршрутов: ");
+        network.calculateAlternativeRoutes(sourceStation, targetStation, k);
+        break;
+    }
+    case 13:
+    {
+        network.getPipelineNetwork()->displayStationIds();
+        int sourceStation = getIntegerInput("\nВведите ID станции-источника: ");
+        int targetStation = getIntegerInput("Введите ID станции-цели: ");
+        network.calculateLongestPath(sourceStation, targetStation);
+        break;
+    }
+    case 14:
+    {
+        network.getPipelineNetwork()->displayStationIds();
+        int sourceStation = getIntegerInput("\nВведите ID станции: ");
+        network.displayReachableStations(sourceStation);
+        break;
+    }
+    case 15:
+        network.displayCriticalElements();
+        break;
+    case 16:
+    {
+        network.getPipelineNetwork()->displayStationIds();
+        int sourceStation = getIntegerInput("\nВведите ID станции-источника: ");
+        int station = getIntegerInput("Введите ID анализируемой станции: ");
+        network.analyzeDominators(sourceStation, station);
+        break;
+    }
+    case 17:
+    {
+        network.getPipelineNetwork()->displayStationIds();
+        int upstream = getIntegerInput("\nВведите ID станции A: ");
+        int downstream = getIntegerInput("Введите ID станции B: ");
+        network.checkDownstream(upstream, downstream);
+        break;
+    }
+    case 18:
+        network.displayTopologicalLevels();
+        break;
+    case 19:
+    {
+        network.getPipelineNetwork()->displayStationIds();
+        int equation = getIntegerInput("\nУравнение трубы (1 - Веймаут, 2 - Панхендл A): ");
+        map<int, double> sourcePressure;
+        map<int, double> demand;
+        int sources = getIntegerInput("Число станций с заданным давлением: ");
+        for (int i = 0; i < sources; i++)
+        {
+            int id = getIntegerInput("ID станции: ");
+            sourcePressure[id] = getDoubleInput("Давление (бар): ");
+        }
+        int consumers = getIntegerInput("Число станций-потребителей: ");
+        for (int i = 0; i < consumers; i++)
+        {
+            int id = getIntegerInput("ID станции-потребителя: ");
+            demand[id] += getDoubleInput("Потребление (м³/час): ");
+        }
+        network.calculateHydraulics(sourcePressure, demand,
+                                    equation == 2 ? HydraulicSolver::Equation::PanhandleA
+                                                  : HydraulicSolver::Equation::Weymouth);
+        break;
+    }
+    case 20:
+    {
+        network.getPipelineNetwork()->displayStationIds();
+        TransientSimulator::Scenario scenario;
+        int sources = getIntegerInput("\nЧисло станций с заданным давлением: ");
+        for (int i = 0; i < sources; i++)
+        {
+            int id = getIntegerInput("ID станции: ");
+            scenario.sourcePressure[id] = getDoubleInput("Давление (бар): ");
+        }
+        int consumers = getIntegerInput("Число станций-потребителей: ");
+        for (int i = 0; i < consumers; i++)
+        {
+            int id = getIntegerInput("ID станции-потребителя: ");
+            scenario.demand[id] += getDoubleInput("Потребление (м³/час): ");
+        }
+        double duration = getDoubleInput("Длительность (часов): ");
+        double interval = getDoubleInput("Интервал вывода (часов): ");
+        int events = getIntegerInput("Число событий: ");
+        for (int i = 0; i < events; i++)
+        {
+            int type = getIntegerInput("Событие (1 - останов компрессора, 2 - пуск компрессора, 3 - ремонт трубы, "
+                                       "4 - возврат трубы, 5 - изменение потребления): ");
+            if (type < 1 || type > 5)
+            {
+                cout << "❌ Неверный тип события, пропущено" << endl;
+                continue;
+            }
+            TransientSimulator::Event event;
+            event.type = static_cast<TransientSimulator::EventType>(type - 1);
+            event.id = getIntegerInput(type == 3 || type == 4 ? "ID трубы: " : "ID станции: ");
+            event.time = getDoubleInput("Время (часов от начала): ");
+            if (type == 5)
+                event.value = getDoubleInput("Новое потребление (м³/час): ");
+            scenario.events.push_back(event);
+        }
+        int monitored = getIntegerInput("Число станций для наблюдения: ");
+        for (int i = 0; i < monitored; i++)
+        {
+            scenario.monitoredStations.push_back(getIntegerInput("ID станции: "));
+        }
+        network.simulateTransient(scenario, duration, interval);
+        break;
+    }
+    case 21:
+    {
+        network.getPipelineNetwork()->displayStationIds();
+        int sourceStation = getIntegerInput("\nВведите ID станции-источника: ");
+        int targetStation = getIntegerInput("Введите ID станции-цели: ");
+        long long samples = getLongInput("Число сценариев: ");
+        while (samples <= 0)
+        {
+            samples = getLongInput("❌ Число сценариев должно быть положительным. Повторите ввод: ");
+        }
+        double demand = getDoubleInput("Требуемая поставка (м³/час, 0 - базовый поток): ");
+        network.simulateReliability(sourceStation, targetStation, samples, demand);
+        break;
+    }
+    case 22:
+    {
+        network.getPipelineNetwork()->displayStationIds();
+        int sourceStation = getIntegerInput("\nВведите ID станции-источника: ");
+        int targetStation = getIntegerInput("Введите ID станции-цели: ");
+        string filename = getStringInput("CSV-файл для экспорта (пусто - без экспорта): ");
+        network.analyzeSensitivity(sourceStation, targetStation, filename);
+        break;
+    }
+    case 0:
+        return;
+    default:
+        cout << "Invalid choice!" << endl;
+    }
+}
+
 int main()
 {
     GasNetwork network;
@@ -475,28 +773,28 @@ int main()
             break;
         case 4:
         {
-            network.getPipelineNetwork().displayPipeIds();
+            network.getPipelineNetwork()->displayPipeIds();
             int id = getIntegerInput("Enter pipe ID to edit: ");
             network.editPipe(id);
             break;
         }
         case 5:
         {
-            network.getPipelineNetwork().displayStationIds();
+            network.getPipelineNetwork()->displayStationIds();
             int id = getIntegerInput("Enter station ID to edit: ");
             network.editStation(id);
             break;
         }
         case 6:
         {
-            network.getPipelineNetwork().displayPipeIds();
+            network.getPipelineNetwork()->displayPipeIds();
             int id = getIntegerInput("Enter pipe ID to delete: ");
             network.deletePipe(id);
             break;
         }
         case 7:
         {
-            network.getPipelineNetwork().displayStationIds();
+            network.getPipelineNetwork()->displayStationIds();
             int id = getIntegerInput("Enter station ID to delete: ");
             network.deleteStation(id);
             break;
@@ -510,10 +808,10 @@ int main()
         case 10:
         {
             string name = getStringInput("Enter pipe name to search for batch edit: ");
-            vector<int> results = network.getPipelineNetwork().findPipesByName(name);
+            vector<int> results = network.getPipelineNetwork()->findPipesByName(name);
             if (!results.empty())
             {
-                network.getPipelineNetwork().batchEditPipes(results);
+                network.batchEditPipes(results);
             }
             else
             {
@@ -556,6 +854,9 @@ int main()
         case 19:
             network.displayNetworkStatus();
             break;
+        case 20:
+            analysisMenu(network);
+            break;
         case 0:
             cout << "\n════════════════════════════════════════" << endl;
             cout << "   Thank you for using the system!" << endl;
@@ -0,0 +1,118 @@
+#include "TestSupport.h"
+#include <set>
+
+using namespace std;
+
+namespace
+{
+    // Разбиение станций на компоненты без трубы skipPipe и станции skipStation
+    class Components
+    {
+    private:
+        map<int, int> parent;
+
+    public:
+        Components(const vector<int> &stations, const vector<pair<int, int>> &pipes, int skipPipe, int skipStation)
+        {
+            for (int station : stations)
+                if (station != skipStation)
+                    parent[station] = station;
+            for (size_t i = 0; i < pipes.size(); i++)
+                if (static_cast<int>(i) != skipPipe && pipes[i].first != skipStation && pipes[i].second != skipStation)
+                    parent[find(pipes[i].first)] = find(pipes[i].second);
+        }
+
+        int find(int station)
+        {
+            int &up = parent[station];
+            return up == station ? station : up = find(up);
+        }
+
+        int count()
+        {
+            int components = 0;
+            for (const auto &entry : parent)
+                components += find(entry.first) == entry.first;
+            return components;
+        }
+    };
+
+    // Мосты и точки сочленения против перебора с удалением каждого элемента
+    void checkAgainstBruteForce(test::Checker &checker)
+    {
+        for (NetworkGenerator::Topology topology : test::TOPOLOGIES)
+        {
+            for (int size : {5, 20, 60})
+            {
+                for (int seed = 0; seed < 3; seed++)
+                {
+                    GasNetwork network;
+                    test::generate(network, topology, size, seed * 19 + size + static_cast<int>(topology));
+                    const Graph &graph = network.snapshot()->getGraph();
+                    string where = NetworkGenerator::topologyName(topology) + " " + to_string(size);
+
+                    auto connections = graph.getConnectionsWithPipe();
+                    vector<pair<int, int>> pipes;
+                    for (const auto &conn : connections)
+                        pipes.push_back({conn.first, conn.second.first});
+                    vector<int> stations = graph.getVertices();
+                    int base = Components(stations, pipes, -1, -1).count();
+
+                    ConnectivityAnalyzer::Report report = ConnectivityAnalyzer::compute(graph);
+                    set<int> bridges, articulations(report.articulationStations.begin(), report.articulationStations.end());
+                    for (const ConnectivityAnalyzer::Bridge &bridge : report.bridges)
+                        bridges.insert(bridge.pipeId);
+
+                    // Станции без труб компонентами не считаются
+                    set<int> connected;
+                    for (const auto &pipe : pipes)
+                        connected.insert({pipe.first, pipe.second});
+                    checker.check(static_cast<int>(report.components) == base - static_cast<int>(stations.size() - connected.size()),
+                                  "components " + where);
+                    for (size_t i = 0; i < pipes.size(); i++)
+                    {
+                        // Мост: без него станции трубы оказываются в разных компонентах
+                        Components removed(stations, pipes, static_cast<int>(i), -1);
+                        bool bridge = removed.find(pipes[i].first) != removed.find(pipes[i].second);
+                        checker.check(bridge == (bridges.count(connections[i].second.second) > 0),
+                                      "bridge " + to_string(connections[i].second.second) + " " + where);
+                    }
+                    for (int station : stations)
+                    {
+                        bool articulation = Components(stations, pipes, -1, station).count() > base;
+                        checker.check(articulation == (articulations.count(station) > 0),
+                                      "articulation " + to_string(station) + " " + where);
+                    }
+
+                    // Кэш анализатора совпадает с прямым расчетом
+                    ConnectivityAnalyzer analyzer;
+                    checker.check(analyzer.analyze(graph).components == report.components, "cached " + where);
+                }
+            }
+        }
+    }
+
+    // Станции без труб не образуют отдельных компонент
+    void checkIsolatedStations(test::Checker &checker)
+    {
+        Graph graph;
+        for (int station = 1; station <= 6; station++)
+            graph.addVertex(station);
+        graph.addConnection(1, 2, 1, 500);
+        graph.addConnection(2, 3, 2, 500);
+        graph.addConnection(4, 5, 3, 500);
+
+        ConnectivityAnalyzer::Report report = ConnectivityAnalyzer::compute(graph);
+        checker.check(report.components == 2, "isolated station counted: " + to_string(report.components));
+        checker.check(report.bridges.size() == 3, "bridges with isolated station");
+        checker.check(report.articulationStations == vector<int>{2}, "articulation with isolated station");
+    }
+}
+
+int main()
+{
+    test::Checker checker("Connectivity");
+    checkAgainstBruteForce(checker);
+    checkIsolatedStations(checker);
+    return checker.finish();
+}
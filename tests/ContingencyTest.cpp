@@ -0,0 +1,67 @@
+#include "TestSupport.h"
+#include "ContingencyAnalyzer.h"
+#include "TaskScheduler.h"
+#include <random>
+
+using namespace std;
+
+// Остаточный поток каждого отказа N-1/N-2 совпадает с полным расчетом без отключенных
+// труб; базовый поток учитывает ограничения станций, как calculateMaxFlow
+int main()
+{
+    test::Checker checker("Contingency");
+
+    for (size_t workers : {0, 3})
+    {
+        TaskScheduler::instance().setWorkerCount(workers);
+        for (NetworkGenerator::Topology topology : test::TOPOLOGIES)
+        {
+            for (int size : {12, 40, 120})
+            {
+                GasNetwork network;
+                test::generate(network, topology, size, size * 7 + static_cast<int>(topology));
+                shared_ptr<const NetworkSnapshot> snapshot = network.snapshot();
+                const Graph &graph = snapshot->getGraph();
+                const PipelineNetwork &objects = snapshot->getPipelineNetwork();
+                const FlatGraph &flat = NetworkCalculator::cachedStationGraph(graph, objects);
+                string where = NetworkGenerator::topologyName(topology) + " " + to_string(size) +
+                               " workers " + to_string(workers);
+
+                mt19937 rng(3);
+                for (int query = 0; query < 4; query++)
+                {
+                    int source, target;
+                    test::downstreamPair(rng, size, source, target);
+                    for (int depth = 1; depth <= (size <= 40 ? 2 : 1); depth++)
+                    {
+                        ContingencyAnalyzer::Report report = ContingencyAnalyzer::analyze(flat, source, target, depth);
+                        string what = where + " N-" + to_string(depth);
+                        checker.near(report.baseFlow, test::referenceMaxFlow(graph, objects, source, target), "base flow " + what);
+                        checker.near(report.baseFlow, NetworkCalculator::calculateMaxFlow(graph, objects, source, target),
+                                     "base flow vs calculateMaxFlow " + what);
+
+                        for (const auto &outage : report.ranking)
+                        {
+                            map<int, double> removed;
+                            for (size_t i = 0; i < outage.pipeIds.size(); i++)
+                            {
+                                removed[outage.pipeIds[i]] = 0.0;
+                                checker.check(graph.getPipeId(outage.fromStations[i], outage.toStations[i]) == outage.pipeIds[i],
+                                              "outage pipe ends " + what);
+                            }
+                            double expected = test::referenceMaxFlow(graph, objects, source, target, removed);
+                            checker.near(outage.remainingFlow, expected, "remaining flow " + what);
+                            checker.near(outage.lostFlow, report.baseFlow - expected, "lost flow " + what, 1e-6);
+                        }
+
+                        // Пропущенные сценарии - только трубы без потока: поток не меняется
+                        size_t pipes = graph.getEdgeCount();
+                        size_t total = depth == 1 ? pipes : pipes * (pipes - 1) / 2;
+                        checker.check(report.evaluatedScenarios + report.skippedScenarios == total, "scenario count " + what);
+                    }
+                }
+            }
+        }
+    }
+    return checker.finish();
+}
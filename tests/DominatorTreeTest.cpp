@@ -0,0 +1,92 @@
+#include "TestSupport.h"
+#include <set>
+
+using namespace std;
+
+namespace
+{
+    // Станции, достижимые из source по исправным трубам без узла skip
+    set<int> reachableWithout(const FlatGraph &graph, int source, int skip)
+    {
+        set<int> stations;
+        if (source == skip)
+            return stations;
+        vector<int> queue{source};
+        vector<char> visited(graph.getNodeCount(), 0);
+        visited[source] = 1;
+        for (size_t head = 0; head < queue.size(); head++)
+        {
+            int node = queue[head];
+            stations.insert(graph.stationAt(node));
+            for (int a = graph.arcBegin(node); a < graph.arcEnd(node); a++)
+            {
+                const FlatGraph::Arc &arc = graph.arc(a);
+                if (arc.forward && arc.length < 1e300 && !visited[arc.head] && arc.head != skip)
+                {
+                    visited[arc.head] = 1;
+                    queue.push_back(arc.head);
+                }
+            }
+        }
+        return stations;
+    }
+}
+
+// Дерево доминаторов против перебора: станции, отрезанные отказом Y, -
+// это достижимые станции, до которых без Y уже не добраться
+int main()
+{
+    test::Checker checker("DominatorTree");
+    for (NetworkGenerator::Topology topology : test::TOPOLOGIES)
+    {
+        for (int size : {6, 25, 80})
+        {
+            for (int seed = 0; seed < 3; seed++)
+            {
+                GasNetwork network;
+                test::generate(network, topology, size, seed * 41 + size + static_cast<int>(topology), 0.1);
+                shared_ptr<const NetworkSnapshot> snapshot = network.snapshot();
+                const Graph &graph = snapshot->getGraph();
+                const PipelineNetwork &objects = snapshot->getPipelineNetwork();
+                const FlatGraph &flat = NetworkCalculator::cachedFlatGraph(graph, objects);
+                string where = NetworkGenerator::topologyName(topology) + " " + to_string(size);
+
+                for (int source = 1; source <= size; source += max(1, size / 6))
+                {
+                    DominatorTree tree;
+                    tree.build(graph, objects, source);
+                    checker.check(tree.isBuiltFrom(graph, objects, source) && tree.getSourceStation() == source,
+                                  "built from " + where);
+                    set<int> reachable = reachableWithout(flat, flat.nodeOf(source), -1);
+
+                    for (int station = 1; station <= size; station++)
+                    {
+                        if (station == source)
+                            continue;
+                        string what = where + " " + to_string(source) + "/" + to_string(station);
+                        set<int> after = reachableWithout(flat, flat.nodeOf(source), flat.nodeOf(station));
+                        vector<int> expected;
+                        if (reachable.count(station))
+                        {
+                            for (int other : reachable)
+                                if (other != station && !after.count(other))
+                                    expected.push_back(other);
+                        }
+                        checker.check(tree.cutOffBy(station) == expected, "cut off " + what);
+                        checker.check(tree.isReachable(station) == (reachable.count(station) > 0), "reachable " + what);
+
+                        // Доминатор - станция, без которой station недостижима
+                        for (int dominator : tree.dominatorsOf(station))
+                        {
+                            checker.check(tree.dominates(dominator, station), "dominates " + what);
+                            if (dominator != source && dominator != station)
+                                checker.check(!reachableWithout(flat, flat.nodeOf(source), flat.nodeOf(dominator)).count(station),
+                                              "dominator " + to_string(dominator) + " " + what);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return checker.finish();
+}
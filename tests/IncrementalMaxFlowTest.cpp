@@ -0,0 +1,73 @@
+#include "TestSupport.h"
+#include "IncrementalMaxFlow.h"
+#include <random>
+
+using namespace std;
+
+// Поток после инкрементальных изменений труб и станций совпадает с полным пересчетом
+int main()
+{
+    test::Checker checker("IncrementalMaxFlow");
+    const int diameters[] = {500, 700, 1000, 1400};
+
+    for (NetworkGenerator::Topology topology : test::TOPOLOGIES)
+    {
+        for (int size : {12, 60, 200})
+        {
+            GasNetwork network;
+            test::generate(network, topology, size, size * 5 + static_cast<int>(topology), 0.1);
+            Graph graph = network.snapshot()->getGraph();
+            PipelineNetwork objects = network.snapshot()->getPipelineNetwork();
+            string where = NetworkGenerator::topologyName(topology) + " " + to_string(size);
+
+            vector<int> pipeIds;
+            for (const auto &conn : graph.getConnectionsWithPipe())
+                pipeIds.push_back(conn.second.second);
+
+            mt19937 rng(9);
+            for (int query = 0; query < 3; query++)
+            {
+                int source, target;
+                test::downstreamPair(rng, size, source, target);
+
+                IncrementalMaxFlow incremental;
+                double initial = incremental.reset(graph, objects, source, target);
+                checker.near(initial, test::referenceMaxFlow(graph, objects, source, target), "reset " + where);
+
+                for (int step = 0; step < 30; step++)
+                {
+                    // Пачка изменений: ремонт, диаметр, работающие цеха
+                    int changes = 1 + rng() % 3;
+                    for (int j = 0; j < changes; j++)
+                    {
+                        int kind = rng() % 3;
+                        if (kind == 0)
+                        {
+                            CompressorStation *station = objects.getStationById(rng() % size + 1);
+                            if (station)
+                                station->setWorkingShops(rng() % 3);
+                        }
+                        else
+                        {
+                            Pipe *pipe = objects.getPipeById(pipeIds[rng() % pipeIds.size()]);
+                            if (kind == 1)
+                                pipe->setUnderRepair(!pipe->isUnderRepair());
+                            else
+                                pipe->setDiameter(diameters[rng() % 4]);
+                        }
+                    }
+                    incremental.refresh(objects);
+
+                    double expected = test::referenceMaxFlow(graph, objects, source, target);
+                    string what = where + " step " + to_string(step);
+                    checker.near(incremental.getFlow(), expected, "refreshed flow " + what);
+
+                    MinCut cut;
+                    incremental.extractMinCut(cut);
+                    checker.near(cut.capacity, expected, "cut capacity " + what);
+                }
+            }
+        }
+    }
+    return checker.finish();
+}
@@ -0,0 +1,124 @@
+#include "TestSupport.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <set>
+
+using namespace std;
+
+// Счетчик выделений памяти: расчеты на подготовленной рабочей области не выделяют память
+namespace
+{
+    atomic<long> allocations{0};
+}
+
+void *operator new(size_t size)
+{
+    allocations++;
+    void *memory = malloc(size ? size : 1);
+    if (!memory)
+        throw bad_alloc();
+    return memory;
+}
+
+void operator delete(void *memory) noexcept { free(memory); }
+void operator delete(void *memory, size_t) noexcept { free(memory); }
+
+namespace
+{
+    // Максимальный поток и минимальный разрез против эталона с ограничениями станций
+    void checkMaxFlowAndCut(test::Checker &checker)
+    {
+        int positive = 0;
+        for (NetworkGenerator::Topology topology : test::TOPOLOGIES)
+        {
+            for (int size : {12, 60, 250})
+            {
+                GasNetwork network;
+                test::generate(network, topology, size, size * 3 + static_cast<int>(topology), 0.1);
+                shared_ptr<const NetworkSnapshot> snapshot = network.snapshot();
+                const Graph &graph = snapshot->getGraph();
+                const PipelineNetwork &objects = snapshot->getPipelineNetwork();
+                string where = NetworkGenerator::topologyName(topology) + " " + to_string(size);
+
+                mt19937 rng(size);
+                for (int query = 0; query < 24; query++)
+                {
+                    int source, target;
+                    test::downstreamPair(rng, size, source, target);
+                    string pair = where + " " + to_string(source) + "->" + to_string(target);
+
+                    MinCut cut;
+                    double flow = NetworkCalculator::calculateMaxFlow(graph, objects, source, target, &cut);
+                    checker.near(flow, test::referenceMaxFlow(graph, objects, source, target), "max flow " + pair);
+                    positive += flow > 0.0;
+                    checker.near(cut.capacity, flow, "cut capacity " + pair);
+
+                    // Разрез состоит из насыщенных элементов и отделяет сток от источника
+                    double sum = 0.0;
+                    map<int, double> noPipes, noStations;
+                    for (const CutPipe &pipe : cut.pipes)
+                    {
+                        sum += pipe.capacity;
+                        noPipes[pipe.pipeId] = 0.0;
+                        checker.check(graph.getPipeId(pipe.fromStation, pipe.toStation) == pipe.pipeId, "cut pipe ends " + pair);
+                    }
+                    for (const CutStation &station : cut.stations)
+                    {
+                        sum += station.capacity;
+                        noStations[station.stationId] = 0.0;
+                    }
+                    checker.near(sum, flow, "cut element sum " + pair);
+                    checker.near(test::referenceMaxFlow(graph, objects, source, target, noPipes, noStations), 0.0,
+                                 "flow without cut elements " + pair);
+
+                    set<int> sourceSide(cut.sourceSide.begin(), cut.sourceSide.end());
+                    checker.check(sourceSide.count(source) && !sourceSide.count(target), "cut sides " + pair);
+                }
+            }
+        }
+        checker.check(positive > 40, "too few pairs with positive flow: " + to_string(positive));
+    }
+
+    // Повторные запросы на подготовленной рабочей области не выделяют память
+    void checkWorkspaceReuse(test::Checker &checker)
+    {
+        for (NetworkGenerator::Topology topology : test::TOPOLOGIES)
+        {
+            int size = 1000;
+            GasNetwork network;
+            test::generate(network, topology, size, 11, 0.1);
+            shared_ptr<const NetworkSnapshot> snapshot = network.snapshot();
+
+            FlatGraph flat;
+            flat.build(snapshot->getGraph(), snapshot->getPipelineNetwork());
+            CalculationWorkspace workspace;
+            workspace.prepare(flat);
+            vector<int> path;
+            path.reserve(size);
+            double distance = 0.0;
+            NetworkCalculator::findShortestPath(flat, workspace, 1, size, path, distance);
+            NetworkCalculator::calculateMaxFlow(flat, workspace, 1, size);
+
+            mt19937 rng(5);
+            long before = allocations.load();
+            for (int query = 0; query < 100; query++)
+            {
+                NetworkCalculator::findShortestPath(flat, workspace, rng() % size + 1, rng() % size + 1, path, distance);
+                NetworkCalculator::calculateMaxFlow(flat, workspace, rng() % size + 1, rng() % size + 1);
+            }
+            long allocated = allocations.load() - before;
+            checker.check(allocated == 0, "allocations in query loop on " + NetworkGenerator::topologyName(topology) +
+                                              ": " + to_string(allocated));
+        }
+    }
+}
+
+int main()
+{
+    test::Checker checker("MaxFlow");
+    checkMaxFlowAndCut(checker);
+    checkWorkspaceReuse(checker);
+    return checker.finish();
+}
@@ -0,0 +1,223 @@
+#include "TestSupport.h"
+#include <random>
+#include <set>
+
+using namespace std;
+
+namespace
+{
+    // Эталон: последовательные кратчайшие пути Беллмана-Форда по остаточной сети
+    double referenceMinCostFlow(const FlatGraph &graph, int source, int target, double volume, double &cost)
+    {
+        int n = graph.getNodeCount(), m = graph.getArcCount();
+        vector<double> flow(m, 0.0);
+        double delivered = 0.0;
+        cost = 0.0;
+        while (volume - delivered > 1e-9)
+        {
+            vector<double> distance(n, 1e300);
+            vector<int> parent(n, -1);
+            distance[source] = 0.0;
+            for (int round = 0; round < n; round++)
+            {
+                bool changed = false;
+                for (int a = 0; a < m; a++)
+                {
+                    const FlatGraph::Arc &arc = graph.arc(a);
+                    if (arc.capacity - flow[a] <= 1e-9 || distance[arc.tail] >= 1e299)
+                        continue;
+                    if (distance[arc.tail] + arc.length < distance[arc.head] - 1e-12)
+                    {
+                        distance[arc.head] = distance[arc.tail] + arc.length;
+                        parent[arc.head] = a;
+                        changed = true;
+                    }
+                }
+                if (!changed)
+                    break;
+            }
+            if (distance[target] >= 1e299)
+                break;
+
+            double pathFlow = volume - delivered;
+            for (int v = target; v != source; v = graph.arc(parent[v]).tail)
+                pathFlow = min(pathFlow, graph.arc(parent[v]).capacity - flow[parent[v]]);
+            for (int v = target; v != source; v = graph.arc(parent[v]).tail)
+            {
+                flow[parent[v]] += pathFlow;
+                flow[graph.arc(parent[v]).reverse] -= pathFlow;
+            }
+            delivered += pathFlow;
+            cost += pathFlow * distance[target];
+        }
+        return delivered;
+    }
+
+    void checkMinCostFlow(test::Checker &checker)
+    {
+        for (NetworkGenerator::Topology topology : test::TOPOLOGIES)
+        {
+            for (int size : {10, 40, 120})
+            {
+                GasNetwork network;
+                test::generate(network, topology, size, size * 3 + static_cast<int>(topology), 0.1);
+                shared_ptr<const NetworkSnapshot> snapshot = network.snapshot();
+                const Graph &graph = snapshot->getGraph();
+                const PipelineNetwork &objects = snapshot->getPipelineNetwork();
+                const FlatGraph &flat = NetworkCalculator::cachedStationGraph(graph, objects);
+                string where = NetworkGenerator::topologyName(topology) + " " + to_string(size);
+
+                mt19937 rng(5);
+                for (int query = 0; query < 8; query++)
+                {
+                    int source, target;
+                    test::downstreamPair(rng, size, source, target);
+                    double maxFlow = NetworkCalculator::calculateMaxFlow(graph, objects, source, target);
+                    double volume = query % 3 == 0 ? 1e12 : maxFlow * (0.2 + 0.3 * (query % 3));
+
+                    double expectedCost = 0.0;
+                    double expected = referenceMinCostFlow(flat, flat.nodeOf(source), flat.nodeOf(target), volume, expectedCost);
+                    MinCostFlowResult result = NetworkCalculator::calculateMinCostFlow(graph, objects, source, target, volume);
+                    checker.near(result.delivered, expected, "delivered " + where);
+                    checker.near(result.totalCost, expectedCost, "cost " + where);
+
+                    double pipeCost = 0.0;
+                    for (const PipeFlow &pipe : result.pipes)
+                    {
+                        pipeCost += pipe.cost;
+                        checker.check(graph.getPipeId(pipe.fromStation, pipe.toStation) == pipe.pipeId, "pipe ends " + where);
+                    }
+                    checker.near(pipeCost, result.totalCost, "pipe cost sum " + where);
+                }
+            }
+        }
+    }
+
+    struct Route
+    {
+        vector<int> stations; // без источника
+        vector<int> pipes;
+        double length = 0.0;
+    };
+
+    // Все простые маршруты по исправным трубам
+    void enumerateRoutes(const FlatGraph &graph, int node, int target, vector<char> &visited, Route &current, vector<Route> &routes)
+    {
+        if (node == target)
+        {
+            routes.push_back(current);
+            return;
+        }
+        for (int a = graph.arcBegin(node); a < graph.arcEnd(node); a++)
+        {
+            const FlatGraph::Arc &arc = graph.arc(a);
+            if (!arc.forward || arc.capacity <= 1e-9 || visited[arc.head])
+                continue;
+            visited[arc.head] = 1;
+            current.stations.push_back(arc.head);
+            current.pipes.push_back(arc.pipeId);
+            current.length += arc.length;
+            enumerateRoutes(graph, arc.head, target, visited, current, routes);
+            current.stations.pop_back();
+            current.pipes.pop_back();
+            current.length -= arc.length;
+            visited[arc.head] = 0;
+        }
+    }
+
+    // Пара независимых маршрутов минимальной суммарной длины против полного перебора
+    void checkDisjointPaths(test::Checker &checker)
+    {
+        for (NetworkGenerator::Topology topology : test::TOPOLOGIES)
+        {
+            for (int size : {6, 9, 12})
+            {
+                for (int seed = 0; seed < 3; seed++)
+                {
+                    GasNetwork network;
+                    test::generate(network, topology, size, seed * 100 + size + static_cast<int>(topology), 0.1);
+                    shared_ptr<const NetworkSnapshot> snapshot = network.snapshot();
+                    const Graph &graph = snapshot->getGraph();
+                    const FlatGraph &flat = NetworkCalculator::cachedFlatGraph(graph, snapshot->getPipelineNetwork());
+                    FlatGraph unit[2];
+                    NetworkCalculator::buildDisjointGraph(unit[0], flat, false);
+                    NetworkCalculator::buildDisjointGraph(unit[1], flat, true);
+                    CalculationWorkspace workspace;
+
+                    for (int source = 1; source <= size; source++)
+                    {
+                        for (int target = 1; target <= size; target++)
+                        {
+                            if (source == target)
+                                continue;
+                            vector<Route> routes;
+                            vector<char> visited(flat.getNodeCount(), 0);
+                            Route current;
+                            visited[flat.nodeOf(source)] = 1;
+                            enumerateRoutes(flat, flat.nodeOf(source), flat.nodeOf(target), visited, current, routes);
+                            if (routes.size() > 2000)
+                                continue;
+
+                            for (int stationDisjoint = 0; stationDisjoint < 2; stationDisjoint++)
+                            {
+                                double best = 1e300;
+                                for (size_t i = 0; i < routes.size(); i++)
+                                {
+                                    set<int> pipes(routes[i].pipes.begin(), routes[i].pipes.end());
+                                    set<int> stations(routes[i].stations.begin(), routes[i].stations.end() - 1);
+                                    for (size_t j = i + 1; j < routes.size(); j++)
+                                    {
+                                        bool independent = true;
+                                        for (int pipe : routes[j].pipes)
+                                            independent = independent && !pipes.count(pipe);
+                                        for (size_t z = 0; stationDisjoint && z + 1 < routes[j].stations.size(); z++)
+                                            independent = independent && !stations.count(routes[j].stations[z]);
+                                        if (independent)
+                                            best = min(best, routes[i].length + routes[j].length);
+                                    }
+                                }
+                                size_t expected = best < 1e299 ? 2 : routes.empty() ? 0 : 1;
+
+                                vector<DisjointPath> paths = NetworkCalculator::findDisjointPaths(
+                                    flat, unit[stationDisjoint], workspace, source, target, 2);
+                                string what = NetworkGenerator::topologyName(topology) + " " + to_string(source) + "->" +
+                                              to_string(target) + (stationDisjoint ? " station-disjoint" : "");
+                                if (!checker.check(paths.size() == expected, "route count " + what))
+                                    continue;
+                                if (expected == 2)
+                                    checker.near(paths[0].length + paths[1].length, best, "total length " + what);
+
+                                set<int> usedPipes, usedStations;
+                                for (const DisjointPath &path : paths)
+                                {
+                                    checker.check(path.stations.front() == source && path.stations.back() == target &&
+                                                      path.stations.size() == path.pipeIds.size() + 1,
+                                                  "route ends " + what);
+                                    double bottleneck = 1e300;
+                                    for (size_t z = 0; z < path.pipeIds.size(); z++)
+                                    {
+                                        checker.check(usedPipes.insert(path.pipeIds[z]).second, "shared pipe " + what);
+                                        checker.check(graph.getPipeId(path.stations[z], path.stations[z + 1]) == path.pipeIds[z],
+                                                      "route pipe " + what);
+                                        bottleneck = min(bottleneck, flat.arc(flat.arcOfPipe(path.pipeIds[z])).capacity);
+                                    }
+                                    checker.near(path.bottleneck, bottleneck, "bottleneck " + what);
+                                    for (size_t z = 1; stationDisjoint && z + 1 < path.stations.size(); z++)
+                                        checker.check(usedStations.insert(path.stations[z]).second, "shared station " + what);
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+int main()
+{
+    test::Checker checker("MinCostFlow");
+    checkMinCostFlow(checker);
+    checkDisjointPaths(checker);
+    return checker.finish();
+}
@@ -0,0 +1,189 @@
+#include "TestSupport.h"
+#include "PersistentMap.h"
+#include <atomic>
+#include <climits>
+#include <random>
+#include <thread>
+
+using namespace std;
+
+namespace
+{
+    // Порядок обхода PersistentMap: отрицательные ключи - после неотрицательных
+    struct UnsignedLess
+    {
+        bool operator()(int a, int b) const { return static_cast<uint32_t>(a) < static_cast<uint32_t>(b); }
+    };
+
+    using Map = PersistentMap<string, MemoryCategory::Pipes>;
+    using Reference = map<int, string, UnsignedLess>;
+
+    bool sameContents(const Map &actual, const Reference &expected)
+    {
+        if (actual.size() != expected.size())
+            return false;
+        auto it = expected.begin();
+        for (const auto &entry : actual)
+        {
+            if (it == expected.end() || it->first != entry.first || it->second != entry.second)
+                return false;
+            ++it;
+        }
+        for (const auto &entry : expected)
+        {
+            const string *value = actual.find(entry.first);
+            if (!value || *value != entry.second)
+                return false;
+        }
+
+        // Фрагменты покрывают все записи по возрастанию ключа
+        vector<const Map::EntryVector *> chunks;
+        actual.chunks(chunks);
+        size_t count = 0;
+        bool first = true;
+        uint32_t last = 0;
+        for (const Map::EntryVector *chunk : chunks)
+        {
+            for (const auto &entry : *chunk)
+            {
+                if (!first && static_cast<uint32_t>(entry.first) <= last)
+                    return false;
+                first = false;
+                last = static_cast<uint32_t>(entry.first);
+                count++;
+            }
+        }
+        return count == expected.size();
+    }
+
+    // Копии отображения не видят изменений друг друга
+    void checkCopyOnWrite(test::Checker &checker)
+    {
+        mt19937 rng(1);
+        for (int round = 0; round < 60; round++)
+        {
+            Map actual;
+            Reference expected;
+            vector<pair<Map, Reference>> copies;
+            int range = round % 3 == 0 ? 100 : round % 3 == 1 ? 100000 : INT_MAX;
+            int shift = round % 5 == 0 ? range / 2 : 0;
+
+            for (int op = 0; op < 3000; op++)
+            {
+                int key = static_cast<int>(rng() % static_cast<uint32_t>(range)) - shift;
+                int kind = rng() % 10;
+                if (kind < 5)
+                {
+                    string value = to_string(rng());
+                    actual.set(key, value);
+                    expected[key] = value;
+                }
+                else if (kind < 8)
+                {
+                    checker.check(actual.erase(key) == (expected.erase(key) > 0), "erase result");
+                }
+                else if (kind < 9)
+                {
+                    string *value = actual.findMutable(key);
+                    auto it = expected.find(key);
+                    checker.check((value != nullptr) == (it != expected.end()), "findMutable presence");
+                    if (value && it != expected.end())
+                    {
+                        *value += "x";
+                        it->second += "x";
+                    }
+                }
+                else
+                {
+                    copies.push_back({actual, expected});
+                }
+            }
+
+            checker.check(sameContents(actual, expected), "map contents, round " + to_string(round));
+            for (const auto &copy : copies)
+            {
+                checker.check(sameContents(copy.first, copy.second), "copy isolation, round " + to_string(round));
+            }
+            actual.clear();
+            expected.clear();
+            checker.check(sameContents(actual, expected), "clear");
+        }
+    }
+
+    // Снимок согласован: каждая труба топологии помечена в нем как подключенная
+    bool consistent(const NetworkSnapshot &snapshot)
+    {
+        const PipelineNetwork &network = snapshot.getPipelineNetwork();
+        for (const auto &conn : snapshot.getGraph().getConnectionsWithPipe())
+        {
+            const Pipe *pipe = network.getPipeById(conn.second.second);
+            if (!pipe || !pipe->getIsConnected())
+                return false;
+        }
+        return true;
+    }
+
+    // Закрепленный снимок не меняется, пока писатель правит сеть; читатели в других
+    // потоках всегда видят согласованную версию
+    void checkSnapshotIsolation(test::Checker &checker)
+    {
+        GasNetwork network;
+        test::generate(network, NetworkGenerator::Topology::MeshedGrid, 400, 7, 0.0);
+
+        shared_ptr<const NetworkSnapshot> pinned = network.snapshot();
+        auto pinnedConnections = pinned->getGraph().getConnectionsWithPipe();
+        uint64_t pinnedVersion = pinned->getVersion();
+
+        atomic<bool> done{false};
+        atomic<int> inconsistent{0};
+        atomic<int> reads{0};
+        thread reader([&]()
+                      {
+            while (!done.load())
+            {
+                shared_ptr<const NetworkSnapshot> current = network.snapshot();
+                if (!consistent(*current))
+                    inconsistent++;
+                reads++;
+            } });
+
+        mt19937 rng(3);
+        vector<pair<int, pair<int, int>>> removed;
+        for (int edit = 0; edit < 200; edit++)
+        {
+            auto &conn = pinnedConnections[rng() % pinnedConnections.size()];
+            if (network.snapshot()->getGraph().getPipeId(conn.first, conn.second.first) == conn.second.second)
+            {
+                network.disconnectStations(conn.first, conn.second.first);
+                removed.push_back(conn);
+            }
+            if (edit % 4 == 0 && !removed.empty())
+            {
+                auto back = removed.back();
+                removed.pop_back();
+                network.connectStations(back.first, back.second.first,
+                                        network.snapshot()->getPipelineNetwork().getPipeById(back.second.second)->getDiameter(),
+                                        back.second.second);
+            }
+        }
+        done = true;
+        reader.join();
+
+        checker.check(inconsistent.load() == 0, "readers saw " + to_string(inconsistent.load()) + " inconsistent snapshots");
+        checker.check(reads.load() > 0, "reader made no reads");
+        checker.check(pinned->getVersion() == pinnedVersion, "pinned snapshot version changed");
+        checker.check(pinned->getGraph().getConnectionsWithPipe() == pinnedConnections, "pinned topology changed");
+        checker.check(consistent(*pinned), "pinned snapshot lost pipe flags");
+        checker.check(network.snapshot()->getGraph().getEdgeCount() == pinnedConnections.size() - removed.size(),
+                      "latest snapshot edge count");
+        checker.check(network.getVersion() > pinnedVersion, "writer did not publish new versions");
+    }
+}
+
+int main()
+{
+    test::Checker checker("PersistentMap");
+    checkCopyOnWrite(checker);
+    checkSnapshotIsolation(checker);
+    return checker.finish();
+}
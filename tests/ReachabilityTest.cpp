@@ -0,0 +1,135 @@
+#include "TestSupport.h"
+#include "ReachabilityIndex.h"
+#include <set>
+#include <sstream>
+
+using namespace std;
+
+namespace
+{
+    bool reachesByBfs(const map<int, vector<int>> &adjacency, int from, int to)
+    {
+        set<int> visited{from};
+        vector<int> queue{from};
+        for (size_t head = 0; head < queue.size(); head++)
+        {
+            if (queue[head] == to)
+                return true;
+            auto it = adjacency.find(queue[head]);
+            if (it == adjacency.end())
+                continue;
+            for (int next : it->second)
+                if (visited.insert(next).second)
+                    queue.push_back(next);
+        }
+        return false;
+    }
+
+    // Индекс и его пополнение addConnection против обхода в ширину; 9000 станций -
+    // режим интервальных меток (больше BITSET_LIMIT компонент)
+    void checkIndex(test::Checker &checker)
+    {
+        for (NetworkGenerator::Topology topology : test::TOPOLOGIES)
+        {
+            for (int size : {8, 40, 200, 9000})
+            {
+                GasNetwork network;
+                test::generate(network, topology, size, size + static_cast<int>(topology));
+                Graph graph = network.snapshot()->getGraph();
+                map<int, vector<int>> adjacency;
+                for (const auto &conn : graph.getConnections())
+                    adjacency[conn.first].push_back(conn.second);
+                string where = NetworkGenerator::topologyName(topology) + " " + to_string(size);
+
+                ReachabilityIndex index;
+                index.build(graph);
+                checker.check(index.isBuiltFrom(graph) && index.getGraphVersion() == graph.getVersion(), "built " + where);
+                mt19937 rng(4);
+                int queries = size > 1000 ? 150 : 300;
+                for (int step = 0; step < 6; step++)
+                {
+                    for (int i = 0; i < queries; i++)
+                    {
+                        int from = static_cast<int>(rng() % (size + 2)) + 1, to = static_cast<int>(rng() % (size + 2)) + 1;
+                        checker.check(index.reaches(graph, from, to) == (from == to || reachesByBfs(adjacency, from, to)),
+                                      "reaches " + to_string(from) + "->" + to_string(to) + " " + where);
+                    }
+                    for (int e = 0; e < 3; e++)
+                    {
+                        int from = static_cast<int>(rng() % (size + 3)) + 1, to = static_cast<int>(rng() % (size + 3)) + 1;
+                        if (from == to || graph.getPipeId(from, to) != -1)
+                            continue;
+                        uint64_t before = graph.getVersion();
+                        graph.addConnection(from, to, 1000000 + step * 10 + e, 500);
+                        adjacency[from].push_back(to);
+                        index.addConnection(graph, from, to, before);
+                    }
+                }
+            }
+        }
+    }
+
+    // Путь GasNetwork: соединения и разъединения писателя, предупреждение о цикле
+    // и ответ checkDownstream против обхода опубликованного графа
+    void checkNetwork(test::Checker &checker)
+    {
+        for (NetworkGenerator::Topology topology : test::TOPOLOGIES)
+        {
+            for (int size : {30, 300})
+            {
+                GasNetwork network;
+                test::generate(network, topology, size, size + static_cast<int>(topology));
+                PipelineNetwork objects = network.snapshot()->getPipelineNetwork();
+                Graph graph = network.snapshot()->getGraph();
+                int nextPipe = Pipe::getNextId();
+                int lastPipe = nextPipe + 200;
+                for (int i = 0; i < 200; i++)
+                    objects.addPipe(Pipe(Pipe::acquireId(), "Тест", 10, 500));
+                network.replaceNetwork(objects, graph);
+                string where = NetworkGenerator::topologyName(topology) + " " + to_string(size);
+
+                mt19937 rng(static_cast<unsigned>(size) + static_cast<unsigned>(topology) * 7);
+                vector<int> stations = graph.getVertices();
+                for (int step = 0; step < 150; step++)
+                {
+                    int from = stations[rng() % stations.size()], to = stations[rng() % stations.size()];
+                    stringstream output;
+                    streambuf *silenced = cout.rdbuf(output.rdbuf());
+                    if (rng() % 3 == 0)
+                    {
+                        vector<pair<int, int>> connections = network.snapshot()->getGraph().getConnections();
+                        if (!connections.empty())
+                        {
+                            pair<int, int> conn = connections[rng() % connections.size()];
+                            network.disconnectStations(conn.first, conn.second);
+                        }
+                    }
+                    else if (from != to && nextPipe < lastPipe)
+                    {
+                        bool cycle = network.snapshot()->getGraph().reaches(to, from);
+                        if (network.connectStations(from, to, 500, nextPipe))
+                        {
+                            nextPipe++;
+                            checker.check((output.str().find("closes a cycle") != string::npos) == cycle,
+                                          "cycle warning " + to_string(from) + "->" + to_string(to) + " " + where);
+                        }
+                    }
+
+                    output.str("");
+                    network.checkDownstream(from, to);
+                    cout.rdbuf(silenced);
+                    checker.check((output.str().find("✅") != string::npos) == network.snapshot()->getGraph().reaches(from, to),
+                                  "downstream " + to_string(from) + "->" + to_string(to) + " " + where);
+                }
+            }
+        }
+    }
+}
+
+int main()
+{
+    test::Checker checker("Reachability");
+    checkIndex(checker);
+    checkNetwork(checker);
+    return checker.finish();
+}
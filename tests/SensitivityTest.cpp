@@ -0,0 +1,92 @@
+#include "TestSupport.h"
+#include "SensitivityAnalyzer.h"
+#include "TaskScheduler.h"
+#include <random>
+
+using namespace std;
+
+namespace
+{
+    // Каждый прирост отчета - против полного пересчета потока с расширенной трубой
+    void checkReport(test::Checker &checker, const Graph &graph, const PipelineNetwork &network,
+                     int source, int target, const string &where)
+    {
+        const FlatGraph &flat = NetworkCalculator::cachedStationGraph(graph, network, true);
+        SensitivityAnalyzer::Report report = SensitivityAnalyzer::analyze(flat, network, source, target);
+        double base = test::referenceMaxFlow(graph, network, source, target);
+        checker.near(report.baseFlow, base, "base flow " + where);
+
+        for (const SensitivityAnalyzer::PipeSensitivity &entry : report.ranking)
+        {
+            const Pipe *pipe = network.getPipeById(entry.pipeId);
+            if (!checker.check(pipe != nullptr, "pipe " + to_string(entry.pipeId) + " " + where))
+                continue;
+            double original = NetworkCalculator::calculatePipeCapacity(pipe->getLength(), pipe->getDiameter(), pipe->isUnderRepair());
+            for (const SensitivityAnalyzer::Upgrade &upgrade : entry.upgrades)
+            {
+                double capacity = max(NetworkCalculator::calculatePipeCapacity(pipe->getLength(), upgrade.diameter, false), original);
+                double upgraded = test::referenceMaxFlow(graph, network, source, target, {{entry.pipeId, capacity}});
+                string what = "pipe " + to_string(entry.pipeId) + " to " + to_string(upgrade.diameter) + " " + where;
+                checker.near(upgrade.capacity, capacity, "capacity " + what);
+                // Прирост - разность двух потоков, погрешность относительно базового
+                checker.check(fabs(upgrade.gain - (upgraded - base)) <= 1e-6 * max(1.0, base),
+                              "gain " + what + ": " + to_string(upgrade.gain) + " vs " + to_string(upgraded - base));
+            }
+        }
+    }
+
+    // Две станции: после расширения трубы поток ограничивает цех станции-источника
+    void checkSourceStationLimit(test::Checker &checker)
+    {
+        PipelineNetwork network;
+        int source = CompressorStation::acquireId(), target = CompressorStation::acquireId();
+        network.addStation(CompressorStation(source, "Источник", 1, 1, 1));
+        network.addStation(CompressorStation(target, "Потребитель", 1, 1, 1));
+        int pipeId = Pipe::acquireId();
+        network.addPipe(Pipe(pipeId, "Труба", 5, 500));
+        network.markPipeAsConnected(pipeId, true);
+        Graph graph;
+        graph.addConnection(source, target, pipeId, 500);
+
+        const FlatGraph &flat = NetworkCalculator::cachedStationGraph(graph, network, true);
+        SensitivityAnalyzer::Report report = SensitivityAnalyzer::analyze(flat, network, source, target);
+        double stationLimit = NetworkCalculator::calculateStationCapacity(1, 1);
+        double pipeCapacity = NetworkCalculator::calculatePipeCapacity(5, 500, false);
+        checker.near(report.baseFlow, pipeCapacity, "two stations base flow");
+        if (checker.check(report.ranking.size() == 1 && !report.ranking[0].upgrades.empty(), "two stations ranking"))
+            checker.near(report.ranking[0].upgrades.back().gain, stationLimit - pipeCapacity, "two stations gain");
+        checkReport(checker, graph, network, source, target, "two stations");
+    }
+}
+
+int main()
+{
+    test::Checker checker("Sensitivity");
+    for (size_t workers : {0, 3})
+    {
+        TaskScheduler::instance().setWorkerCount(workers);
+        checkSourceStationLimit(checker);
+        for (NetworkGenerator::Topology topology : test::TOPOLOGIES)
+        {
+            for (int size : {10, 40, 150})
+            {
+                for (int seed = 1; seed <= 3; seed++)
+                {
+                    GasNetwork network;
+                    test::generate(network, topology, size, seed);
+                    shared_ptr<const NetworkSnapshot> snapshot = network.snapshot();
+                    mt19937 rng(seed * 13 + static_cast<int>(topology));
+                    for (int query = 0; query < 4; query++)
+                    {
+                        int source, target;
+                        test::downstreamPair(rng, size, source, target);
+                        checkReport(checker, snapshot->getGraph(), snapshot->getPipelineNetwork(), source, target,
+                                    NetworkGenerator::topologyName(topology) + " " + to_string(size) + " " +
+                                        to_string(source) + "->" + to_string(target));
+                    }
+                }
+            }
+        }
+    }
+    return checker.finish();
+}
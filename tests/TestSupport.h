@@ -0,0 +1,163 @@
+#ifndef TEST_SUPPORT_H
+#define TEST_SUPPORT_H
+
+#include "GasNetwork.h"
+#include "NetworkGenerator.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+// Общие средства проверочных программ tests/*Test.cpp: счетчик проверок,
+// синтетические сети без вывода в консоль и эталонный максимальный поток,
+// который не использует FlatGraph и рабочие области калькуляторов.
+namespace test
+{
+    // Счетчик проверок; сообщения калькуляторов на время теста глушатся
+    class Checker
+    {
+    private:
+        std::string name;
+        std::streambuf *savedOutput;
+        int checks = 0;
+        int failures = 0;
+
+    public:
+        explicit Checker(const std::string &name) : name(name), savedOutput(std::cout.rdbuf(nullptr)) {}
+        ~Checker() { std::cout.rdbuf(savedOutput); }
+
+        // Проверка с описанием на случай отказа
+        bool check(bool condition, const std::string &what)
+        {
+            checks++;
+            if (!condition)
+            {
+                failures++;
+                if (failures <= 20)
+                    std::cerr << "❌ " << name << ": " << what << std::endl;
+            }
+            return condition;
+        }
+
+        // Совпадение чисел с относительной погрешностью
+        bool near(double actual, double expected, const std::string &what, double tolerance = 1e-6)
+        {
+            return check(std::fabs(actual - expected) <= tolerance * std::max(1.0, std::fabs(expected)),
+                         what + ": " + std::to_string(actual) + " vs " + std::to_string(expected));
+        }
+
+        // Код возврата программы (0 - все проверки прошли)
+        int finish() const
+        {
+            std::cerr << (failures == 0 ? "✅ " : "❌ ") << name << ": " << checks << " checks, "
+                      << failures << " failures" << std::endl;
+            return failures == 0 && checks > 0 ? 0 : 1;
+        }
+    };
+
+    const NetworkGenerator::Topology TOPOLOGIES[] = {
+        NetworkGenerator::Topology::Tree,
+        NetworkGenerator::Topology::MeshedGrid,
+        NetworkGenerator::Topology::ScaleFree,
+        NetworkGenerator::Topology::TrunkWithLaterals};
+
+    inline void generate(GasNetwork &network, NetworkGenerator::Topology topology, int stations,
+                         uint64_t seed, double repairProbability = 0.05)
+    {
+        NetworkGenerator::Options options;
+        options.topology = topology;
+        options.stationCount = stations;
+        options.seed = seed;
+        options.repairProbability = repairProbability;
+        NetworkGenerator::generate(network, options);
+    }
+
+    // Пара станций сети генератора, между которыми обычно есть поток:
+    // трубы генератора идут в основном от меньших ID к большим
+    inline void downstreamPair(std::mt19937 &rng, int stations, int &source, int &target)
+    {
+        source = static_cast<int>(rng() % static_cast<unsigned>(std::max(1, stations / 3))) + 1;
+        target = source + 1 + static_cast<int>(rng() % static_cast<unsigned>(stations - source));
+    }
+
+    // Эталонный поток Эдмондса-Карпа по Graph: станция - пара узлов вход/выход с
+    // ограничением по работающим цехам, в сток газ входит без ограничения.
+    // pipeCapacity и stationCapacity заменяют пропускную способность перечисленных
+    // труб и станций.
+    inline double referenceMaxFlow(const Graph &graph, const PipelineNetwork &network, int source, int target,
+                                   const std::map<int, double> &pipeCapacity = {},
+                                   const std::map<int, double> &stationCapacity = {})
+    {
+        std::vector<int> stations = graph.getVertices();
+        std::map<int, int> nodeOf;
+        for (size_t i = 0; i < stations.size(); i++)
+            nodeOf[stations[i]] = static_cast<int>(i);
+        if (!nodeOf.count(source) || !nodeOf.count(target) || source == target)
+            return 0.0;
+
+        int n = static_cast<int>(stations.size());
+        std::vector<std::map<int, double>> residual(2 * n);
+        auto addArc = [&](int from, int to, double capacity)
+        {
+            residual[from][to] += capacity;
+            residual[to][from] += 0.0;
+        };
+        for (int v = 0; v < n; v++)
+        {
+            const CompressorStation *station = network.getStationById(stations[v]);
+            auto it = stationCapacity.find(stations[v]);
+            double capacity = it != stationCapacity.end() ? it->second
+                              : station ? NetworkCalculator::calculateStationCapacity(station->getWorkingShops(), station->getStationClass())
+                                        : 1e300;
+            addArc(v, n + v, capacity);
+        }
+        for (const auto &conn : graph.getConnectionsWithPipe())
+        {
+            const Pipe *pipe = network.getPipeById(conn.second.second);
+            if (!pipe)
+                continue;
+            auto it = pipeCapacity.find(pipe->getId());
+            double capacity = it != pipeCapacity.end()
+                                  ? it->second
+                                  : NetworkCalculator::calculatePipeCapacity(pipe->getLength(), pipe->getDiameter(), pipe->isUnderRepair());
+            addArc(n + nodeOf[conn.first], nodeOf[conn.second.first], capacity);
+        }
+
+        int s = nodeOf[source], t = nodeOf[target];
+        double total = 0.0;
+        while (true)
+        {
+            std::vector<int> parent(2 * n, -1);
+            std::vector<int> queue{s};
+            parent[s] = s;
+            for (size_t head = 0; head < queue.size() && parent[t] < 0; head++)
+            {
+                for (const auto &arc : residual[queue[head]])
+                {
+                    if (arc.second > 1e-9 && parent[arc.first] < 0)
+                    {
+                        parent[arc.first] = queue[head];
+                        queue.push_back(arc.first);
+                    }
+                }
+            }
+            if (parent[t] < 0)
+                return total;
+
+            double pathFlow = 1e300;
+            for (int v = t; v != s; v = parent[v])
+                pathFlow = std::min(pathFlow, residual[parent[v]][v]);
+            for (int v = t; v != s; v = parent[v])
+            {
+                residual[parent[v]][v] -= pathFlow;
+                residual[v][parent[v]] += pathFlow;
+            }
+            total += pathFlow;
+        }
+    }
+}
+
+#endif
@@ -4,6 +4,7 @@
 #include <iomanip>
 #include <sstream>
 #include <cctype>
+#include <limits>
 
 std::string getCurrentDateTime()
 {
@@ -14,7 +15,7 @@ std::string getCurrentDateTime()
     return ss.str();
 }
 
-int getIntegerInput(const std::string &prompt)
+long long getLongInput(const std::string &prompt)
 {
     while (true)
     {
@@ -48,7 +49,7 @@ int getIntegerInput(const std::string &prompt)
 
         try
         {
-            return std::stoi(input);
+            return std::stoll(input);
         }
         catch (...)
         {
@@ -57,6 +58,19 @@ int getIntegerInput(const std::string &prompt)
     }
 }
 
+int getIntegerInput(const std::string &prompt)
+{
+    while (true)
+    {
+        long long value = getLongInput(prompt);
+        if (value <= std::numeric_limits<int>::max())
+        {
+            return static_cast<int>(value);
+        }
+        std::cout << "Error! Enter a valid integer. Try again." << std::endl;
+    }
+}
+
 double getDoubleInput(const std::string &prompt)
 {
     while (true)
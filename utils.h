@@ -5,6 +5,7 @@
 
 std::string getCurrentDateTime();
 int getIntegerInput(const std::string &prompt);
+long long getLongInput(const std::string &prompt);
 double getDoubleInput(const std::string &prompt);
 std::string getStringInput(const std::string &prompt);
 